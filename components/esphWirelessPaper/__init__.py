@@ -1,5 +1,6 @@
 import esphome.codegen as cg
 import esphome.config_validation as cv
+from esphome import pins
 from esphome.const import CONF_ID
 
 print("WirelessPaper Display component is being loaded!")
@@ -7,13 +8,19 @@ print("WirelessPaper Display component is being loaded!")
 esphWirelessPaper_ns = cg.esphome_ns.namespace("esphWirelessPaper")
 PaperDisplay = esphWirelessPaper_ns.class_("PaperDisplay", cg.PollingComponent)
 
+# Declared here rather than imported so the display still loads without esphiBoost
+esphiBoost_ns = cg.esphome_ns.namespace("esphiBoost")
+iBoostBuddy = esphiBoost_ns.class_("iBoostBuddy", cg.PollingComponent)
+
 CONFIG_SCHEMA = (
     cv.Schema(
       {
         cv.GenerateID(): cv.declare_id(PaperDisplay),
         cv.Optional("top_title", default=""):  cv.string,
+        cv.Optional("busy_pin"): pins.gpio_input_pin_schema,
+        cv.Optional("iboost_id"): cv.use_id(iBoostBuddy),
       }
-    ).extend(cv.COMPONENT_SCHEMA)
+    ).extend(cv.polling_component_schema("15s"))
 )
 
 async def to_code(config):
@@ -23,3 +30,9 @@ async def to_code(config):
     # Set configuration values
     if "top_title" in config:
         cg.add(var.set_TopTitle(config["top_title"]))
+    if "busy_pin" in config:
+        pin = await cg.gpio_pin_expression(config["busy_pin"])
+        cg.add(var.set_busy_pin(pin))
+    if "iboost_id" in config:
+        iboost = await cg.get_variable(config["iboost_id"])
+        cg.add(var.set_iboost(iboost))
@@ -1,6 +1,13 @@
 #include "esphWirelessPaper.h"
 #include "esphome/core/log.h"
+#ifdef USE_WEBSERVER
+#include "esphome/components/web_server_base/web_server_base.h"
+#endif
 #include "heltec-eink-modules.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
 #include <string>
 #include <unistd.h>
 #include <errno.h>
@@ -21,50 +28,430 @@ namespace esphome
     static const int TEXT_X_OFFSET = 10;
     static const int TEXT_CLEAR_WIDTH = 250;
     static const int TEXT_LINE_HEIGHT = 10;
+    static const int VALUE_X_OFFSET = 70; // labelled lines: value starts here, label to the left
     static const int TITLE_Y_POS = 10;
     static const int STATUS_Y_POS = 20;
     static const int DATA_START_Y_POS = 30;
     static const int COUNTER_Y_POS = 110;
     static const int FAST_MODE_DELAY_MS = 20;
     static const int SETUP_DELAY_MS = 200;
+    static const uint32_t BUSY_TIMEOUT_MS = 5000; // carry on if BUSY never clears
     static const long MAX_COUNTER_VALUE = 99999999;
 
+    // Line index for each row of the shadow model
+    static const int TITLE_LINE = 0;
+    static const int STATUS_LINE = 1;
+    static const int FIRST_DATA_LINE = 2;
+
+    static int line_y_pos(int index)
+    {
+      if (index == TITLE_LINE)
+        return TITLE_Y_POS;
+      if (index == STATUS_LINE)
+        return STATUS_Y_POS;
+      return DATA_START_Y_POS + (index - FIRST_DATA_LINE) * TEXT_LINE_HEIGHT;
+    }
+
+#ifdef USE_ESPHIBOOST
+    // Wh reading as kWh, or "--" until the first value arrives
+    static void format_kwh(char *buffer, size_t size, float wh)
+    {
+      if (std::isnan(wh))
+        snprintf(buffer, size, "--");
+      else
+        snprintf(buffer, size, "%.2f kWh", wh / 1000.0f);
+    }
+
+    static void format_rssi(char *buffer, size_t size, float rssi)
+    {
+      if (std::isnan(rssi))
+        snprintf(buffer, size, "--");
+      else
+        snprintf(buffer, size, "%.0f", rssi);
+    }
+#endif
+
+#ifdef USE_WEBSERVER
+    // Serves the mirrored frame buffer so layout and refresh behaviour can be checked without the panel
+    class SnapshotHandler : public AsyncWebHandler
+    {
+    public:
+      explicit SnapshotHandler(PaperDisplay *parent) : parent_(parent) {}
+
+      bool canHandle(AsyncWebServerRequest *request) const override
+      {
+        return request->method() == HTTP_GET && request->url() == "/display/snapshot.pbm";
+      }
+
+      void handleRequest(AsyncWebServerRequest *request) override
+      {
+        std::string pbm;
+        parent_->render_snapshot(pbm);
+        if (pbm.empty())
+        {
+          request->send(503);
+          return;
+        }
+        request->send(request->beginResponse(200, "image/x-portable-bitmap",
+                                             reinterpret_cast<const uint8_t *>(pbm.data()), pbm.size()));
+      }
+
+    protected:
+      PaperDisplay *parent_;
+    };
+#endif
+
+    static const char *refresh_state_name(RefreshState state)
+    {
+      switch (state)
+      {
+      case REFRESH_WAIT_READY:
+        return "wait-ready";
+      case REFRESH_DRAW:
+        return "draw";
+      case REFRESH_PUSH:
+        return "push";
+      case REFRESH_SETTLE:
+        return "settle";
+      default:
+        return "idle";
+      }
+    }
+
     void PaperDisplay::setup()
     {
       ESP_LOGV(TAG, "Display setup started");
+      if (busy_pin_ != nullptr)
+        busy_pin_->setup();
       this->display.landscape();
+#ifdef USE_WEBSERVER
+      if (web_server_base::global_web_server_base != nullptr)
+      {
+        atlas_.build();
+        frame_width_ = this->display.width();
+        frame_height_ = this->display.height();
+        frame_stride_ = (frame_width_ + 7) / 8;
+        frame_.assign(frame_stride_ * frame_height_, 0);
+        web_server_base::global_web_server_base->add_handler(new SnapshotHandler(this));
+      }
+#endif
       // this->display.clear();
       this->screen_writeTitleLine(config_TopTitle);
       this->screen_writeStatusLine("Initializing...");
-      delay(SETUP_DELAY_MS);
+      // Give the panel its power-on time from loop() rather than sleeping here
+      ready_at_ms_ = millis() + SETUP_DELAY_MS;
+      this->request_flush_();
       ESP_LOGV(TAG, "Display setup complete");
     }
 
     void PaperDisplay::update() // called on poll
     {
       ESP_LOGV(TAG, "Update Call Started");
- 
-
+#ifdef USE_ESPHIBOOST
+      if (iboost_ != nullptr)
+        this->render_iboost_();
+#endif
+      this->request_flush_();
       ESP_LOGV(TAG, "Update Call Complete");
     }
 
+    // Refresh state machine: waiting for the panel and drawing are split into short steps
+    // of one per call. The push is not: the Heltec driver's update() only returns once the
+    // panel has refreshed, and holds up the main loop (and the radio it services) meanwhile.
+    void PaperDisplay::loop()
+    {
+      if (state_ == REFRESH_IDLE)
+        return;
+
+      uint32_t start_us = micros();
+      RefreshState state = state_;
+      uint32_t now = millis();
+      switch (state)
+      {
+      case REFRESH_WAIT_READY:
+        if (static_cast<int32_t>(now - ready_at_ms_) < 0)
+          break;
+        if (panel_busy_())
+        {
+          if (now - state_since_ms_ < BUSY_TIMEOUT_MS)
+            break;
+          ESP_LOGW(TAG, "Panel BUSY did not clear after %u ms; refreshing anyway", (unsigned) BUSY_TIMEOUT_MS);
+        }
+        refresh_started_ms_ = now;
+        next_line_ = 0;
+        lines_in_refresh_ = 0;
+        this->display.fastmodeOn();
+        state_ = REFRESH_DRAW;
+        break;
+
+      case REFRESH_DRAW:
+        if (!this->draw_next_line_())
+          state_ = REFRESH_PUSH;
+        break;
+
+      case REFRESH_PUSH:
+      {
+        // Sends the frame and waits on BUSY itself; the driver has no call that returns
+        // before the refresh is over
+        this->display.update();
+        uint32_t pushed = millis();
+        refresh_count_++;
+        panel_busy_ms_ += pushed - now;
+        ready_at_ms_ = pushed + FAST_MODE_DELAY_MS;
+        state_since_ms_ = pushed;
+        state_ = REFRESH_SETTLE;
+        break;
+      }
+
+      case REFRESH_SETTLE:
+        if (static_cast<int32_t>(now - ready_at_ms_) < 0)
+          break;
+        if (panel_busy_() && now - state_since_ms_ < BUSY_TIMEOUT_MS)
+          break;
+        this->display.fastmodeOff();
+        state_ = REFRESH_IDLE;
+        ESP_LOGD(TAG, "Refreshed %d line(s) in %u ms (refresh #%u)", lines_in_refresh_,
+                 (unsigned) (now - refresh_started_ms_), (unsigned) refresh_count_);
+        // Lines written while this refresh was in flight go out in the next one
+        for (const auto &line : lines_)
+        {
+          if (line.dirty)
+          {
+            this->request_flush_();
+            break;
+          }
+        }
+        break;
+
+      default:
+        break;
+      }
+      this->record_blocking_(state, start_us);
+    }
+
+    void PaperDisplay::dump_config()
+    {
+      ESP_LOGCONFIG(TAG, "PaperDisplay:");
+      LOG_UPDATE_INTERVAL(this);
+      LOG_PIN("  Busy Pin: ", busy_pin_);
+#ifdef USE_ESPHIBOOST
+      ESP_LOGCONFIG(TAG, "  iBoost dashboard: %s", iboost_ != nullptr ? "yes" : "no");
+#endif
+      ESP_LOGCONFIG(TAG, "  Refreshes: %u, unchanged writes skipped: %u, loop time spent: %u ms",
+                    (unsigned) refresh_count_, (unsigned) skipped_writes_, (unsigned) (blocked_us_ / 1000));
+      ESP_LOGCONFIG(TAG, "  Full clears: %u, pixels drawn: %u, panel busy: %u ms", (unsigned) full_refresh_count_,
+                    (unsigned) pixels_drawn_, (unsigned) panel_busy_ms_);
+      if (!frame_.empty())
+        ESP_LOGCONFIG(TAG, "  Snapshot: /display/snapshot.pbm (%dx%d)", frame_width_, frame_height_);
+      for (int i = REFRESH_WAIT_READY; i < REFRESH_STATE_COUNT; i++)
+      {
+        ESP_LOGCONFIG(TAG, "  Worst loop() block in %s: %u us", refresh_state_name(static_cast<RefreshState>(i)),
+                      (unsigned) worst_blocking_us_[i]);
+      }
+    }
+
     void PaperDisplay::screen_Clear()
     {
       ESP_LOGV(TAG, "screen_Clear called");
       this->display.clear();
+      full_refresh_count_++;
+      if (!frame_.empty())
+      {
+        LockGuard lock(frame_lock_);
+        std::fill(frame_.begin(), frame_.end(), 0);
+      }
+      for (auto &line : lines_)
+      {
+        line.label.clear();
+        line.text.clear();
+        line.dirty = false;
+        line.label_dirty = false;
+      }
+    }
+
+    void PaperDisplay::set_line_(int index, const std::string &text)
+    {
+      ScreenLine &line = lines_[index];
+      if (line.text == text)
+      {
+        skipped_writes_++;
+        return;
+      }
+      line.text = text;
+      line.dirty = true;
+    }
+
+    void PaperDisplay::set_field_(int index, const char *label, const char *value)
+    {
+      ScreenLine &line = lines_[index];
+      if (line.label != label)
+      {
+        line.label = label;
+        line.label_dirty = true;
+        line.dirty = true;
+      }
+      this->set_line_(index, value);
+    }
+
+    // A live warning takes over the status line until it clears
+    void PaperDisplay::show_status_()
+    {
+      this->set_line_(STATUS_LINE, warning_text_.empty() ? status_text_ : warning_text_);
+    }
+
+#ifdef USE_ESPHIBOOST
+    // Formats the iBoost readout into the data lines. Only text is compared here;
+    // lines whose value did not change are left out of the next refresh.
+    void PaperDisplay::render_iboost_()
+    {
+      const esphiBoost::iBoostState &state = iboost_->get_live_state();
+      char value[48];
+      char other[24];
+
+      this->set_field_(FIRST_DATA_LINE + 0, "Mode", state.mode != nullptr ? state.mode : "Waiting for iBoost");
+
+      if (std::isnan(state.power))
+        snprintf(value, sizeof(value), "--");
+      else
+        snprintf(value, sizeof(value), "%.0f W  (import %.0f W)", state.power, state.import_power);
+      this->set_field_(FIRST_DATA_LINE + 1, "Heating", value);
+
+      // The power-integrated estimate moves between polls; fall back to the last reply
+      format_kwh(value, sizeof(value), std::isnan(state.today_estimate) ? state.today : state.today_estimate);
+      this->set_field_(FIRST_DATA_LINE + 2, "Today", value);
+      format_kwh(value, sizeof(value), state.yesterday);
+      this->set_field_(FIRST_DATA_LINE + 3, "Yesterday", value);
+
+      format_kwh(value, sizeof(value), state.last_7);
+      format_kwh(other, sizeof(other), state.last_28);
+      size_t length = strlen(value);
+      snprintf(value + length, sizeof(value) - length, " / %s", other);
+      this->set_field_(FIRST_DATA_LINE + 4, "7/28 days", value);
+
+      format_kwh(value, sizeof(value), state.total);
+      this->set_field_(FIRST_DATA_LINE + 5, "Total", value);
+
+      if (state.boost_time > 0)
+        snprintf(value, sizeof(value), "%u min left", (unsigned) state.boost_time);
+      else
+        snprintf(value, sizeof(value), "off");
+      this->set_field_(FIRST_DATA_LINE + 6, "Boost", value);
+
+      char rssi_iboost[8], rssi_buddy[8], rssi_sender[8];
+      format_rssi(rssi_iboost, sizeof(rssi_iboost), state.rssi_iboost);
+      format_rssi(rssi_buddy, sizeof(rssi_buddy), state.rssi_buddy);
+      format_rssi(rssi_sender, sizeof(rssi_sender), state.rssi_sender);
+      snprintf(value, sizeof(value), "iB %s  Bd %s  Tx %s dB", rssi_iboost, rssi_buddy, rssi_sender);
+      this->set_field_(FIRST_DATA_LINE + 7, "RSSI", value);
+
+      warning_text_ = state.warning;
+      this->show_status_();
+    }
+#endif
+
+    void PaperDisplay::request_flush_()
+    {
+      if (state_ != REFRESH_IDLE)
+        return; // picked up when the refresh in flight settles
+      for (const auto &line : lines_)
+      {
+        if (line.dirty)
+        {
+          state_ = REFRESH_WAIT_READY;
+          state_since_ms_ = millis();
+          return;
+        }
+      }
+    }
+
+    bool PaperDisplay::panel_busy_()
+    {
+      return busy_pin_ != nullptr && busy_pin_->digital_read();
     }
 
-    void screen_fastWriteMessage(EInkDisplay_WirelessPaperV1_1 &disp, const std::string &message, int yPos)
+    // Draws the next dirty line into the frame buffer; false once none are left
+    bool PaperDisplay::draw_next_line_()
     {
-      ESP_LOGV(TAG, "fast write called with message: %s at yPos: %d", message.c_str(), yPos);
-      disp.fastmodeOn();
-      disp.fillRect(TEXT_X_OFFSET, yPos, TEXT_CLEAR_WIDTH, TEXT_LINE_HEIGHT, WHITE);
-      disp.setCursor(TEXT_X_OFFSET, yPos);
-      disp.print(message.c_str());
-      disp.update();
-      disp.fastmodeOff();
-      delay(FAST_MODE_DELAY_MS);
-      ESP_LOGV(TAG, "fast write completed for message: %s", message.c_str());
+      for (; next_line_ < SCREEN_LINE_COUNT; next_line_++)
+      {
+        ScreenLine &line = lines_[next_line_];
+        if (!line.dirty)
+          continue;
+        int yPos = line_y_pos(next_line_);
+        int xPos = line.label.empty() ? TEXT_X_OFFSET : VALUE_X_OFFSET;
+        ESP_LOGV(TAG, "fast write line %d: %s at yPos: %d", next_line_, line.text.c_str(), yPos);
+        int left = xPos;
+        bool with_label = line.label_dirty || line.label.empty();
+        if (with_label)
+        {
+          left = TEXT_X_OFFSET;
+          this->display.fillRect(TEXT_X_OFFSET, yPos, TEXT_CLEAR_WIDTH, TEXT_LINE_HEIGHT, WHITE);
+          if (!line.label.empty())
+          {
+            this->display.setCursor(TEXT_X_OFFSET, yPos);
+            this->display.print(line.label.c_str());
+          }
+          line.label_dirty = false;
+        }
+        else
+        {
+          this->display.fillRect(xPos, yPos, TEXT_X_OFFSET + TEXT_CLEAR_WIDTH - xPos, TEXT_LINE_HEIGHT, WHITE);
+        }
+        this->display.setCursor(xPos, yPos);
+        this->display.print(line.text.c_str());
+        this->mirror_line_(line, with_label, left, yPos);
+        line.dirty = false;
+        lines_in_refresh_++;
+        next_line_++;
+        return true;
+      }
+      return false;
+    }
+
+    // Counts the strip just cleared and redrawn, and copies the line into the frame mirror.
+    // The mirror composes the text from the glyph atlas, which cuts it off at the right
+    // edge; whatever print() wrapped onto the next rows is missing from the snapshot.
+    void PaperDisplay::mirror_line_(const ScreenLine &line, bool with_label, int x, int y)
+    {
+      int right = std::min(TEXT_X_OFFSET + TEXT_CLEAR_WIDTH, static_cast<int>(this->display.width()));
+      if (x < right)
+        pixels_drawn_ += (right - x) * TEXT_LINE_HEIGHT;
+      if (frame_.empty())
+        return;
+      int xPos = line.label.empty() ? TEXT_X_OFFSET : VALUE_X_OFFSET;
+      line_bitmap_.clear();
+      if (with_label)
+        line_bitmap_.draw_text(atlas_, 0, line.label.c_str());
+      line_bitmap_.draw_text(atlas_, xPos - x, line.text.c_str());
+      LockGuard lock(frame_lock_);
+      line_bitmap_.copy_to(frame_.data(), frame_stride_, frame_width_, frame_height_, x, y);
+    }
+
+    void PaperDisplay::render_snapshot(std::string &out)
+    {
+      out.clear();
+      if (frame_.empty())
+        return;
+      char header[160];
+      snprintf(header, sizeof(header),
+               "P4\n# refreshes %u, full clears %u, pixels drawn %u, panel busy %u ms, loop time %u ms\n%d %d\n",
+               (unsigned) refresh_count_, (unsigned) full_refresh_count_, (unsigned) pixels_drawn_,
+               (unsigned) panel_busy_ms_, (unsigned) (blocked_us_ / 1000), frame_width_, frame_height_);
+      out.reserve(strlen(header) + frame_.size());
+      out.append(header);
+      LockGuard lock(frame_lock_);
+      out.append(reinterpret_cast<const char *>(frame_.data()), frame_.size());
+    }
+
+    void PaperDisplay::record_blocking_(RefreshState state, uint32_t start_us)
+    {
+      uint32_t elapsed = micros() - start_us;
+      blocked_us_ += elapsed;
+      if (elapsed > worst_blocking_us_[state])
+      {
+        worst_blocking_us_[state] = elapsed;
+        ESP_LOGV(TAG, "New worst loop() block in %s: %u us", refresh_state_name(state), (unsigned) elapsed);
+      }
     }
 
     void PaperDisplay::screen_writeDataLine(int Line, const std::string &data)
@@ -75,28 +462,20 @@ namespace esphome
         ESP_LOGW(TAG, "Invalid line number: %d", Line);
         return;
       }
-      int yPos = DATA_START_Y_POS + (Line - 1) * TEXT_LINE_HEIGHT;
-      screen_fastWriteMessage(this->display, data, yPos);
-    }
-
-    void screen_writeMessage(EInkDisplay_WirelessPaperV1_1 &disp, const std::string &message, int yPos)
-    {
-      ESP_LOGV(TAG, "Write Message called with message: %s at yPos: %d", message.c_str(), yPos);
-      disp.setCursor(10, yPos);
-      disp.print(message.c_str());
-      disp.update();
+      this->set_field_(FIRST_DATA_LINE + Line - 1, "", data.c_str());
     }
 
     void PaperDisplay::screen_writeStatusLine(const std::string &status)
     {
       ESP_LOGV(TAG, "Write Status Line called with status: %s", status.c_str());
-      screen_fastWriteMessage(this->display, status, STATUS_Y_POS);
+      status_text_ = status;
+      this->show_status_();
     }
 
     void PaperDisplay::screen_writeTitleLine(const std::string &title)
     {
       ESP_LOGV(TAG, "write Title Line called with title: %s", title.c_str());
-      screen_fastWriteMessage(this->display, title, TITLE_Y_POS);
+      this->set_line_(TITLE_LINE, title);
     }
 
   } // namespace esphWirelessPaper
@@ -1,12 +1,30 @@
 #pragma once
 #include "esphome.h"
 #include "heltec-eink-modules.h"
+#include "glyph_renderer.h"
+#ifdef USE_ESPHIBOOST
+#include "esphome/components/esphiBoost/esphiBoost.h"
+#endif
 
 namespace esphome
 {
   namespace esphWirelessPaper
   {
 
+    // Title, status and eight data lines
+    static const int SCREEN_LINE_COUNT = 10;
+
+    // Stages of a partial refresh, advanced one step per loop()
+    enum RefreshState : uint8_t
+    {
+      REFRESH_IDLE = 0,
+      REFRESH_WAIT_READY, // waiting for the panel BUSY line (and the power-on delay after setup)
+      REFRESH_DRAW,       // drawing one dirty line into the frame buffer per loop
+      REFRESH_PUSH,       // sending the frame to the panel; blocks for the whole refresh
+      REFRESH_SETTLE,     // a short pause before leaving fast mode
+      REFRESH_STATE_COUNT,
+    };
+
     class PaperDisplay : public PollingComponent
     {
     public:
@@ -19,12 +37,89 @@ namespace esphome
       {
         config_TopTitle = top_title;
       }
+      void set_busy_pin(GPIOPin *pin) { busy_pin_ = pin; }
+#ifdef USE_ESPHIBOOST
+      // Fills the data lines from the iBoost handler's live state on every update()
+      void set_iboost(esphiBoost::iBoostBuddy *iboost) { iboost_ = iboost; }
+#endif
+
       void setup() override;
+      void loop() override;
       void update() override;
+      void dump_config() override;
       void screen_Clear();
       void screen_writeDataLine(int Line, const std::string &data);
       void screen_writeStatusLine(const std::string &status);
       void screen_writeTitleLine(const std::string &title);
+
+      // Refresh statistics
+      uint32_t get_refresh_count() const { return refresh_count_; }
+      uint32_t get_skipped_writes() const { return skipped_writes_; }
+      uint32_t get_blocked_ms() const { return blocked_us_ / 1000; }
+      uint32_t get_full_refresh_count() const { return full_refresh_count_; }
+      uint32_t get_pixels_drawn() const { return pixels_drawn_; }
+      uint32_t get_panel_busy_ms() const { return panel_busy_ms_; }
+
+      // What the panel was last told to show, as a binary PBM (P4) with the refresh
+      // statistics in comment lines; empty until the frame mirror exists
+      void render_snapshot(std::string &out);
+
+    protected:
+      // Shadow of what each line should show; writes only mark lines dirty and
+      // update() pushes all dirty lines to the panel in one partial refresh.
+      // A fixed label stays in the frame buffer once drawn, so a value change
+      // only clears and redraws the value to its right.
+      struct ScreenLine
+      {
+        std::string label;
+        std::string text;
+        bool dirty = false;
+        bool label_dirty = false;
+      };
+
+      void set_line_(int index, const std::string &text);
+      void set_field_(int index, const char *label, const char *value);
+      void show_status_();
+#ifdef USE_ESPHIBOOST
+      void render_iboost_();
+#endif
+      void request_flush_();
+      bool panel_busy_();
+      bool draw_next_line_();
+      void record_blocking_(RefreshState state, uint32_t start_us);
+
+      void mirror_line_(const ScreenLine &line, bool with_label, int x, int y);
+
+      ScreenLine lines_[SCREEN_LINE_COUNT];
+      // Copy of the frame buffer for /display/snapshot.pbm, kept only when web_server is
+      // present; lines are composed into it from the glyph atlas
+      GlyphAtlas atlas_;       // built in setup() along with the copy
+      LineBitmap line_bitmap_; // scratch for the line being copied
+      std::vector<uint8_t> frame_;
+      int frame_width_ = 0;
+      int frame_height_ = 0;
+      int frame_stride_ = 0;
+      Mutex frame_lock_;
+      std::string status_text_;   // last status written through the API
+      std::string warning_text_;  // shown on the status line instead while set
+      GPIOPin *busy_pin_ = nullptr;
+#ifdef USE_ESPHIBOOST
+      esphiBoost::iBoostBuddy *iboost_ = nullptr;
+#endif
+      RefreshState state_ = REFRESH_IDLE;
+      uint32_t state_since_ms_ = 0;
+      uint32_t ready_at_ms_ = 0; // earliest time the next stage may run
+      int next_line_ = 0;
+      int lines_in_refresh_ = 0;
+      uint32_t refresh_started_ms_ = 0;
+
+      uint32_t refresh_count_ = 0;
+      uint32_t skipped_writes_ = 0;
+      uint32_t blocked_us_ = 0;
+      uint32_t full_refresh_count_ = 0;
+      uint32_t pixels_drawn_ = 0;  // area cleared and redrawn in the frame buffer
+      uint32_t panel_busy_ms_ = 0; // spent in the driver's update(), waiting for the panel
+      uint32_t worst_blocking_us_[REFRESH_STATE_COUNT] = {};
     };
 
   } // namespace esphWirelessPaper
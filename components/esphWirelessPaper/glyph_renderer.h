@@ -0,0 +1,127 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include "heltec-eink-modules.h"
+
+namespace esphome
+{
+  namespace esphWirelessPaper
+  {
+
+    // The GFX built-in 5x7 font at text size 1: 6 px advance, 8 rows
+    static const int GLYPH_ADVANCE = 6;
+    static const int GLYPH_ROWS = 8;
+    static const char GLYPH_FIRST = 0x20;
+    static const char GLYPH_LAST = 0x7E;
+    static const int GLYPH_COUNT = GLYPH_LAST - GLYPH_FIRST + 1;
+
+    // Printable ASCII rendered once through GFX into a 1bpp canvas, then kept as one
+    // byte per glyph row (MSB = leftmost pixel), so drawing text never goes back
+    // through the pixel-by-pixel GFX font code. Anything else is drawn as '?'.
+    class GlyphAtlas
+    {
+    public:
+      void build()
+      {
+        GFXcanvas1 canvas(GLYPH_ADVANCE * GLYPH_COUNT, GLYPH_ROWS);
+        canvas.fillScreen(0);
+        canvas.setTextWrap(false);
+        for (int i = 0; i < GLYPH_COUNT; i++)
+          canvas.drawChar(i * GLYPH_ADVANCE, 0, static_cast<unsigned char>(GLYPH_FIRST + i), 1, 0, 1);
+        for (int i = 0; i < GLYPH_COUNT; i++)
+        {
+          for (int row = 0; row < GLYPH_ROWS; row++)
+          {
+            uint8_t bits = 0;
+            for (int col = 0; col < GLYPH_ADVANCE; col++)
+            {
+              if (canvas.getPixel(i * GLYPH_ADVANCE + col, row))
+                bits |= 0x80 >> col;
+            }
+            rows_[i][row] = bits;
+          }
+        }
+        built_ = true;
+      }
+
+      bool is_built() const { return built_; }
+
+      const uint8_t *glyph(char c) const
+      {
+        if (c < GLYPH_FIRST || c > GLYPH_LAST)
+          c = '?';
+        return rows_[c - GLYPH_FIRST];
+      }
+
+    protected:
+      uint8_t rows_[GLYPH_COUNT][GLYPH_ROWS] = {};
+      bool built_ = false;
+    };
+
+    // One text line as a packed 1bpp bitmap in the layout GFX drawBitmap() takes
+    // (rows of WIDTH / 8 bytes, MSB first), so a whole line, background included,
+    // reaches the display buffer in a single call instead of a fillRect plus a print.
+    // Text past the right edge is cut off rather than wrapped.
+    class LineBitmap
+    {
+    public:
+      static const int WIDTH = 256;
+      static const int HEIGHT = 10;
+      static const int STRIDE = WIDTH / 8;
+
+      void clear() { memset(bits_, 0, sizeof(bits_)); }
+
+      // Draws `text` starting `x` pixels into the line; returns the x after the last glyph
+      int draw_text(const GlyphAtlas &atlas, int x, const char *text)
+      {
+        for (; *text != '\0' && x + GLYPH_ADVANCE <= WIDTH; text++, x += GLYPH_ADVANCE)
+        {
+          const uint8_t *glyph = atlas.glyph(*text);
+          int byte = x >> 3;
+          int shift = x & 7;
+          for (int row = 0; row < GLYPH_ROWS; row++)
+          {
+            // A glyph row straddles at most two bytes; place both halves with one 16-bit shift
+            uint16_t word = static_cast<uint16_t>(glyph[row] << 8) >> shift;
+            uint8_t *dest = &bits_[row][byte];
+            dest[0] |= word >> 8;
+            if (byte + 1 < STRIDE)
+              dest[1] |= word & 0xFF;
+          }
+        }
+        return x;
+      }
+
+      const uint8_t *data() const { return &bits_[0][0]; }
+
+      // Places the line into a packed 1bpp frame (same bit order) at x, y. Like the
+      // drawBitmap() call it mirrors, it replaces everything from x to the right edge.
+      void copy_to(uint8_t *frame, int frame_stride, int frame_width, int frame_height, int x, int y) const
+      {
+        if (x < 0 || x >= frame_width)
+          return;
+        int first = x >> 3;
+        int shift = x & 7;
+        int last = (frame_width - 1) >> 3;
+        for (int row = 0; row < HEIGHT && y + row < frame_height; row++)
+        {
+          uint8_t *dest = frame + (y + row) * frame_stride;
+          dest[first] &= static_cast<uint8_t>(0xFF00 >> shift);
+          if (last > first)
+            memset(dest + first + 1, 0, last - first);
+          for (int i = 0; i < STRIDE && first + i <= last; i++)
+          {
+            uint16_t word = static_cast<uint16_t>(bits_[row][i] << 8) >> shift;
+            dest[first + i] |= word >> 8;
+            if (first + i + 1 <= last)
+              dest[first + i + 1] |= word & 0xFF;
+          }
+        }
+      }
+
+    protected:
+      uint8_t bits_[HEIGHT][STRIDE] = {};
+    };
+
+  } // namespace esphWirelessPaper
+} // namespace esphome
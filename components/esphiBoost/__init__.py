@@ -1,14 +1,32 @@
+import hashlib
+
 import esphome.codegen as cg
 import esphome.config_validation as cv
+import esphome.final_validate as fv
 from esphome.const import CONF_ID
 from esphome.components import sensor, text_sensor, time
 
+DEPENDENCIES = ["sx126x"]
+AUTO_LOAD = ["sensor", "text_sensor", "time"]
+MULTI_CONF = True
+
 iBoost_ns = cg.esphome_ns.namespace("esphiBoost")
 iBoostBuddy = iBoost_ns.class_("iBoostBuddy", cg.PollingComponent)
 
 sx126x_ns = cg.esphome_ns.namespace("sx126x")
 SX126x = sx126x_ns.class_("SX126x")
 
+# Sensors sharing a unit share a publish policy (PublishClass in publish_filter.h)
+PublishClass = iBoost_ns.enum("PublishClass")
+PUBLISH_CLASSES = {
+    "power": PublishClass.PUBLISH_CLASS_POWER,
+    "energy": PublishClass.PUBLISH_CLASS_ENERGY,
+    "signal": PublishClass.PUBLISH_CLASS_SIGNAL,
+    "percent": PublishClass.PUBLISH_CLASS_PERCENT,
+    "duration": PublishClass.PUBLISH_CLASS_DURATION,
+    "text": PublishClass.PUBLISH_CLASS_TEXT,
+}
+
 # Optional outputs
 CONF_PACKET_COUNT = "packet_count"
 CONF_LAST_PACKET = "last_packet"
@@ -16,17 +34,111 @@ CONF_HEATING_MODE = "heating_mode"
 CONF_HEATING_WARN = "heating_warn"
 CONF_HEATING_POWER = "heating_power"
 CONF_HEATING_IMPORT = "heating_import"
+CONF_SENDER_IMPORT = "sender_import"
 CONF_HEATING_BOOST = "heating_boost_time"
 CONF_HEATING_TODAY = "heating_today"
+CONF_HEATING_TODAY_ESTIMATE = "heating_today_estimate"
 CONF_HEATING_YESTERDAY = "heating_yesterday"
 CONF_HEATING_LAST7 = "heating_last_7"
 CONF_HEATING_LAST28 = "heating_last_28"
 CONF_HEATING_TOTAL = "heating_last_gt"
 CONF_TIME = "time_id"
 CONF_RADIO_ID = "radio_id"
+CONF_SYSTEM_ADDRESS = "system_address"
 CONF_RSSI_IBOOST = "rssi_iboost"
 CONF_RSSI_BUDDY = "rssi_buddy"
 CONF_RSSI_SENDER = "rssi_sender"
+CONF_LINK_LOSS_IBOOST = "link_loss_iboost"
+CONF_LINK_LOSS_BUDDY = "link_loss_buddy"
+CONF_LINK_LOSS_SENDER = "link_loss_sender"
+CONF_PUBLISH_SUPPRESSED = "publish_suppressed"
+CONF_SCHEDULER_STATUS = "scheduler_status"
+CONF_LATENCY_P50 = "latency_p50"
+CONF_LATENCY_P95 = "latency_p95"
+CONF_LATENCY_P99 = "latency_p99"
+CONF_REQUEST_LOSS_RATE = "request_loss_rate"
+CONF_RX_QUEUE_DEPTH = "rx_queue_depth"
+CONF_RX_QUEUE_DROPS = "rx_queue_drops"
+CONF_FIRST_DATA_TIME = "first_data_time"
+CONF_ROLLUP_POWER = "rollup_power"
+CONF_ROLLUP_IMPORT = "rollup_import"
+CONF_DUPLICATE_RATE_IBOOST = "duplicate_rate_iboost"
+CONF_DUPLICATE_RATE_BUDDY = "duplicate_rate_buddy"
+CONF_DUPLICATE_RATE_SENDER = "duplicate_rate_sender"
+CONF_BOOST_COMMAND_STATUS = "boost_command_status"
+CONF_BOOST_COMMAND_LATENCY = "boost_command_latency"
+
+# Flash history log (needs a data partition, iboost_log by default)
+CONF_HISTORY_LOG = "history_log"
+CONF_HISTORY_PARTITION = "history_partition"
+CONF_RX_DUTY_CYCLE = "rx_duty_cycle"
+
+# Warm start
+CONF_RESTORE = "restore"
+CONF_SAVE_INTERVAL = "save_interval"
+
+# Publish deduplication / rate limiting
+CONF_PUBLISH_DEADBAND = "publish_deadband"
+CONF_PUBLISH_MIN_INTERVAL = "publish_min_interval"
+CONF_PUBLISH_MAX_INTERVAL = "publish_max_interval"
+CONF_PUBLISH_POLICY = "publish_policy"
+CONF_DEADBAND = "deadband"
+CONF_MIN_INTERVAL = "min_interval"
+CONF_MAX_INTERVAL = "max_interval"
+CONF_STATS_INTERVAL = "stats_interval"
+CONF_LINK_QUALITY_INTERVAL = "link_quality_interval"
+
+# Raw frame capture ring
+CONF_CAPTURE_FRAMES = "capture_frames"
+
+# Repeated frame filter
+CONF_DUPLICATE_WINDOW = "duplicate_window"
+
+# Outputs whose code is only compiled in when at least one instance configures one
+# of them; each group maps to a USE_IBOOST_* define checked in esphiBoost.h/.cpp.
+# Defines are global, so with several instances a group is compiled into all of them
+# as soon as one configures it; the others then only pay for its null checks.
+OUTPUT_GROUPS = {
+    "USE_IBOOST_STATUS_SENSORS": [
+        CONF_PACKET_COUNT,
+        CONF_HEATING_MODE,
+        CONF_HEATING_WARN,
+        CONF_HEATING_POWER,
+        CONF_HEATING_IMPORT,
+        CONF_HEATING_BOOST,
+        CONF_BOOST_COMMAND_STATUS,
+    ],
+    "USE_IBOOST_ENERGY_SENSORS": [
+        CONF_HEATING_TODAY,
+        CONF_HEATING_TODAY_ESTIMATE,
+        CONF_HEATING_YESTERDAY,
+        CONF_HEATING_LAST7,
+        CONF_HEATING_LAST28,
+        CONF_HEATING_TOTAL,
+    ],
+    "USE_IBOOST_RSSI_SENSORS": [CONF_RSSI_IBOOST, CONF_RSSI_BUDDY, CONF_RSSI_SENDER],
+    "USE_IBOOST_SENDER_IMPORT": [CONF_SENDER_IMPORT],
+    "USE_IBOOST_LAST_PACKET": [CONF_LAST_PACKET],
+    "USE_IBOOST_DIAGNOSTICS": [
+        CONF_LINK_LOSS_IBOOST,
+        CONF_LINK_LOSS_BUDDY,
+        CONF_LINK_LOSS_SENDER,
+        CONF_PUBLISH_SUPPRESSED,
+        CONF_SCHEDULER_STATUS,
+        CONF_LATENCY_P50,
+        CONF_LATENCY_P95,
+        CONF_LATENCY_P99,
+        CONF_REQUEST_LOSS_RATE,
+        CONF_RX_QUEUE_DEPTH,
+        CONF_RX_QUEUE_DROPS,
+        CONF_FIRST_DATA_TIME,
+        CONF_DUPLICATE_RATE_IBOOST,
+        CONF_DUPLICATE_RATE_BUDDY,
+        CONF_DUPLICATE_RATE_SENDER,
+        CONF_BOOST_COMMAND_LATENCY,
+    ],
+    "USE_IBOOST_ROLLUP_SENSORS": [CONF_ROLLUP_POWER, CONF_ROLLUP_IMPORT],
+}
 
 CONFIG_SCHEMA = (
     cv.Schema(
@@ -38,24 +150,126 @@ CONFIG_SCHEMA = (
             cv.Optional(CONF_HEATING_WARN): cv.use_id(text_sensor.TextSensor),
             cv.Optional(CONF_HEATING_POWER): cv.use_id(sensor.Sensor),
             cv.Optional(CONF_HEATING_IMPORT): cv.use_id(sensor.Sensor),
+            cv.Optional(CONF_SENDER_IMPORT): cv.use_id(sensor.Sensor),
             cv.Optional(CONF_HEATING_BOOST): cv.use_id(sensor.Sensor),
             cv.Optional(CONF_HEATING_TODAY): cv.use_id(sensor.Sensor),
+            cv.Optional(CONF_HEATING_TODAY_ESTIMATE): cv.use_id(sensor.Sensor),
             cv.Optional(CONF_HEATING_YESTERDAY): cv.use_id(sensor.Sensor),
             cv.Optional(CONF_HEATING_LAST7): cv.use_id(sensor.Sensor),
             cv.Optional(CONF_HEATING_LAST28): cv.use_id(sensor.Sensor),
             cv.Optional(CONF_HEATING_TOTAL): cv.use_id(sensor.Sensor),
             cv.Optional(CONF_TIME): cv.use_id(time.RealTimeClock),
             cv.Optional(CONF_RADIO_ID): cv.use_id(SX126x),
+            cv.Optional(CONF_SYSTEM_ADDRESS): cv.hex_uint16_t,
             cv.Optional(CONF_RSSI_IBOOST): cv.use_id(sensor.Sensor),
             cv.Optional(CONF_RSSI_BUDDY): cv.use_id(sensor.Sensor),
             cv.Optional(CONF_RSSI_SENDER): cv.use_id(sensor.Sensor),
+            cv.Optional(CONF_LINK_LOSS_IBOOST): cv.use_id(sensor.Sensor),
+            cv.Optional(CONF_LINK_LOSS_BUDDY): cv.use_id(sensor.Sensor),
+            cv.Optional(CONF_LINK_LOSS_SENDER): cv.use_id(sensor.Sensor),
+            cv.Optional(CONF_PUBLISH_SUPPRESSED): cv.use_id(sensor.Sensor),
+            cv.Optional(CONF_SCHEDULER_STATUS): cv.use_id(text_sensor.TextSensor),
+            cv.Optional(CONF_LATENCY_P50): cv.use_id(sensor.Sensor),
+            cv.Optional(CONF_LATENCY_P95): cv.use_id(sensor.Sensor),
+            cv.Optional(CONF_LATENCY_P99): cv.use_id(sensor.Sensor),
+            cv.Optional(CONF_REQUEST_LOSS_RATE): cv.use_id(sensor.Sensor),
+            cv.Optional(CONF_RX_QUEUE_DEPTH): cv.use_id(sensor.Sensor),
+            cv.Optional(CONF_RX_QUEUE_DROPS): cv.use_id(sensor.Sensor),
+            cv.Optional(CONF_FIRST_DATA_TIME): cv.use_id(sensor.Sensor),
+            cv.Optional(CONF_ROLLUP_POWER): cv.use_id(sensor.Sensor),
+            cv.Optional(CONF_ROLLUP_IMPORT): cv.use_id(sensor.Sensor),
+            cv.Optional(CONF_DUPLICATE_RATE_IBOOST): cv.use_id(sensor.Sensor),
+            cv.Optional(CONF_DUPLICATE_RATE_BUDDY): cv.use_id(sensor.Sensor),
+            cv.Optional(CONF_DUPLICATE_RATE_SENDER): cv.use_id(sensor.Sensor),
+            cv.Optional(CONF_BOOST_COMMAND_STATUS): cv.use_id(text_sensor.TextSensor),
+            cv.Optional(CONF_BOOST_COMMAND_LATENCY): cv.use_id(sensor.Sensor),
+            cv.Optional(CONF_RESTORE, default=True): cv.boolean,
+            cv.Optional(CONF_HISTORY_LOG, default=False): cv.All(cv.boolean, cv.only_on_esp32),
+            # ESP-IDF partition labels are at most 16 characters
+            cv.Optional(CONF_HISTORY_PARTITION, default="iboost_log"): cv.All(cv.string_strict, cv.Length(min=1, max=16)),
+            cv.Optional(CONF_RX_DUTY_CYCLE, default=False): cv.boolean,
+            cv.Optional(CONF_SAVE_INTERVAL, default="10min"): cv.All(
+                cv.positive_time_period_milliseconds,
+                cv.Range(min=cv.TimePeriod(minutes=1)),
+            ),
+            # Without a default, so each class keeps its own unless these are set
+            cv.Optional(CONF_PUBLISH_DEADBAND): cv.positive_float,
+            cv.Optional(CONF_PUBLISH_MIN_INTERVAL): cv.positive_time_period_milliseconds,
+            cv.Optional(CONF_PUBLISH_MAX_INTERVAL): cv.positive_time_period_milliseconds,
+            cv.Optional(CONF_PUBLISH_POLICY): cv.Schema(
+                {
+                    cv.Optional(name): cv.Schema(
+                        {
+                            cv.Optional(CONF_DEADBAND): cv.positive_float,
+                            cv.Optional(CONF_MIN_INTERVAL): cv.positive_time_period_milliseconds,
+                            cv.Optional(CONF_MAX_INTERVAL): cv.positive_time_period_milliseconds,
+                        }
+                    )
+                    for name in PUBLISH_CLASSES
+                }
+            ),
+            cv.Optional(CONF_STATS_INTERVAL, default="30s"): cv.All(
+                cv.positive_time_period_milliseconds,
+                cv.Range(min=cv.TimePeriod(seconds=1)),
+            ),
+            cv.Optional(CONF_LINK_QUALITY_INTERVAL, default="60s"): cv.All(
+                cv.positive_time_period_milliseconds,
+                cv.Range(min=cv.TimePeriod(seconds=5)),
+            ),
+            cv.Optional(CONF_CAPTURE_FRAMES, default=64): cv.int_range(min=0, max=1024),
+            # Must stay below the units' transmit period, or unchanged frames are lost
+            cv.Optional(CONF_DUPLICATE_WINDOW, default="1s"): cv.All(
+                cv.positive_time_period_milliseconds,
+                cv.Range(max=cv.TimePeriod(seconds=5)),
+            ),
         }
     ).extend(cv.polling_component_schema("10s"))
 )
 
+
+def _final_validate(config):
+    others = [
+        other for other in fv.full_config.get().get("esphiBoost", []) if other[CONF_ID].id != config[CONF_ID].id
+    ]
+    # Two logs rotating through one partition would erase each other's sectors
+    if config[CONF_HISTORY_LOG]:
+        for other in others:
+            if other[CONF_HISTORY_LOG] and other[CONF_HISTORY_PARTITION] == config[CONF_HISTORY_PARTITION]:
+                raise cv.Invalid(
+                    f"Another instance already logs history to '{config[CONF_HISTORY_PARTITION]}'; "
+                    f"give each instance its own {CONF_HISTORY_PARTITION}",
+                    path=[CONF_HISTORY_PARTITION],
+                )
+    # Sleeping the radio would deafen any other instance listening on it
+    if config[CONF_RX_DUTY_CYCLE] and CONF_RADIO_ID in config:
+        radio = config[CONF_RADIO_ID].id
+        for other in others:
+            if CONF_RADIO_ID in other and other[CONF_RADIO_ID].id == radio:
+                raise cv.Invalid(
+                    f"{CONF_RX_DUTY_CYCLE} needs the radio to itself, but another instance also uses '{radio}'",
+                    path=[CONF_RX_DUTY_CYCLE],
+                )
+
+
+FINAL_VALIDATE_SCHEMA = _final_validate
+
+
 async def to_code(config):
     var = cg.new_Pvariable(config[CONF_ID])
     await cg.register_component(var, config)
+    cg.add_define("USE_ESPHIBOOST")
+    cg.add(var.set_instance_id(config[CONF_ID].id))
+    if config[CONF_HISTORY_LOG]:
+        # The define only compiles the log in; each instance opens its own partition
+        cg.add_define("USE_IBOOST_HISTORY")
+        cg.add(var.set_history_partition(config[CONF_HISTORY_PARTITION]))
+    if config[CONF_RX_DUTY_CYCLE]:
+        # Compiles the code in for every instance; only this one turns it on
+        cg.add_define("USE_IBOOST_RX_DUTY_CYCLE")
+        cg.add(var.set_rx_duty_cycle(True))
+    for define, keys in OUTPUT_GROUPS.items():
+        if any(key in config for key in keys):
+            cg.add_define(define)
 
     if CONF_PACKET_COUNT in config:
         s = await cg.get_variable(config[CONF_PACKET_COUNT])
@@ -75,12 +289,18 @@ async def to_code(config):
     if CONF_HEATING_IMPORT in config:
         s = await cg.get_variable(config[CONF_HEATING_IMPORT])
         cg.add(var.set_heating_import(s))
+    if CONF_SENDER_IMPORT in config:
+        s = await cg.get_variable(config[CONF_SENDER_IMPORT])
+        cg.add(var.set_sender_import(s))
     if CONF_HEATING_BOOST in config:
         s = await cg.get_variable(config[CONF_HEATING_BOOST])
         cg.add(var.set_heating_boost_time(s))
     if CONF_HEATING_TODAY in config:
         s = await cg.get_variable(config[CONF_HEATING_TODAY])
         cg.add(var.set_heating_today(s))
+    if CONF_HEATING_TODAY_ESTIMATE in config:
+        s = await cg.get_variable(config[CONF_HEATING_TODAY_ESTIMATE])
+        cg.add(var.set_heating_today_estimate(s))
     if CONF_HEATING_YESTERDAY in config:
         s = await cg.get_variable(config[CONF_HEATING_YESTERDAY])
         cg.add(var.set_heating_yesterday(s))
@@ -99,6 +319,8 @@ async def to_code(config):
     if CONF_RADIO_ID in config:
         r = await cg.get_variable(config[CONF_RADIO_ID])
         cg.add(var.set_radio(r))
+    if CONF_SYSTEM_ADDRESS in config:
+        cg.add(var.set_system_address(config[CONF_SYSTEM_ADDRESS]))
     if CONF_RSSI_IBOOST in config:
         s = await cg.get_variable(config[CONF_RSSI_IBOOST])
         cg.add(var.set_rssi_iboost(s))
@@ -108,3 +330,83 @@ async def to_code(config):
     if CONF_RSSI_SENDER in config:
         s = await cg.get_variable(config[CONF_RSSI_SENDER])
         cg.add(var.set_rssi_sender(s))
+    if CONF_LINK_LOSS_IBOOST in config:
+        s = await cg.get_variable(config[CONF_LINK_LOSS_IBOOST])
+        cg.add(var.set_link_loss_iboost(s))
+    if CONF_LINK_LOSS_BUDDY in config:
+        s = await cg.get_variable(config[CONF_LINK_LOSS_BUDDY])
+        cg.add(var.set_link_loss_buddy(s))
+    if CONF_LINK_LOSS_SENDER in config:
+        s = await cg.get_variable(config[CONF_LINK_LOSS_SENDER])
+        cg.add(var.set_link_loss_sender(s))
+    if CONF_PUBLISH_SUPPRESSED in config:
+        s = await cg.get_variable(config[CONF_PUBLISH_SUPPRESSED])
+        cg.add(var.set_publish_suppressed(s))
+    if CONF_SCHEDULER_STATUS in config:
+        t = await cg.get_variable(config[CONF_SCHEDULER_STATUS])
+        cg.add(var.set_scheduler_status(t))
+    if CONF_LATENCY_P50 in config:
+        s = await cg.get_variable(config[CONF_LATENCY_P50])
+        cg.add(var.set_latency_p50(s))
+    if CONF_LATENCY_P95 in config:
+        s = await cg.get_variable(config[CONF_LATENCY_P95])
+        cg.add(var.set_latency_p95(s))
+    if CONF_LATENCY_P99 in config:
+        s = await cg.get_variable(config[CONF_LATENCY_P99])
+        cg.add(var.set_latency_p99(s))
+    if CONF_REQUEST_LOSS_RATE in config:
+        s = await cg.get_variable(config[CONF_REQUEST_LOSS_RATE])
+        cg.add(var.set_request_loss_rate(s))
+    if CONF_RX_QUEUE_DEPTH in config:
+        s = await cg.get_variable(config[CONF_RX_QUEUE_DEPTH])
+        cg.add(var.set_rx_queue_depth(s))
+    if CONF_RX_QUEUE_DROPS in config:
+        s = await cg.get_variable(config[CONF_RX_QUEUE_DROPS])
+        cg.add(var.set_rx_queue_drops(s))
+    if CONF_FIRST_DATA_TIME in config:
+        s = await cg.get_variable(config[CONF_FIRST_DATA_TIME])
+        cg.add(var.set_first_data_time(s))
+    if CONF_ROLLUP_POWER in config:
+        s = await cg.get_variable(config[CONF_ROLLUP_POWER])
+        cg.add(var.set_rollup_power(s))
+    if CONF_ROLLUP_IMPORT in config:
+        s = await cg.get_variable(config[CONF_ROLLUP_IMPORT])
+        cg.add(var.set_rollup_import(s))
+    if CONF_DUPLICATE_RATE_IBOOST in config:
+        s = await cg.get_variable(config[CONF_DUPLICATE_RATE_IBOOST])
+        cg.add(var.set_duplicate_rate_iboost(s))
+    if CONF_DUPLICATE_RATE_BUDDY in config:
+        s = await cg.get_variable(config[CONF_DUPLICATE_RATE_BUDDY])
+        cg.add(var.set_duplicate_rate_buddy(s))
+    if CONF_DUPLICATE_RATE_SENDER in config:
+        s = await cg.get_variable(config[CONF_DUPLICATE_RATE_SENDER])
+        cg.add(var.set_duplicate_rate_sender(s))
+    if CONF_BOOST_COMMAND_STATUS in config:
+        t = await cg.get_variable(config[CONF_BOOST_COMMAND_STATUS])
+        cg.add(var.set_boost_command_status(t))
+    if CONF_BOOST_COMMAND_LATENCY in config:
+        s = await cg.get_variable(config[CONF_BOOST_COMMAND_LATENCY])
+        cg.add(var.set_boost_command_latency(s))
+    if config[CONF_RESTORE]:
+        # Keyed on the component id so several instances keep separate state
+        hash_ = int(hashlib.md5(config[CONF_ID].id.encode()).hexdigest()[:8], 16)
+        cg.add(var.set_restore(hash_ or 1))
+        cg.add(var.set_save_interval(config[CONF_SAVE_INTERVAL]))
+
+    # The publish_* options apply to every class; publish_policy overrides them per class
+    policies = config.get(CONF_PUBLISH_POLICY, {})
+    for name, publish_class in PUBLISH_CLASSES.items():
+        policy = policies.get(name, {})
+        deadband = policy.get(CONF_DEADBAND, config.get(CONF_PUBLISH_DEADBAND))
+        if deadband is not None:
+            cg.add(var.set_publish_deadband(publish_class, deadband))
+        min_interval = policy.get(CONF_MIN_INTERVAL, config.get(CONF_PUBLISH_MIN_INTERVAL))
+        if min_interval is not None:
+            cg.add(var.set_publish_min_interval(publish_class, min_interval))
+        max_interval = policy.get(CONF_MAX_INTERVAL, config.get(CONF_PUBLISH_MAX_INTERVAL))
+        if max_interval is not None:
+            cg.add(var.set_publish_max_interval(publish_class, max_interval))
+    cg.add(var.set_stats_interval(config[CONF_STATS_INTERVAL]))
+    cg.add(var.set_link_quality_interval(config[CONF_LINK_QUALITY_INTERVAL]))
+    cg.add(var.set_capture_frames(config[CONF_CAPTURE_FRAMES]))
+    cg.add(var.set_duplicate_window(config[CONF_DUPLICATE_WINDOW]))
@@ -0,0 +1,192 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include "iboost_protocol.h"
+
+namespace esphome
+{
+    namespace esphiBoost
+    {
+
+        // Airtime of a frame at the 100 kbit/s FSK the example config uses:
+        // 4 preamble + 4 sync + 1 length + payload + 2 CRC bytes
+        constexpr uint32_t frame_airtime_us(size_t length) { return (4 + 4 + 1 + length + 2) * 8 * 10; }
+        static constexpr uint32_t CONTROL_FRAME_AIRTIME_US = frame_airtime_us(BUDDY_CONTROL_FRAME_LENGTH);
+
+        // 868.0-868.6 MHz (ETSI EN 300 220 band g1) allows a 1% transmit duty cycle. Every
+        // transmission earns an off-time of 99x its airtime, and the hour's total airtime
+        // is capped; retries are held back until both allow another frame.
+        class DutyCycleLimiter
+        {
+        public:
+            static constexpr uint32_t DUTY_CYCLE_PERCENT = 1;
+            static constexpr uint32_t WINDOW_MS = 3600000;
+            static constexpr uint32_t WINDOW_BUDGET_US = WINDOW_MS / 100 * DUTY_CYCLE_PERCENT * 1000;
+
+            void on_transmit(uint32_t now, uint32_t airtime_us)
+            {
+                if (now - window_start_ms_ >= WINDOW_MS)
+                {
+                    window_start_ms_ = now;
+                    window_used_us_ = 0;
+                }
+                window_used_us_ += airtime_us;
+                uint32_t off_ms = (airtime_us * (100 / DUTY_CYCLE_PERCENT - 1) + 999) / 1000;
+                next_allowed_ms_ = now + off_ms;
+                has_transmitted_ = true;
+            }
+
+            // Earliest time another frame may go out, never earlier than `now`
+            uint32_t next_allowed(uint32_t now) const
+            {
+                uint32_t allowed = now;
+                if (has_transmitted_ && static_cast<int32_t>(next_allowed_ms_ - allowed) > 0)
+                    allowed = next_allowed_ms_;
+                if (window_used_us_ + CONTROL_FRAME_AIRTIME_US > WINDOW_BUDGET_US && now - window_start_ms_ < WINDOW_MS)
+                    allowed = window_start_ms_ + WINDOW_MS;
+                return allowed;
+            }
+
+            uint32_t get_window_used_us() const { return window_used_us_; }
+
+        protected:
+            bool has_transmitted_ = false;
+            uint32_t next_allowed_ms_ = 0;
+            uint32_t window_start_ms_ = 0;
+            uint32_t window_used_us_ = 0;
+        };
+
+        enum CommandOutcome : uint8_t
+        {
+            COMMAND_NONE = 0,
+            COMMAND_PENDING,
+            COMMAND_CONFIRMED,
+            COMMAND_TIMED_OUT,
+        };
+
+        enum CommandAction : uint8_t
+        {
+            COMMAND_ACTION_NONE = 0,
+            COMMAND_ACTION_SEND,  // (re)transmit the boost frame
+            COMMAND_ACTION_PROBE, // ask for a status frame
+            COMMAND_ACTION_GIVE_UP,
+        };
+
+        // One boost start/cancel in flight. The command counts as confirmed once an
+        // iBoost frame received after it was sent shows the requested boost time; until
+        // then it is retransmitted with a jittered exponential backoff, bounded by
+        // MAX_ATTEMPTS and by the duty-cycle limiter.
+        class CommandTransaction
+        {
+        public:
+            static constexpr uint32_t CONFIRM_TIMEOUT_MS = 3000;
+            static constexpr uint32_t PROBE_DELAY_MS = 1000;    // status request if nothing was heard by then
+            static constexpr uint32_t RETRY_BACKOFF_MS = 1000;  // doubled for each further attempt
+            static constexpr uint32_t RETRY_JITTER_MS = 500;
+            static constexpr uint8_t MAX_ATTEMPTS = 4;
+
+            // A new command supersedes one still in flight
+            void start(uint8_t boost_minutes, uint32_t now)
+            {
+                target_minutes_ = boost_minutes;
+                outcome_ = COMMAND_PENDING;
+                attempts_ = 0;
+                awaiting_ = false;
+                due_ms_ = now;
+            }
+
+            bool is_active() const { return outcome_ == COMMAND_PENDING; }
+
+            void on_sent(uint32_t now)
+            {
+                if (attempts_ == 0)
+                    first_sent_ms_ = now;
+                attempts_++;
+                sent_ms_ = now;
+                awaiting_ = true;
+                probed_ = false;
+                due_ms_ = now + CONFIRM_TIMEOUT_MS;
+            }
+
+            void on_probe_sent() { probed_ = true; }
+
+            // Boost time from an iBoost frame received at `time_ms`; true if it confirmed the command.
+            // The remaining time may already have ticked down a minute when the frame is sent.
+            bool on_status(uint8_t boost_minutes, uint32_t time_ms)
+            {
+                if (!is_active() || attempts_ == 0 || static_cast<int32_t>(time_ms - sent_ms_) < 0)
+                    return false;
+                bool match = target_minutes_ == 0 ? boost_minutes == 0
+                                                  : boost_minutes <= target_minutes_ && boost_minutes + 1 >= target_minutes_;
+                if (!match)
+                    return false;
+                outcome_ = COMMAND_CONFIRMED;
+                latency_ms_ = time_ms - first_sent_ms_;
+                confirmed_++;
+                return true;
+            }
+
+            // What to do now; `limiter` holds back retransmissions the duty cycle does not allow yet
+            CommandAction poll(uint32_t now, const DutyCycleLimiter &limiter)
+            {
+                if (!is_active())
+                    return COMMAND_ACTION_NONE;
+                if (awaiting_ && !probed_ && now - sent_ms_ >= PROBE_DELAY_MS)
+                    return COMMAND_ACTION_PROBE;
+                if (static_cast<int32_t>(now - due_ms_) < 0)
+                    return COMMAND_ACTION_NONE;
+                if (awaiting_)
+                {
+                    // Confirmation window closed without a match
+                    awaiting_ = false;
+                    if (attempts_ >= MAX_ATTEMPTS)
+                    {
+                        outcome_ = COMMAND_TIMED_OUT;
+                        timed_out_++;
+                        return COMMAND_ACTION_GIVE_UP;
+                    }
+                    due_ms_ = now + (RETRY_BACKOFF_MS << (attempts_ - 1)) + next_jitter_();
+                    return COMMAND_ACTION_NONE;
+                }
+                uint32_t allowed = limiter.next_allowed(now);
+                if (allowed != now)
+                {
+                    due_ms_ = allowed;
+                    return COMMAND_ACTION_NONE;
+                }
+                return COMMAND_ACTION_SEND;
+            }
+
+            uint8_t get_target_minutes() const { return target_minutes_; }
+            CommandOutcome get_outcome() const { return outcome_; }
+            uint8_t get_attempts() const { return attempts_; }
+            uint32_t get_latency_ms() const { return latency_ms_; }
+            uint32_t get_confirmed() const { return confirmed_; }
+            uint32_t get_timed_out() const { return timed_out_; }
+
+        protected:
+            // xorshift32, as in RequestTracker
+            uint32_t next_jitter_()
+            {
+                jitter_state_ ^= jitter_state_ << 13;
+                jitter_state_ ^= jitter_state_ >> 17;
+                jitter_state_ ^= jitter_state_ << 5;
+                return jitter_state_ % RETRY_JITTER_MS;
+            }
+
+            CommandOutcome outcome_ = COMMAND_NONE;
+            uint8_t target_minutes_ = 0;
+            uint8_t attempts_ = 0;
+            bool awaiting_ = false; // inside a confirmation window
+            bool probed_ = false;
+            uint32_t first_sent_ms_ = 0;
+            uint32_t sent_ms_ = 0;
+            uint32_t due_ms_ = 0;   // end of the confirmation window, or next send while backing off
+            uint32_t latency_ms_ = 0;
+            uint32_t confirmed_ = 0;
+            uint32_t timed_out_ = 0;
+            uint32_t jitter_state_ = 0x7F4A7C15;
+        };
+
+    } // namespace esphiBoost
+} // namespace esphome
@@ -0,0 +1,66 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+namespace esphome
+{
+    namespace esphiBoost
+    {
+
+        // Remembers the last few frames by payload hash so repeats heard within a short
+        // window (the units resend, and both the Buddy and this receiver can be heard)
+        // are dropped before decoding. The window must stay well under the units'
+        // transmit period, or genuinely unchanged frames would be dropped too.
+        class DuplicateFilter
+        {
+        public:
+            static constexpr size_t SLOTS = 8;
+
+            void set_window(uint32_t ms) { window_ms_ = ms; }
+            uint32_t get_window() const { return window_ms_; }
+
+            // True if the same bytes were seen within the window; otherwise remembers them.
+            // Repeats are timed from the first copy, so a steady stream is not one long burst.
+            bool is_duplicate(const uint8_t *data, size_t length, uint32_t now)
+            {
+                if (window_ms_ == 0)
+                    return false;
+                uint32_t hash = hash_(data, length);
+                for (const auto &entry : entries_)
+                {
+                    if (entry.used && entry.hash == hash && now - entry.time_ms < window_ms_)
+                        return true;
+                }
+                Entry &entry = entries_[next_];
+                next_ = (next_ + 1) % SLOTS;
+                entry.used = true;
+                entry.hash = hash;
+                entry.time_ms = now;
+                return false;
+            }
+
+        protected:
+            // FNV-1a over the length and the payload
+            static uint32_t hash_(const uint8_t *data, size_t length)
+            {
+                uint32_t hash = 2166136261UL;
+                hash = (hash ^ static_cast<uint8_t>(length)) * 16777619UL;
+                for (size_t i = 0; i < length; i++)
+                    hash = (hash ^ data[i]) * 16777619UL;
+                return hash;
+            }
+
+            struct Entry
+            {
+                bool used = false;
+                uint32_t hash = 0;
+                uint32_t time_ms = 0;
+            };
+
+            Entry entries_[SLOTS];
+            size_t next_ = 0;
+            uint32_t window_ms_ = 1000;
+        };
+
+    } // namespace esphiBoost
+} // namespace esphome
@@ -0,0 +1,67 @@
+#pragma once
+#include <cstdint>
+
+namespace esphome
+{
+    namespace esphiBoost
+    {
+
+        // Estimates an energy counter between authoritative readings by integrating the
+        // instantaneous power carried in every iBoost frame (trapezoidal rule on frame
+        // receive times). Each real counter value re-anchors the estimate and discards
+        // the accumulated integral, so drift never outlives one poll interval. The counter
+        // restarts from zero at midnight: new_day() follows that when the local clock
+        // says so, and a reading below the anchor is taken as the iBoost's own rollover.
+        class EnergyIntegrator
+        {
+        public:
+            // Gaps longer than this (lost frames, unit out of range) are not integrated
+            static constexpr uint32_t MAX_GAP_MS = 60000;
+
+            void add_sample(float watts, uint32_t time_ms)
+            {
+                if (has_sample_)
+                {
+                    uint32_t elapsed = time_ms - last_time_ms_;
+                    if (elapsed <= MAX_GAP_MS)
+                        accumulated_wh_ += (watts + last_watts_) * 0.5f * elapsed / 3600000.0f;
+                }
+                has_sample_ = true;
+                last_watts_ = watts;
+                last_time_ms_ = time_ms;
+            }
+
+            // A real counter value arrived; returns how far the estimate was off (Wh), or 0
+            // when there was nothing to compare it with
+            float reconcile(float counter_wh)
+            {
+                float error = has_anchor_ && counter_wh >= anchor_wh_ ? estimate() - counter_wh : 0.0f;
+                anchor_wh_ = counter_wh;
+                accumulated_wh_ = 0.0f;
+                has_anchor_ = true;
+                return error;
+            }
+
+            // Midnight: the day's counter starts again from zero. The last sample is kept, so
+            // integration carries on from the frame before.
+            void new_day()
+            {
+                anchor_wh_ = 0.0f;
+                accumulated_wh_ = 0.0f;
+            }
+
+            // Only meaningful once a real counter value has been seen
+            bool has_estimate() const { return has_anchor_; }
+            float estimate() const { return anchor_wh_ + accumulated_wh_; }
+
+        protected:
+            bool has_sample_ = false;
+            bool has_anchor_ = false;
+            float last_watts_ = 0.0f;
+            uint32_t last_time_ms_ = 0;
+            float anchor_wh_ = 0.0f;
+            float accumulated_wh_ = 0.0f;
+        };
+
+    } // namespace esphiBoost
+} // namespace esphome
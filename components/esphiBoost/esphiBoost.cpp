@@ -1,5 +1,16 @@
 #include "esphiBoost.h"
 #include "esphome/core/log.h"
+#include "esphome/core/hal.h"
+#include "esphome/core/helpers.h"
+#include "esphome/components/sx126x/sx126x.h"
+#ifdef USE_WEBSERVER
+#include "esphome/components/web_server_base/web_server_base.h"
+#endif
+#ifdef USE_IBOOST_HISTORY
+#include <esp_partition.h>
+#endif
+#include <cstdio>
+#include <cstring>
 
 namespace esphome
 {
@@ -7,43 +18,178 @@ namespace esphome
     {
         static constexpr const char *TAG_IBOOST = "esphiBoost";
 
-        // Request and response codes for iBoost data queries
-        enum DataRequestCodes
+#ifdef USE_ESP32
+        // The decode task only copies and decodes; publishing stays in loop()
+        static const uint32_t DECODE_TASK_STACK_SIZE = 3072;
+        static const UBaseType_t DECODE_TASK_PRIORITY = 5;
+#endif
+
+        // Today polling bounds once the estimate covers the gaps between replies
+        static const uint32_t TODAY_ESTIMATED_MIN_INTERVAL_MS = 60000;
+        static const uint32_t TODAY_ESTIMATED_MAX_INTERVAL_MS = 600000;
+
+        // Hysteresis for following a different system than the current choice
+        static const float LINK_SWITCH_MARGIN_DB = 6.0f;
+        static const uint32_t LINK_SWITCH_MIN_FRAMES = 8;
+        static const uint32_t LINK_SWITCH_SILENCE_MS = 600000;
+
+#ifdef USE_WEBSERVER
+        // Every instance registers the same paths. A request naming an instance with ?id= goes
+        // to that one; without it, the first instance that serves the path answers.
+        static bool is_request_for(AsyncWebServerRequest *request, const char *path, const iBoostBuddy *parent)
+        {
+            if (request->method() != HTTP_GET || request->url() != path)
+                return false;
+            return !request->hasArg("id") || request->arg("id") == parent->get_instance_id();
+        }
+
+        // GET /iboost/capture returns the capture ring in the PacketCapture dump format
+        class CaptureHandler : public AsyncWebHandler
+        {
+        public:
+            explicit CaptureHandler(iBoostBuddy *parent) : parent_(parent) {}
+
+            bool canHandle(AsyncWebServerRequest *request) const override
+            {
+                return is_request_for(request, "/iboost/capture", parent_);
+            }
+
+            void handleRequest(AsyncWebServerRequest *request) override
+            {
+                std::vector<uint8_t> dump;
+                parent_->dump_capture(dump);
+                AsyncWebServerResponse *response = request->beginResponse(200, "application/octet-stream", dump.data(), dump.size());
+                response->addHeader("Content-Disposition", "attachment; filename=\"iboost.ibcp\"");
+                request->send(response);
+            }
+
+        protected:
+            iBoostBuddy *parent_;
+        };
+
+        // GET /iboost/rollups returns the minute and hour rollups as JSON
+        class RollupHandler : public AsyncWebHandler
+        {
+        public:
+            explicit RollupHandler(iBoostBuddy *parent) : parent_(parent) {}
+
+            bool canHandle(AsyncWebServerRequest *request) const override
+            {
+                return is_request_for(request, "/iboost/rollups", parent_);
+            }
+
+            void handleRequest(AsyncWebServerRequest *request) override
+            {
+                std::string json;
+                parent_->dump_rollups_json(json);
+                request->send(request->beginResponse(200, "application/json", reinterpret_cast<const uint8_t *>(json.data()), json.size()));
+            }
+
+        protected:
+            iBoostBuddy *parent_;
+        };
+
+#ifdef USE_IBOOST_HISTORY
+        // GET /iboost/history?sector=N returns one raw log sector; 404 past the last one
+        class HistoryHandler : public AsyncWebHandler
         {
-            DATA_REQUEST_TODAY = 0xCA,        // Request today's energy savings
-            DATA_REQUEST_YESTERDAY = 0xCB,    // Request yesterday's energy savings
-            DATA_REQUEST_LAST_7_DAYS = 0xCC,  // Request last 7 days energy savings
-            DATA_REQUEST_LAST_28_DAYS = 0xCD, // Request last 28 days energy savings
-            DATA_REQUEST_TOTAL = 0xCE         // Request total energy savings
+        public:
+            explicit HistoryHandler(iBoostBuddy *parent) : parent_(parent) {}
+
+            bool canHandle(AsyncWebServerRequest *request) const override
+            {
+                return is_request_for(request, "/iboost/history", parent_);
+            }
+
+            void handleRequest(AsyncWebServerRequest *request) override
+            {
+                std::vector<uint8_t> sector;
+                size_t index = request->hasArg("sector") ? strtoul(request->arg("sector").c_str(), nullptr, 10) : 0;
+                if (!parent_->read_history_sector(index, sector))
+                {
+                    request->send(404);
+                    return;
+                }
+                request->send(request->beginResponse(200, "application/octet-stream", sector.data(), sector.size()));
+            }
+
+        protected:
+            iBoostBuddy *parent_;
         };
+#endif
+#endif
 
-        // Packet type identifiers for different device types in the iBoost system
-        enum PacketTypes
+#ifdef USE_IBOOST_HISTORY
+        // History log backed by a data partition (history_partition, "iboost_log" by default)
+        class PartitionRegion : public FlashRegion
         {
-            PACKET_TYPE_SENDER = 0x01, // Sender unit packet (value: 1)
-            PACKET_TYPE_BUDDY = 0x21,  // Buddy unit packet (value: 33) - indicates buddy is running
-            PACKET_TYPE_IBOOST = 0x22  // iBoost main unit packet (value: 34)
+        public:
+            explicit PartitionRegion(const esp_partition_t *partition) : partition_(partition) {}
+
+            bool read(size_t offset, void *data, size_t length) override
+            {
+                return esp_partition_read(partition_, offset, data, length) == ESP_OK;
+            }
+            bool write(size_t offset, const void *data, size_t length) override
+            {
+                return esp_partition_write(partition_, offset, data, length) == ESP_OK;
+            }
+            bool erase_sector(size_t offset) override
+            {
+                return esp_partition_erase_range(partition_, offset, HISTORY_SECTOR_SIZE) == ESP_OK;
+            }
+            size_t size() const override { return partition_->size; }
+
+        protected:
+            const esp_partition_t *partition_;
         };
 
-        // Global state variables for iBoost system communication
-        bool is_system_address_valid_ = false;
-        int system_address_byte0_ = -1;
-        int system_address_byte1_ = -1;
-        float system_address_rssi_ = -1000.0f;
-        bool is_sender_battery_low_ = false;
-        bool iboost_unit_overheated = false;
-
-        // Data request cycle for polling different energy statistics
-        static const uint8_t DATA_REQUEST_CYCLE[] = {
-            DATA_REQUEST_TODAY,
-            DATA_REQUEST_YESTERDAY,
-            DATA_REQUEST_LAST_7_DAYS,
-            DATA_REQUEST_LAST_28_DAYS,
-            DATA_REQUEST_TOTAL};
-        static size_t data_request_cycle_index_ = 0; // Current index in the data request cycle
+        static const uint32_t HISTORY_LOG_INTERVAL_MS = 3600000; // one counters and one rollup record per hour
+#endif
+
+        static const char *const ROLLUP_METRIC_NAMES[ROLLUP_METRIC_COUNT] = {"power", "import", "rssi_iboost", "rssi_buddy", "rssi_sender"};
+
+        // Appends one rollup as "name":[[min,max,mean,count],...], newest first, null for empty periods
+        template <typename R>
+        static void append_rollup_json(std::string &out, const char *name, const R &rollup)
+        {
+            char buffer[64];
+            snprintf(buffer, sizeof(buffer), "\"%s\":[", name);
+            out += buffer;
+            for (size_t age = 0; age < R::SLOT_COUNT; age++)
+            {
+                const RollupBucket &bucket = rollup.get(age);
+                if (bucket.count == 0)
+                    snprintf(buffer, sizeof(buffer), "%snull", age == 0 ? "" : ",");
+                else
+                    snprintf(buffer, sizeof(buffer), "%s[%.1f,%.1f,%.1f,%u]", age == 0 ? "" : ",", bucket.min, bucket.max,
+                             bucket.mean(), (unsigned) bucket.count);
+                out += buffer;
+            }
+            out += "]";
+        }
+
+        static const char *data_request_name(uint8_t code)
+        {
+            switch (code)
+            {
+            case DATA_REQUEST_TODAY:
+                return "Saved Today";
+            case DATA_REQUEST_YESTERDAY:
+                return "Saved Yesterday";
+            case DATA_REQUEST_LAST_7_DAYS:
+                return "Saved Last 7 Days";
+            case DATA_REQUEST_LAST_28_DAYS:
+                return "Saved Last 28 Days";
+            case DATA_REQUEST_TOTAL:
+                return "Saved Total";
+            default:
+                return "";
+            }
+        }
 
         // private functions
-        void iBoostBuddy::send_packet_(const std::vector<uint8_t> &packet)
+        void iBoostBuddy::send_packet_(const uint8_t *data, size_t length)
         {
             if (!radio_)
             {
@@ -51,143 +197,323 @@ namespace esphome
                 return;
             }
 
-            ESP_LOGVV(TAG_IBOOST, "TX: Transmitting packet data: %s", format_hex_pretty(packet).c_str());
-            auto transmission_result = radio_->transmit_packet(packet);
+            ESP_LOGVV(TAG_IBOOST, "TX: Transmitting packet data: %s", format_hex_pretty(data, length).c_str());
+            // The driver only takes a vector; the frame itself is built on the stack
+#ifdef USE_IBOOST_RX_DUTY_CYCLE
+            // The reply is not on the units' schedule; listen until it can no longer count
+            if (rx_duty_cycle_)
+            {
+                rx_cycle_.hold_awake(millis(), CommandTransaction::CONFIRM_TIMEOUT_MS);
+                run_rx_duty_cycle_(millis());
+            }
+#endif
+            auto transmission_result = radio_->transmit_packet(std::vector<uint8_t>(data, data + length));
             ESP_LOGVV(TAG_IBOOST, "TX: Transmission result code: %d", static_cast<int>(transmission_result));
+            if (transmission_result != sx126x::SX126xError::NONE)
+            {
+                // Nothing went on air, so there is no airtime to charge
+                ESP_LOGW(TAG_IBOOST, "TX: Transmission failed (code %d)", static_cast<int>(transmission_result));
+                return;
+            }
+            duty_cycle_.on_transmit(millis(), frame_airtime_us(length));
         }
 
-        void iBoostBuddy::update_and_publish_packet_count_()
+        bool iBoostBuddy::publish_(sensor::Sensor *sensor, PublishSlot slot, float value, uint32_t now)
         {
-            // Use local static to maintain packet count without class-wide mutable state
-            static uint32_t total_packet_count = 0;
+            if (!sensor || !publish_filters_[slot].should_publish(value, now, publish_policies_[publish_class_of(slot)]))
+                return false;
+            sensor->publish_state(value);
+            return true;
+        }
 
-            // Increment and publish packet count if sensor is configured
-            if (packet_count_)
-            {
-                packet_count_->publish_state(++total_packet_count);
-            }
+        bool iBoostBuddy::publish_(text_sensor::TextSensor *sensor, PublishSlot slot, const char *value, uint32_t now)
+        {
+            if (!sensor || !publish_filters_[slot].should_publish(value, now, publish_policies_[publish_class_of(slot)]))
+                return false;
+            sensor->publish_state(value);
+            return true;
+        }
 
-            // Update timestamp of last received packet if both RTC and timestamp sensor are available
+        void iBoostBuddy::record_packet_()
+        {
+            // Counting is all that happens per frame; publish_packet_stats_() reports on its own cadence
+            total_packet_count_++;
+
+#ifdef USE_IBOOST_LAST_PACKET
             if (rtc_ && ts_last_packet_)
             {
                 auto current_time = rtc_->now();
                 if (current_time.is_valid())
                 {
-                    char timestamp_buffer[32];
-                    snprintf(timestamp_buffer, sizeof(timestamp_buffer),
-                             "%04d-%02d-%02dT%02d:%02d:%02dZ",
-                             current_time.year, current_time.month, current_time.day_of_month,
-                             current_time.hour, current_time.minute, current_time.second);
-                    ts_last_packet_->publish_state(timestamp_buffer);
+                    last_packet_time_ = current_time;
+                    last_packet_time_pending_ = true;
                 }
             }
+#endif
         }
 
-        uint8_t iBoostBuddy::get_next_data_request_code_()
+        void iBoostBuddy::add_link_sample_(LinkUnit unit, float rssi, uint32_t time_ms)
         {
-            // Get the next data request code from the cycle (0xCA through 0xCE)
-            uint8_t current_request_code = DATA_REQUEST_CYCLE[data_request_cycle_index_];
+            links_[unit].add(rssi, time_ms);
+#ifdef USE_IBOOST_RX_DUTY_CYCLE
+            if (rx_duty_cycle_)
+                rx_cycle_.on_frame(unit, time_ms);
+#endif
+            float *live[LINK_UNIT_COUNT] = {&live_state_.rssi_iboost, &live_state_.rssi_buddy, &live_state_.rssi_sender};
+            *live[unit] = links_[unit].get_rssi_average();
+        }
 
-            // Advance to next position in cycle, wrapping around at end
-            data_request_cycle_index_ = (data_request_cycle_index_ + 1) %
-                                        (sizeof(DATA_REQUEST_CYCLE) / sizeof(DATA_REQUEST_CYCLE[0]));
+        // Smoothed RSSI and estimated loss per unit, instead of a publish per frame
+        void iBoostBuddy::publish_link_quality_()
+        {
+            static const char *const UNIT_NAMES[LINK_UNIT_COUNT] = {"iBoost", "Buddy", "Sender"};
+#ifdef USE_IBOOST_RSSI_SENSORS
+            sensor::Sensor *rssi_sensors[LINK_UNIT_COUNT] = {rssi_iboost_, rssi_buddy_, rssi_sender_};
+            static const PublishSlot RSSI_SLOTS[LINK_UNIT_COUNT] = {PUBLISH_SLOT_RSSI_IBOOST, PUBLISH_SLOT_RSSI_BUDDY,
+                                                                   PUBLISH_SLOT_RSSI_SENDER};
+#endif
+#ifdef USE_IBOOST_DIAGNOSTICS
+            static const PublishSlot LOSS_SLOTS[LINK_UNIT_COUNT] = {PUBLISH_SLOT_LINK_LOSS_IBOOST, PUBLISH_SLOT_LINK_LOSS_BUDDY,
+                                                                   PUBLISH_SLOT_LINK_LOSS_SENDER};
+#endif
+            uint32_t now = millis();
+            for (size_t i = 0; i < LINK_UNIT_COUNT; i++)
+            {
+                LinkQuality &link = links_[i];
+                if (!link.has_samples())
+                    continue;
+                LinkWindow window = link.take_window(now);
+                ESP_LOGD(TAG_IBOOST, "Link %s: %.1f dB (%.0f..%.0f), every %.1f s +/- %.0f ms, %u heard, %u missed",
+                         UNIT_NAMES[i], link.get_rssi_average(), window.rssi_min, window.rssi_max,
+                         link.get_interval_ms() / 1000.0f, link.get_jitter_ms(), (unsigned) window.received,
+                         (unsigned) window.missed);
+#ifdef USE_IBOOST_RSSI_SENSORS
+                if (window.received > 0)
+                    publish_(rssi_sensors[i], RSSI_SLOTS[i], link.get_rssi_average(), now);
+#endif
+#ifdef USE_IBOOST_DIAGNOSTICS
+                // No loss figure until the period has been learnt
+                float loss = window.loss_percent();
+                if (link.is_settled() && !std::isnan(loss))
+                    publish_(link_loss_[i], LOSS_SLOTS[i], loss, now);
+#endif
+            }
+        }
 
-            return current_request_code;
+#ifdef USE_IBOOST_DIAGNOSTICS
+        void iBoostBuddy::publish_duplicate_stats_()
+        {
+            static const PublishSlot SLOTS[FRAME_KIND_OTHER] = {PUBLISH_SLOT_DUPLICATE_RATE_IBOOST, PUBLISH_SLOT_DUPLICATE_RATE_BUDDY,
+                                                                PUBLISH_SLOT_DUPLICATE_RATE_SENDER};
+            uint32_t now = millis();
+            for (size_t i = 0; i < FRAME_KIND_OTHER; i++)
+            {
+                uint32_t frames = rx_frames_[i].load(std::memory_order_relaxed);
+                if (frames > 0)
+                    publish_(duplicate_rate_[i], SLOTS[i], 100.0f * rx_duplicates_[i].load(std::memory_order_relaxed) / frames, now);
+            }
         }
+#endif
 
-        void iBoostBuddy::send_control_packet_(ControlPacketAction packet_mode, uint8_t boost_minutes)
+        void iBoostBuddy::publish_packet_stats_()
         {
-            if (!is_system_address_valid_)
+#ifdef USE_IBOOST_STATUS_SENSORS
+            if (packet_count_ && total_packet_count_ != published_packet_count_)
             {
-                ESP_LOGD(TAG_IBOOST, "TX: Cannot send control message - waiting for system address discovery...");
-                return;
+                packet_count_->publish_state(total_packet_count_);
+                published_packet_count_ = total_packet_count_;
             }
+#endif
 
-            // Determine descriptive message for logging based on packet mode
-            std::string mode_description = "Request Data";
-            if (packet_mode == CONTROL_PACKET_ACTION_BOOST_START)
+#ifdef USE_IBOOST_LAST_PACKET
+            // Update timestamp of last received packet if both RTC and timestamp sensor are available
+            if (ts_last_packet_ && last_packet_time_pending_)
             {
-                mode_description = "Start Boost";
+                char timestamp_buffer[32];
+                snprintf(timestamp_buffer, sizeof(timestamp_buffer),
+                         "%04d-%02d-%02dT%02d:%02d:%02dZ",
+                         last_packet_time_.year, last_packet_time_.month, last_packet_time_.day_of_month,
+                         last_packet_time_.hour, last_packet_time_.minute, last_packet_time_.second);
+                ts_last_packet_->publish_state(timestamp_buffer);
+                last_packet_time_pending_ = false;
             }
-            else if (packet_mode == CONTROL_PACKET_ACTION_BOOST_CANCEL)
+#endif
+
+#ifdef USE_IBOOST_DIAGNOSTICS
+            publish_request_stats_();
+            publish_duplicate_stats_();
+
+            // Peak backlog since the last report, so short bursts stay visible
+            if (rx_queue_depth_)
+                rx_queue_depth_->publish_state(rx_queue_peak_);
+            rx_queue_peak_ = rx_queue_.size();
+
+            float drops = rx_dropped_ + event_dropped_.load(std::memory_order_relaxed);
+            if (rx_queue_drops_ && drops != published_queue_drops_)
             {
-                mode_description = "Cancel Boost";
+                rx_queue_drops_->publish_state(drops);
+                published_queue_drops_ = drops;
             }
 
-            std::vector<uint8_t> control_packet(29, 0);
-            control_packet[0] = static_cast<uint8_t>(system_address_byte0_);
-            control_packet[1] = static_cast<uint8_t>(system_address_byte1_);
-            control_packet[2] = PACKET_TYPE_BUDDY; // Buddy packet type
+            if (publish_suppressed_)
+            {
+                uint32_t suppressed = 0;
+                for (const auto &filter : publish_filters_)
+                    suppressed += filter.get_suppressed();
+                if (suppressed != published_suppressed_)
+                {
+                    publish_suppressed_->publish_state(suppressed);
+                    published_suppressed_ = suppressed;
+                }
+            }
+#endif
+        }
 
-            if (packet_mode == CONTROL_PACKET_ACTION_REQUEST_DATA)
+#ifdef USE_IBOOST_DIAGNOSTICS
+        void iBoostBuddy::publish_request_stats_()
+        {
+            const LatencyHistogram &latency = tracker_.get_latency();
+            uint32_t now = millis();
+            if (latency.get_count() > 0)
             {
-                control_packet[3] = 0x08; // Request group data command
+                publish_(latency_p50_, PUBLISH_SLOT_LATENCY_P50, latency.percentile(50), now);
+                publish_(latency_p95_, PUBLISH_SLOT_LATENCY_P95, latency.percentile(95), now);
+                publish_(latency_p99_, PUBLISH_SLOT_LATENCY_P99, latency.percentile(99), now);
             }
-            else
+            if (tracker_.get_answered() + tracker_.get_lost() > 0)
+                publish_(request_loss_rate_, PUBLISH_SLOT_LOSS_RATE, tracker_.get_loss_rate(), now);
+        }
+#endif
+
+        bool iBoostBuddy::send_control_packet_(ControlPacketAction packet_mode, uint8_t boost_minutes, uint8_t request_code)
+        {
+            if (system_ == nullptr)
             {
-                control_packet[3] = 0x18; // Set boost time command
+                ESP_LOGD(TAG_IBOOST, "TX: Cannot send control message - waiting for system address discovery...");
+                return false;
             }
 
-            // Set fixed protocol bytes
-            control_packet[4] = 0x92;
-            control_packet[5] = 0x07;
-            control_packet[8] = 0x24;
-            control_packet[10] = 0xA0;
-            control_packet[11] = 0xA0;
-            control_packet[12] = get_next_data_request_code_(); // Cycle through data request codes
-            control_packet[14] = 0xA0;
-            control_packet[15] = 0xA0;
-            control_packet[16] = 0xC8;
-            std::string request_display_name = "";
-            if (packet_mode != CONTROL_PACKET_ACTION_REQUEST_DATA)
+            // Determine descriptive message for logging based on packet mode
+            const char *mode_description = "Request Data";
+            const char *request_display_name = "";
+            BuddyControlFrame control;
+            control.address0 = static_cast<uint8_t>(system_->address >> 8);
+            control.address1 = static_cast<uint8_t>(system_->address & 0xFF);
+            control.request_code = request_code; // Energy counter the reply should carry
+            control.boost_minutes = 0;
+            if (packet_mode == CONTROL_PACKET_ACTION_REQUEST_DATA)
             {
-                if (packet_mode == CONTROL_PACKET_ACTION_BOOST_CANCEL)
-                {
-                    control_packet[17] = 0; // Cancel boost - set minutes to 0
-                }
-                else
-                {
-                    control_packet[17] = boost_minutes; // Set boost duration in minutes
-                }
+                control.command = BUDDY_COMMAND_REQUEST_DATA;
+                request_display_name = data_request_name(request_code);
             }
             else
             {
-                // Log the specific data request being sent
-                switch (control_packet[12])
+                control.command = BUDDY_COMMAND_SET_BOOST;
+                if (packet_mode == CONTROL_PACKET_ACTION_BOOST_START)
                 {
-                case DATA_REQUEST_TODAY:
-                    request_display_name = "Saved Today";
-                    break;
-                case DATA_REQUEST_YESTERDAY:
-                    request_display_name = "Saved Yesterday";
-                    break;
-                case DATA_REQUEST_LAST_7_DAYS:
-                    request_display_name = "SavedLast 7 Days";
-                    break;
-                case DATA_REQUEST_LAST_28_DAYS:
-                    request_display_name = "SavedLast 28 Days";
-                    break;
-                case DATA_REQUEST_TOTAL:
-                    request_display_name = "Saved Total";
-                    break;
+                    mode_description = "Start Boost";
+                    control.boost_minutes = boost_minutes;
+                }
+                else
+                {
+                    mode_description = "Cancel Boost"; // boost time 0 cancels
                 }
             }
-            send_packet_(control_packet);
-            ESP_LOGD(TAG_IBOOST, "TX: Sent control packet [%s][%s]", mode_description.c_str(), request_display_name.c_str());
+
+            BuddyControlBuffer control_packet;
+            encode_control_frame(control, control_packet);
+            send_packet_(control_packet.data(), control_packet.size());
+            ESP_LOGD(TAG_IBOOST, "TX: Sent control packet [%s][%s]", mode_description, request_display_name);
+            return true;
         }
 
         void iBoostBuddy::boost_start(uint8_t minutes)
         {
-            send_control_packet_(CONTROL_PACKET_ACTION_BOOST_START, minutes);
+            start_command_(minutes);
         }
 
         void iBoostBuddy::boost_cancel()
         {
-            send_control_packet_(CONTROL_PACKET_ACTION_BOOST_CANCEL, 0);
+            start_command_(0); // boost time 0 cancels
+        }
+
+        void iBoostBuddy::start_command_(uint8_t boost_minutes)
+        {
+            if (system_ == nullptr)
+            {
+                ESP_LOGD(TAG_IBOOST, "TX: Cannot send boost command - waiting for system address discovery...");
+                publish_command_status_("No system address");
+                return;
+            }
+            if (command_.is_active())
+                ESP_LOGD(TAG_IBOOST, "TX: Boost command for %u min superseded", command_.get_target_minutes());
+            command_.start(boost_minutes, millis());
+            publish_command_status_("Sending");
+            run_command_(millis());
+        }
+
+        // Drives the boost command in flight: first send, status probe, retries, giving up
+        void iBoostBuddy::run_command_(uint32_t now)
+        {
+            switch (command_.poll(now, duty_cycle_))
+            {
+            case COMMAND_ACTION_SEND:
+            {
+                uint8_t minutes = command_.get_target_minutes();
+                if (!send_control_packet_(minutes > 0 ? CONTROL_PACKET_ACTION_BOOST_START : CONTROL_PACKET_ACTION_BOOST_CANCEL,
+                                          minutes, DATA_REQUEST_TODAY))
+                    return;
+                command_.on_sent(now);
+                if (command_.get_attempts() > 1)
+                    ESP_LOGD(TAG_IBOOST, "TX: Boost command not confirmed yet, attempt %u", command_.get_attempts());
+                break;
+            }
+            case COMMAND_ACTION_PROBE:
+                command_.on_probe_sent();
+                send_data_request_(DATA_REQUEST_TODAY, now);
+                break;
+            case COMMAND_ACTION_GIVE_UP:
+                ESP_LOGW(TAG_IBOOST, "TX: Boost command for %u min not confirmed after %u attempts",
+                         command_.get_target_minutes(), command_.get_attempts());
+                publish_command_status_("Timed out");
+                break;
+            case COMMAND_ACTION_NONE:
+                break;
+            }
+        }
+
+        void iBoostBuddy::publish_command_status_(const char *status)
+        {
+#ifdef USE_IBOOST_STATUS_SENSORS
+            if (boost_command_status_)
+                boost_command_status_->publish_state(status);
+#endif
         }
 
+#ifdef USE_IBOOST_DIAGNOSTICS
+        void iBoostBuddy::publish_schedule_status_()
+        {
+            const char *status;
+            switch (scheduler_.get_last_decision())
+            {
+            case SCHEDULE_DUE:
+                status = "Polling";
+                break;
+            case SCHEDULE_PROBE:
+            case SCHEDULE_SUSPENDED:
+                status = "Suspended: no iBoost reply";
+                break;
+            default:
+                status = "Idle: data fresh";
+                break;
+            }
+            publish_(scheduler_status_, PUBLISH_SLOT_SCHEDULER_STATUS, status, millis());
+        }
+#endif
+
         void iBoostBuddy::setup()
         {
+#ifdef USE_IBOOST_STATUS_SENSORS
             if (heating_mode_ != nullptr)
             {
                 heating_mode_->publish_state("Initializing...");
@@ -197,32 +523,84 @@ namespace esphome
                 heating_warn_->publish_state("No Warnings");
             }
 
-            // Initialize numeric sensors
+            // Instantaneous values start at zero. Energy counters are only published once
+            // known, restored or received, so Home Assistant never sees a drop to zero.
             if (heating_import_)
                 heating_import_->publish_state(0);
 
             if (heating_power_)
                 heating_power_->publish_state(0);
 
-            if (heating_today_)
-                heating_today_->publish_state(0);
+            if (heating_boost_time_)
+                heating_boost_time_->publish_state(0);
+#endif
+
+            setup_ms_ = millis();
+            if (restore_hash_ != 0)
+            {
+                pref_ = global_preferences->make_preference<iBoostSavedState>(restore_hash_);
+                restore_state_();
+                this->set_interval("save_state", save_interval_ms_, [this]() { this->save_state_(); });
+            }
 
-            if (heating_yesterday_)
-                heating_yesterday_->publish_state(0);
+            ESP_LOGI(TAG_IBOOST, "iBoostBuddy setup (native SX126x) starting");
 
-            if (heating_last_7_)
-                heating_last_7_->publish_state(0);
+            // Packet count and last-packet time are coalesced rather than published per frame
+            this->set_interval("packet_stats", stats_interval_ms_, [this]() { this->publish_packet_stats_(); });
+            this->set_interval("link_quality", link_quality_interval_ms_, [this]() { this->publish_link_quality_(); });
 
-            if (heating_last_28_)
-                heating_last_28_->publish_state(0);
+#ifdef USE_ESP32
+            // Decode on whichever core loop() is not running on
+            BaseType_t core = portNUM_PROCESSORS > 1 ? 1 - xPortGetCoreID() : tskNO_AFFINITY;
+            if (xTaskCreatePinnedToCore(decode_task_, "iboost_rx", DECODE_TASK_STACK_SIZE, this, DECODE_TASK_PRIORITY,
+                                        &decode_task_handle_, core) == pdPASS)
+            {
+                decode_in_loop_ = false;
+            }
+            else
+            {
+                decode_task_handle_ = nullptr;
+                ESP_LOGW(TAG_IBOOST, "Could not start the RX decode task; decoding in loop()");
+            }
+#endif
 
-            if (heating_last_gt_)
-                heating_last_gt_->publish_state(0);
+#ifdef USE_WEBSERVER
+            if (web_server_base::global_web_server_base != nullptr)
+            {
+                if (capture_.get_size() > 0)
+                    web_server_base::global_web_server_base->add_handler(new CaptureHandler(this));
+                web_server_base::global_web_server_base->add_handler(new RollupHandler(this));
+#ifdef USE_IBOOST_HISTORY
+                if (history_partition_ != nullptr)
+                    web_server_base::global_web_server_base->add_handler(new HistoryHandler(this));
+#endif
+            }
+#endif
 
-            if (heating_boost_time_)
-                heating_boost_time_->publish_state(0);
+#ifdef USE_IBOOST_HISTORY
+            if (history_partition_ != nullptr)
+            {
+                const esp_partition_t *partition =
+                    esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, history_partition_);
+                if (partition == nullptr)
+                {
+                    ESP_LOGW(TAG_IBOOST, "history_log is enabled but the partition table has no %s partition", history_partition_);
+                }
+                else
+                {
+                    history_flash_ = new PartitionRegion(partition);
+                    if (history_.begin(history_flash_))
+                        this->set_interval("history", HISTORY_LOG_INTERVAL_MS, [this]() { this->log_history_(); });
+                    else
+                        ESP_LOGW(TAG_IBOOST, "Could not open the history log");
+                }
+            }
+#endif
 
-            ESP_LOGI(TAG_IBOOST, "iBoostBuddy setup (native SX126x) starting");
+#ifdef USE_IBOOST_ROLLUP_SENSORS
+            if (rollup_power_ || rollup_import_)
+                this->set_interval("rollups", Rollup<60, 60000>::PERIOD, [this]() { this->publish_rollups_(); });
+#endif
 
             if (!radio_)
             {
@@ -234,259 +612,836 @@ namespace esphome
             }
         }
 
-        void iBoostBuddy::loop()
+#ifdef USE_IBOOST_ENERGY_SENSORS
+        void iBoostBuddy::set_heating_today_estimate(sensor::Sensor *s)
         {
-            // No manual polling - receiving handled via on_packet lambda calling process_packet().
+            heating_today_estimate_ = s;
+            scheduler_.set_interval_bounds(DATA_REQUEST_TODAY, TODAY_ESTIMATED_MIN_INTERVAL_MS, TODAY_ESTIMATED_MAX_INTERVAL_MS);
         }
+#endif
 
-        void iBoostBuddy::update()
+        float *iBoostBuddy::counter_(uint8_t code)
         {
-            // Update is Called every 10 seconds by polling component
-            send_control_packet_(CONTROL_PACKET_ACTION_REQUEST_DATA, 0);
+            switch (code)
+            {
+            case DATA_REQUEST_TODAY:
+                return &live_state_.today;
+            case DATA_REQUEST_YESTERDAY:
+                return &live_state_.yesterday;
+            case DATA_REQUEST_LAST_7_DAYS:
+                return &live_state_.last_7;
+            case DATA_REQUEST_LAST_28_DAYS:
+                return &live_state_.last_28;
+            case DATA_REQUEST_TOTAL:
+                return &live_state_.total;
+            default:
+                return nullptr;
+            }
         }
 
-        void iBoostBuddy::dump_config()
+        void iBoostBuddy::restore_state_()
         {
-            ESP_LOGCONFIG(TAG_IBOOST, "iBoostBuddy - Configuration Dump");
+            if (!pref_.load(&saved_) || saved_.version != SAVED_STATE_VERSION)
+            {
+                saved_ = iBoostSavedState{};
+                saved_.version = SAVED_STATE_VERSION;
+                ESP_LOGD(TAG_IBOOST, "No saved state; starting cold");
+                return;
+            }
+
+            // A configured address always wins over a remembered one
+            if (saved_.has_address && !system_address_fixed_)
+            {
+                system_ = systems_.find_or_insert(saved_.address);
+                system_->best_rssi = saved_.rssi;
+                system_->rssi_average = saved_.rssi;
+                ESP_LOGI(TAG_IBOOST, "Restored system address %04X (RSSI=%.1f); polling can start straight away",
+                         saved_.address, saved_.rssi);
+            }
+
+#ifdef USE_IBOOST_ENERGY_SENSORS
+            static const PublishSlot COUNTER_SLOTS[RequestScheduler::CODE_COUNT] = {
+                PUBLISH_SLOT_HEATING_TODAY, PUBLISH_SLOT_HEATING_YESTERDAY, PUBLISH_SLOT_HEATING_LAST_7,
+                PUBLISH_SLOT_HEATING_LAST_28, PUBLISH_SLOT_HEATING_TOTAL};
+            sensor::Sensor *const counter_sensors[RequestScheduler::CODE_COUNT] = {
+                heating_today_, heating_yesterday_, heating_last_7_, heating_last_28_, heating_last_gt_};
+            uint32_t now = millis();
+#endif
+            for (size_t i = 0; i < RequestScheduler::CODE_COUNT; i++)
+            {
+                if (!(saved_.counters_valid & (1 << i)))
+                    continue;
+                *counter_(DATA_REQUEST_TODAY + i) = saved_.counters[i];
+#ifdef USE_IBOOST_ENERGY_SENSORS
+                publish_(counter_sensors[i], COUNTER_SLOTS[i], saved_.counters[i], now);
+#endif
+            }
+            restored_ = true;
         }
 
-        void iBoostBuddy::handle_packet_iboost_(const std::vector<uint8_t> &buffer, float rssi)
+        // Runs every save_interval and at shutdown; writes only if something worth keeping changed
+        void iBoostBuddy::save_state_()
         {
-            if (buffer.size() < 28)
+            iBoostSavedState state{};
+            state.version = SAVED_STATE_VERSION;
+            state.has_address = system_ != nullptr;
+            state.address = system_ != nullptr ? system_->address : 0;
+            state.rssi = system_ != nullptr ? system_->best_rssi : saved_.rssi;
+            for (size_t i = 0; i < RequestScheduler::CODE_COUNT; i++)
             {
-                return; // Packet too short for iBoost data
+                float value = *counter_(DATA_REQUEST_TODAY + i);
+                if (std::isnan(value))
+                    continue;
+                state.counters[i] = value;
+                state.counters_valid |= 1 << i;
             }
-            // Publish last iBoost RSSI if sensor configured
-            if (rssi_iboost_)
-                rssi_iboost_->publish_state(rssi);
 
-            // Capture system address from first valid iBoost packet - Unlikely but possible
-            if (!is_system_address_valid_)
+            // RSSI alone is not worth a flash write
+            bool changed = state.has_address != saved_.has_address || state.address != saved_.address ||
+                           state.counters_valid != saved_.counters_valid ||
+                           memcmp(state.counters, saved_.counters, sizeof(state.counters)) != 0;
+            if (!changed)
+                return;
+            if (pref_.save(&state))
+            {
+                saved_ = state;
+                ESP_LOGD(TAG_IBOOST, "Saved state for warm start");
+            }
+        }
+
+        void iBoostBuddy::on_safe_shutdown()
+        {
+            if (restore_hash_ != 0)
+                save_state_();
+#ifdef USE_IBOOST_HISTORY
+            history_.flush();
+#endif
+        }
+
+#ifdef USE_IBOOST_HISTORY
+        // Appends the current counters and the last complete hour's rollup
+        void iBoostBuddy::log_history_()
+        {
+            HistoryRecord record{};
+            record.address = system_ != nullptr ? system_->address : 0;
+            if (rtc_ != nullptr)
             {
-                system_address_byte0_ = buffer[0];
-                system_address_byte1_ = buffer[1];
-                is_system_address_valid_ = true;
-                system_address_rssi_ = rssi;
-                ESP_LOGI(TAG_IBOOST, "System address captured from iBoost: %02X%02X (RSSI=%.1f)", buffer[0], buffer[1], rssi);
+                ESPTime time = rtc_->now();
+                if (time.is_valid())
+                    record.time = time.timestamp;
             }
 
-            // Validate packet belongs to our system
-            if (is_system_address_valid_ &&
-                (static_cast<uint8_t>(system_address_byte0_) != buffer[0] ||
-                 static_cast<uint8_t>(system_address_byte1_) != buffer[1]))
+            int32_t counters[RequestScheduler::CODE_COUNT];
+            bool any_counter = false;
+            for (size_t i = 0; i < RequestScheduler::CODE_COUNT; i++)
             {
-                ESP_LOGW(TAG_IBOOST, "Received packet from different iBoost system - ignoring");
+                float value = *counter_(DATA_REQUEST_TODAY + i);
+                counters[i] = std::isnan(value) ? INT32_MIN : static_cast<int32_t>(value);
+                any_counter |= !std::isnan(value);
+            }
+            if (any_counter)
+            {
+                record.type = HISTORY_RECORD_COUNTERS;
+                memcpy(record.payload, counters, sizeof(counters));
+                history_.append(record);
+            }
+
+            uint32_t now = millis();
+            LockGuard lock(rollup_lock_);
+            const RollupMetric metrics[] = {ROLLUP_POWER, ROLLUP_IMPORT};
+            int16_t values[7] = {};
+            uint16_t samples = 0;
+            for (size_t i = 0; i < 2; i++)
+            {
+                rollups_.hours[metrics[i]].advance(now);
+                const RollupBucket &bucket = rollups_.hours[metrics[i]].get(1);
+                values[i * 3] = static_cast<int16_t>(bucket.min);
+                values[i * 3 + 1] = static_cast<int16_t>(bucket.max);
+                values[i * 3 + 2] = static_cast<int16_t>(bucket.mean());
+                if (metrics[i] == ROLLUP_POWER)
+                    samples = bucket.count;
+            }
+            rollups_.hours[ROLLUP_RSSI_IBOOST].advance(now);
+            values[6] = static_cast<int16_t>(rollups_.hours[ROLLUP_RSSI_IBOOST].get(1).mean() * 10.0f);
+            if (samples == 0)
+                return;
+            record.type = HISTORY_RECORD_ROLLUP;
+            memset(record.payload, 0, sizeof(record.payload));
+            memcpy(record.payload, values, sizeof(values));
+            memcpy(record.payload + sizeof(values), &samples, sizeof(samples));
+            history_.append(record);
+        }
+
+        bool iBoostBuddy::read_history_sector(size_t sector, std::vector<uint8_t> &out)
+        {
+            if (sector >= get_history_sector_count())
+                return false;
+            out.resize(HISTORY_SECTOR_SIZE);
+            return history_flash_->read(sector * HISTORY_SECTOR_SIZE, out.data(), out.size());
+        }
+#endif
+
+#ifdef USE_IBOOST_RX_DUTY_CYCLE
+        // Only mode changes reach the radio; loop() runs far more often than they happen
+        void iBoostBuddy::run_rx_duty_cycle_(uint32_t now)
+        {
+            if (!rx_duty_cycle_ || !radio_)
+                return;
+            bool listen = rx_cycle_.wants_rx(now);
+            if (listen == radio_listening_)
                 return;
+            radio_listening_ = listen;
+            if (listen)
+                radio_->set_mode_rx();
+            else
+                radio_->set_mode_sleep();
+            ESP_LOGVV(TAG_IBOOST, "RX: radio %s", listen ? "listening" : "asleep");
+        }
+#endif
+
+        void iBoostBuddy::loop()
+        {
+            // process_packet() only queues frames; decoded frames are applied here in one batch,
+            // then data requests that have gone unanswered are chased
+            uint32_t start_us = micros();
+            if (decode_in_loop_)
+            {
+                RawFrame raw;
+                while (rx_queue_.pop(raw))
+                    decode_raw_(raw);
+            }
+            RxEvent event;
+            while (event_queue_.pop(event))
+                handle_event_(event);
+            drain_event_log_();
+
+            uint32_t now = millis();
+            uint8_t lost_code;
+            uint8_t retry_code = tracker_.poll(now, lost_code);
+            if (lost_code != 0)
+            {
+                scheduler_.on_request_lost(lost_code);
+                ESP_LOGD(TAG_IBOOST, "TX: No reply to [%s] after %u attempts", data_request_name(lost_code),
+                         (unsigned) RequestTracker::MAX_ATTEMPTS);
+            }
+            run_command_(now);
+            // Retries wait while a boost command has the channel
+            if (retry_code != 0 && !command_.is_active())
+            {
+                ESP_LOGD(TAG_IBOOST, "TX: Retrying [%s]", data_request_name(retry_code));
+                send_data_request_(retry_code, now);
             }
+#ifdef USE_IBOOST_RX_DUTY_CYCLE
+            run_rx_duty_cycle_(now);
+#endif
+            record_blocking_(BLOCKING_LOOP, start_us);
+        }
 
-            short PowerSentToTank = (*(short *)&buffer[16]);
-            long current_import_raw = (*reinterpret_cast<const long *>(&buffer[18]));
-            long energy_data_value = (*reinterpret_cast<const long *>(&buffer[25])); // This depends on the request
-            uint8_t data_received_mode_id = buffer[24];
-            uint8_t boost_time = buffer[5]; // boost time remaining
-            bool water_heating = (buffer[6] == 0);
-            bool cylinder_hot = (buffer[7] != 0);
-            iboost_unit_overheated = (buffer[13] != 0);
+        void iBoostBuddy::update()
+        {
+            // Called every update_interval; the scheduler decides whether anything is worth transmitting
+            uint32_t start_us = micros();
+            uint32_t now = millis();
+            if (command_.is_active())
+            {
+                ESP_LOGV(TAG_IBOOST, "Schedule: paused while a boost command is in flight");
+                record_blocking_(BLOCKING_UPDATE, start_us);
+                return;
+            }
+            uint8_t request_code = scheduler_.next_request(now);
+#ifdef USE_IBOOST_DIAGNOSTICS
+            publish_schedule_status_();
+#endif
 
-            if (heating_mode_) // if linked to a sensor in esphome..
+            ScheduleDecision decision = scheduler_.get_last_decision();
+            if (request_code == 0)
             {
-                if (cylinder_hot)
-                {
-                    heating_mode_->publish_state("OFF: Water Tank Hot");
-                    ESP_LOGD(TAG_IBOOST, "Heat: Water Tank Hot");
-                }
-                else if (iboost_unit_overheated)
-                {
-                    heating_mode_->publish_state("Failed: Overheat");
-                    ESP_LOGD(TAG_IBOOST, "Heat: Failed: Overheat");
-                }
-                else if (boost_time > 0)
-                {
-                    heating_mode_->publish_state("ON: Heating from Manual Boost");
-                    ESP_LOGD(TAG_IBOOST, "Heat: Heating from Manual Boost");
-                }
-                else if (water_heating)
-                {
-                    heating_mode_->publish_state("ON: Heating from Solar");
-                    ESP_LOGD(TAG_IBOOST, "Heat: Heating from Solar");
-                }
+                if (decision == SCHEDULE_SUSPENDED)
+                    ESP_LOGV(TAG_IBOOST, "Schedule: suspended, no iBoost reply for %u s", (unsigned) (scheduler_.get_silence_ms(now) / 1000));
                 else
-                {
-                    heating_mode_->publish_state("OFF: Water Heating Off");
-                    ESP_LOGD(TAG_IBOOST, "Heat: Water Heating Off");
-                }
+                    ESP_LOGV(TAG_IBOOST, "Schedule: idle, all counters fresh");
             }
-            if (heating_warn_) // if linked to a sensor in esphome
+            else
             {
-                std::string warning_display;
+                ESP_LOGD(TAG_IBOOST, "Schedule: %s [%s]", decision == SCHEDULE_PROBE ? "probe" : "due",
+                         data_request_name(request_code));
+                send_data_request_(request_code, now);
+            }
+            record_blocking_(BLOCKING_UPDATE, start_us);
+        }
 
-                if (iboost_unit_overheated)
-                {
-                    warning_display += "iBoost Overheating";
-                }
+        void iBoostBuddy::record_blocking_(BlockingSection section, uint32_t start_us)
+        {
+            [[maybe_unused]] static const char *const SECTION_NAMES[BLOCKING_SECTION_COUNT] = {"RX", "loop", "update"};
+            uint32_t elapsed = micros() - start_us;
+            if (elapsed > worst_blocking_us_[section])
+            {
+                worst_blocking_us_[section] = elapsed;
+                ESP_LOGV(TAG_IBOOST, "New worst %s block: %u us", SECTION_NAMES[section], (unsigned) elapsed);
+            }
+        }
 
-                if (is_sender_battery_low_)
-                {
-                    if (!warning_display.empty())
-                    {
-                        warning_display += " | ";
-                    }
-                    warning_display += "Sender Battery Low";
-                }
+        void iBoostBuddy::send_data_request_(uint8_t request_code, uint32_t now)
+        {
+            if (!send_control_packet_(CONTROL_PACKET_ACTION_REQUEST_DATA, 0, request_code))
+            {
+                // No address yet; let the tracker time the attempt out rather than spin on it
+                if (tracker_.is_in_flight(request_code))
+                    tracker_.on_sent(request_code, now);
+                return;
+            }
+            scheduler_.on_request_sent(request_code, now);
+            tracker_.on_sent(request_code, now);
+        }
 
-                if (!warning_display.empty())
-                {
-                    heating_warn_->publish_state(warning_display);
-                    ESP_LOGW(TAG_IBOOST, "Status Warning: %s", warning_display.c_str());
-                }
-                else
-                {
-                    heating_warn_->publish_state("");
-                }
+        void iBoostBuddy::dump_config()
+        {
+            ESP_LOGCONFIG(TAG_IBOOST, "iBoostBuddy - Configuration Dump");
+            ESP_LOGCONFIG(TAG_IBOOST, "  Instance id: %s", instance_id_);
+            static const char *const CLASS_NAMES[PUBLISH_CLASS_COUNT] = {"power", "energy", "signal", "percent", "duration", "text"};
+            for (size_t i = 0; i < PUBLISH_CLASS_COUNT; i++)
+            {
+                const PublishPolicy &policy = publish_policies_[i];
+                ESP_LOGCONFIG(TAG_IBOOST, "  Publish %s: deadband %.2f, min/max interval %u ms / %u ms", CLASS_NAMES[i],
+                              policy.deadband, (unsigned) policy.min_interval_ms, (unsigned) policy.max_interval_ms);
             }
-            if (heating_power_)
+            ESP_LOGCONFIG(TAG_IBOOST, "  Packet stats interval: %u ms", (unsigned) stats_interval_ms_);
+            ESP_LOGCONFIG(TAG_IBOOST, "  Link quality interval: %u ms", (unsigned) link_quality_interval_ms_);
+            if (system_address_fixed_)
+                ESP_LOGCONFIG(TAG_IBOOST, "  System address: %04X", system_->address);
+            else
+                ESP_LOGCONFIG(TAG_IBOOST, "  System address: discovered");
+            const SystemState *systems = systems_.get_entries();
+            for (size_t i = 0; i < SystemTable::CAPACITY; i++)
             {
-                heating_power_->publish_state(PowerSentToTank); // Current power sent to heater
-                ESP_LOGV(TAG_IBOOST, "Current Heat Power: %d W", PowerSentToTank);
+                if (!systems[i].used)
+                    continue;
+                ESP_LOGCONFIG(TAG_IBOOST, "  Heard %04X%s: %u frames, RSSI %.1f average, %.1f best", systems[i].address,
+                              &systems[i] == system_ ? " (this system)" : "", (unsigned) systems[i].frames,
+                              systems[i].rssi_average, systems[i].best_rssi);
             }
-            if (heating_import_)
+            ESP_LOGCONFIG(TAG_IBOOST, "  Sender import: %s (%u implausible, %u mismatched)",
+                          sender_import_check_.is_trusted() ? "cross-checked" : "not confirmed",
+                          (unsigned) sender_import_check_.get_implausible(), (unsigned) sender_import_check_.get_mismatches());
+            if (untracked_frames_ > 0)
+                ESP_LOGCONFIG(TAG_IBOOST, "  Frames from systems beyond the table: %u", (unsigned) untracked_frames_);
+            if (restore_hash_ != 0)
+                ESP_LOGCONFIG(TAG_IBOOST, "  Warm start: %s, saved at most every %u s", restored_ ? "restored" : "nothing saved yet",
+                              (unsigned) (save_interval_ms_ / 1000));
+#ifdef USE_IBOOST_HISTORY
+            if (history_partition_ != nullptr)
+                ESP_LOGCONFIG(TAG_IBOOST, "  History log: %s %s, %u sectors, %u records in %u writes, %u erases, %u pending, %u dropped",
+                              history_partition_, history_.is_ready() ? "open" : "unavailable", (unsigned) history_.get_sector_count(),
+                              (unsigned) history_.get_records(), (unsigned) history_.get_writes(),
+                              (unsigned) history_.get_erases(), (unsigned) history_.get_pending(),
+                              (unsigned) history_.get_dropped());
+#endif
+#ifdef USE_IBOOST_RX_DUTY_CYCLE
+            uint32_t awake_ms = rx_cycle_.get_listen_ms();
+            uint32_t total_ms = awake_ms + rx_cycle_.get_sleep_ms();
+            if (rx_duty_cycle_)
+                ESP_LOGCONFIG(TAG_IBOOST, "  RX duty cycle: %s, listening %.1f%% of the time", radio_ ? "on" : "no radio",
+                              total_ms > 0 ? 100.0f * awake_ms / total_ms : 100.0f);
+            for (int i = 0; rx_duty_cycle_ && i < LINK_UNIT_COUNT; i++)
             {
-                float import_power_watts = static_cast<float>(current_import_raw) / 360.0f;
-                heating_import_->publish_state(import_power_watts);
-                ESP_LOGV(TAG_IBOOST, "Current Import Power: %.1f W", import_power_watts);
+                static const char *const UNIT_NAMES[LINK_UNIT_COUNT] = {"iBoost", "Buddy", "Sender"};
+                const RxPhase &phase = rx_cycle_.get_phase(static_cast<LinkUnit>(i));
+                if (!phase.has_frames())
+                    continue;
+                ESP_LOGCONFIG(TAG_IBOOST, "    %s: %s, period %.0f ms, jitter %.0f ms, %u locks, %u lost",
+                              UNIT_NAMES[i], phase.is_locked() ? "locked" : "learning", phase.get_period_ms(),
+                              phase.get_jitter_ms(), (unsigned) phase.get_locks(), (unsigned) phase.get_unlocks());
             }
-            if (heating_boost_time_)
+#endif
+            ESP_LOGCONFIG(TAG_IBOOST, "  RX decode: %s, queues of %u frames, %u + %u dropped", decode_in_loop_ ? "in loop()" : "own task",
+                          (unsigned) RX_QUEUE_SLOTS, (unsigned) rx_dropped_, (unsigned) event_dropped_.load());
+            ESP_LOGCONFIG(TAG_IBOOST, "  Capture: %u frames (%u held, %u seen)", (unsigned) capture_.get_size(),
+                          (unsigned) capture_.get_stored(), (unsigned) capture_.get_seen());
+            const RequestScheduler::Slot *slots = scheduler_.get_slots();
+            for (size_t i = 0; i < RequestScheduler::CODE_COUNT; i++)
+            {
+                ESP_LOGCONFIG(TAG_IBOOST, "  Poll %s: every %u s (range %u-%u s, %u changes seen)", data_request_name(slots[i].code),
+                              (unsigned) (slots[i].interval_ms / 1000), (unsigned) (slots[i].min_interval_ms / 1000),
+                              (unsigned) (slots[i].max_interval_ms / 1000), (unsigned) slots[i].changes);
+            }
+            ESP_LOGCONFIG(TAG_IBOOST, "  Duplicates within %u ms: iBoost %u/%u, Buddy %u/%u, Sender %u/%u, other %u/%u",
+                          (unsigned) duplicate_filter_.get_window(),
+                          (unsigned) rx_duplicates_[FRAME_KIND_IBOOST], (unsigned) rx_frames_[FRAME_KIND_IBOOST],
+                          (unsigned) rx_duplicates_[FRAME_KIND_BUDDY], (unsigned) rx_frames_[FRAME_KIND_BUDDY],
+                          (unsigned) rx_duplicates_[FRAME_KIND_SENDER], (unsigned) rx_frames_[FRAME_KIND_SENDER],
+                          (unsigned) rx_duplicates_[FRAME_KIND_OTHER], (unsigned) rx_frames_[FRAME_KIND_OTHER]);
+            ESP_LOGCONFIG(TAG_IBOOST, "  Worst block: RX %u us, loop %u us, update %u us",
+                          (unsigned) worst_blocking_us_[BLOCKING_RX], (unsigned) worst_blocking_us_[BLOCKING_LOOP],
+                          (unsigned) worst_blocking_us_[BLOCKING_UPDATE]);
+            ESP_LOGCONFIG(TAG_IBOOST, "  Boost commands: %u confirmed, %u timed out; %u ms airtime this hour",
+                          (unsigned) command_.get_confirmed(), (unsigned) command_.get_timed_out(),
+                          (unsigned) (duty_cycle_.get_window_used_us() / 1000));
+            ESP_LOGCONFIG(TAG_IBOOST, "  Requests: %u sent, %u retries, %u answered, %u lost",
+                          (unsigned) tracker_.get_sent(), (unsigned) tracker_.get_retries(),
+                          (unsigned) tracker_.get_answered(), (unsigned) tracker_.get_lost());
+        }
+
+        void iBoostBuddy::handle_packet_iboost_(const DecodedFrame &frame, float rssi, uint32_t time_ms)
+        {
+            // iBoost frames only adopt a system when nothing has been discovered yet
+            if (!accept_system_(frame, rssi, false, time_ms))
+                return;
+
+            add_link_sample_(LINK_IBOOST, rssi, time_ms);
+
+            if (!first_data_seen_)
+            {
+                first_data_seen_ = true;
+                float seconds = (time_ms - setup_ms_) / 1000.0f;
+                ESP_LOGI(TAG_IBOOST, "First iBoost data %.1f s after setup (%s start)", seconds, restored_ ? "warm" : "cold");
+#ifdef USE_IBOOST_DIAGNOSTICS
+                if (first_data_time_)
+                    first_data_time_->publish_state(seconds);
+#endif
+            }
+
+            const IBoostFrame &status = frame.iboost;
+            short PowerSentToTank = status.power_sent_to_tank;
+            long current_import_raw = status.import_raw;
+            long energy_data_value = status.data_value; // This depends on the request
+            uint8_t data_received_mode_id = status.data_code;
+            uint8_t boost_time = status.boost_time; // boost time remaining
+            bool water_heating = status.water_heating;
+            bool cylinder_hot = status.cylinder_hot;
+            system_->overheated = status.overheated;
+
+            // Replies are timed on receive, not on when loop() got to them
+            scheduler_.on_iboost_frame(time_ms);
+            if (command_.on_status(boost_time, time_ms))
+            {
+                ESP_LOGI(TAG_IBOOST, "Boost command for %u min confirmed after %u ms (%u attempts)", command_.get_target_minutes(),
+                         (unsigned) command_.get_latency_ms(), command_.get_attempts());
+                publish_command_status_("Confirmed");
+#ifdef USE_IBOOST_DIAGNOSTICS
+                if (boost_command_latency_)
+                    boost_command_latency_->publish_state(command_.get_latency_ms());
+#endif
+            }
+
+            const char *heating_mode;
+            if (cylinder_hot)
+                heating_mode = "OFF: Water Tank Hot";
+            else if (system_->overheated)
+                heating_mode = "Failed: Overheat";
+            else if (boost_time > 0)
+                heating_mode = "ON: Heating from Manual Boost";
+            else if (water_heating)
+                heating_mode = "ON: Heating from Solar";
+            else
+                heating_mode = "OFF: Water Heating Off";
+            live_state_.mode = heating_mode;
+            live_state_.power = PowerSentToTank;
+            live_state_.import_power = static_cast<float>(current_import_raw) / 360.0f;
+            live_state_.boost_time = boost_time;
+#ifdef USE_IBOOST_STATUS_SENSORS
+            if (publish_(heating_mode_, PUBLISH_SLOT_HEATING_MODE, heating_mode, time_ms))
+                ESP_LOGD(TAG_IBOOST, "Heat: %s", heating_mode);
+#endif
+
+            // Longest combination is "iBoost Overheating | Sender Battery Low"
+            char *warning_display = live_state_.warning;
+            int warning_length = 0;
+            warning_display[0] = '\0';
+
+            if (system_->overheated)
+            {
+                warning_length = snprintf(warning_display, sizeof(live_state_.warning), "iBoost Overheating");
+            }
+
+            if (system_->sender_battery_low)
             {
-                heating_boost_time_->publish_state(boost_time);
+                snprintf(warning_display + warning_length, sizeof(live_state_.warning) - warning_length,
+                         "%sSender Battery Low", warning_length > 0 ? " | " : "");
+            }
+
+#ifdef USE_IBOOST_STATUS_SENSORS
+            if (publish_(heating_warn_, PUBLISH_SLOT_HEATING_WARN, warning_display, time_ms) && warning_display[0] != '\0')
+                ESP_LOGW(TAG_IBOOST, "Status Warning: %s", warning_display);
+
+            if (publish_(heating_power_, PUBLISH_SLOT_HEATING_POWER, PowerSentToTank, time_ms)) // Current power sent to heater
+                ESP_LOGV(TAG_IBOOST, "Current Heat Power: %d W", PowerSentToTank);
+
+            float import_power_watts = live_state_.import_power;
+            if (publish_(heating_import_, PUBLISH_SLOT_HEATING_IMPORT, import_power_watts, time_ms))
+                ESP_LOGV(TAG_IBOOST, "Current Import Power: %.1f W", import_power_watts);
+
+            if (publish_(heating_boost_time_, PUBLISH_SLOT_HEATING_BOOST_TIME, boost_time, time_ms))
                 ESP_LOGV(TAG_IBOOST, "Boost Time Remaining: %d minutes", boost_time);
+#endif
+
+            // Integrate on receive times; a Today reply in this frame re-anchors it below
+            if (rtc_ != nullptr)
+            {
+                ESPTime time = rtc_->now();
+                if (time.is_valid())
+                {
+                    if (today_day_of_year_ != 0 && time.day_of_year != today_day_of_year_)
+                        today_integrator_.new_day();
+                    today_day_of_year_ = time.day_of_year;
+                }
+            }
+            today_integrator_.add_sample(PowerSentToTank, time_ms);
+            add_rollup_(ROLLUP_POWER, PowerSentToTank, time_ms);
+            add_rollup_(ROLLUP_IMPORT, live_state_.import_power, time_ms);
+            switch (sender_import_check_.on_iboost(live_state_.import_power, time_ms))
+            {
+            case SenderImportCheck::CHANGE_TRUSTED:
+                ESP_LOGI(TAG_IBOOST, "Sender import matches the iBoost figure; publishing it from every Sender frame");
+                break;
+            case SenderImportCheck::CHANGE_DISTRUSTED:
+                ESP_LOGW(TAG_IBOOST, "Sender import %.0f W disagrees with the iBoost's %.0f W; no longer publishing it",
+                         sender_import_check_.get_last_w(), live_state_.import_power);
+                break;
+            default:
+                break;
             }
+            add_rollup_(ROLLUP_RSSI_IBOOST, rssi, time_ms);
 
             ESP_LOGVV(TAG_IBOOST, "RX: Data received mode ID: %d", data_received_mode_id);
+            scheduler_.on_reply(data_received_mode_id, energy_data_value, time_ms);
+            tracker_.on_reply(data_received_mode_id, time_ms);
             switch (data_received_mode_id)
             {
             case DATA_REQUEST_TODAY: // 0xCA (202)
-                if (heating_today_)
-                {
-                    heating_today_->publish_state(energy_data_value);
+            {
+                live_state_.today = energy_data_value;
+#ifdef USE_IBOOST_ENERGY_SENSORS
+                if (publish_(heating_today_, PUBLISH_SLOT_HEATING_TODAY, energy_data_value, time_ms))
                     ESP_LOGV(TAG_IBOOST, "Received Today's Heating: %ld Wh", energy_data_value);
-                }
+#endif
+                [[maybe_unused]] float error = today_integrator_.reconcile(energy_data_value);
+                ESP_LOGV(TAG_IBOOST, "Today estimate was off by %.1f Wh", error);
                 break;
+            }
             case DATA_REQUEST_YESTERDAY: // 0xCB (203)
-                if (heating_yesterday_)
-                {
-                    heating_yesterday_->publish_state(energy_data_value);
+                live_state_.yesterday = energy_data_value;
+#ifdef USE_IBOOST_ENERGY_SENSORS
+                if (publish_(heating_yesterday_, PUBLISH_SLOT_HEATING_YESTERDAY, energy_data_value, time_ms))
                     ESP_LOGV(TAG_IBOOST, "Received Yesterday's Heating: %ld Wh", energy_data_value);
-                }
+#endif
                 break;
             case DATA_REQUEST_LAST_7_DAYS: // 0xCC (204)
-                if (energy_data_value > 0 && heating_last_7_)
-                {
-                    heating_last_7_->publish_state(energy_data_value);
+                if (energy_data_value > 0)
+                    live_state_.last_7 = energy_data_value;
+#ifdef USE_IBOOST_ENERGY_SENSORS
+                if (energy_data_value > 0 && publish_(heating_last_7_, PUBLISH_SLOT_HEATING_LAST_7, energy_data_value, time_ms))
                     ESP_LOGV(TAG_IBOOST, "Received Last 7 Days Heating: %ld Wh", energy_data_value);
-                }
+#endif
                 break;
             case DATA_REQUEST_LAST_28_DAYS: // 0xCD (205)
-                if (energy_data_value > 0 && heating_last_28_)
-                {
-                    heating_last_28_->publish_state(energy_data_value);
+                if (energy_data_value > 0)
+                    live_state_.last_28 = energy_data_value;
+#ifdef USE_IBOOST_ENERGY_SENSORS
+                if (energy_data_value > 0 && publish_(heating_last_28_, PUBLISH_SLOT_HEATING_LAST_28, energy_data_value, time_ms))
                     ESP_LOGV(TAG_IBOOST, "Received Last 28 Days Heating: %ld Wh", energy_data_value);
-                }
+#endif
                 break;
             case DATA_REQUEST_TOTAL: // 0xCE (206)
-                if (energy_data_value > 0 && heating_last_gt_)
-                {
-                    heating_last_gt_->publish_state(energy_data_value);
+                if (energy_data_value > 0)
+                    live_state_.total = energy_data_value;
+#ifdef USE_IBOOST_ENERGY_SENSORS
+                if (energy_data_value > 0 && publish_(heating_last_gt_, PUBLISH_SLOT_HEATING_TOTAL, energy_data_value, time_ms))
                     ESP_LOGV(TAG_IBOOST, "Received Total Heating: %ld Wh", energy_data_value);
-                }
+#endif
                 break;
             }
-            update_and_publish_packet_count_();
+
+            if (today_integrator_.has_estimate())
+            {
+                live_state_.today_estimate = today_integrator_.estimate();
+#ifdef USE_IBOOST_ENERGY_SENSORS
+                publish_(heating_today_estimate_, PUBLISH_SLOT_TODAY_ESTIMATE, live_state_.today_estimate, time_ms);
+#endif
+            }
+            record_packet_();
         }
 
-        void iBoostBuddy::handle_packet_buddy_(const std::vector<uint8_t> &buffer, float rssi)
+        bool iBoostBuddy::accept_system_(const DecodedFrame &frame, float rssi, bool may_switch, uint32_t time_ms)
         {
-            if (buffer.size() < 28) // Adjusted for no length byte
+            uint16_t address = system_address(frame.address0, frame.address1);
+            SystemState *state = systems_.find_or_insert(address);
+            if (state == nullptr)
+            {
+                untracked_frames_++;
+                ESP_LOGV(TAG_IBOOST, "RX: System table full; ignoring frame from %04X", address);
+                return false;
+            }
+            state->frames++;
+            state->last_seen_ms = time_ms;
+            state->rssi_average = link_rssi_average(state->rssi_average, rssi);
+            if (rssi > state->best_rssi)
+                state->best_rssi = rssi;
+
+            if (state == system_)
+                return true;
+
+            // Switching needs a clear margin on the smoothed RSSI over several frames, so a
+            // single lucky packet from a neighbour cannot pull the choice back and forth.
+            // A current choice that has gone silent gives way to anything heard.
+            bool adopt = system_ == nullptr;
+            if (!adopt && may_switch)
             {
+                bool silent = time_ms - system_->last_seen_ms > LINK_SWITCH_SILENCE_MS;
+                bool stronger = state->frames >= LINK_SWITCH_MIN_FRAMES &&
+                                state->rssi_average > system_->rssi_average + LINK_SWITCH_MARGIN_DB;
+                adopt = silent || stronger;
+            }
+            if (!system_address_fixed_ && adopt)
+            {
+                if (system_ != nullptr)
+                    ESP_LOGI(TAG_IBOOST, "RX: Switching from system %04X (%.1f dB) to %04X (%.1f dB)", system_->address,
+                             system_->rssi_average, address, state->rssi_average);
+                system_ = state;
+#ifdef USE_IBOOST_RX_DUTY_CYCLE
+                rx_cycle_.reset(); // the new system keeps its own schedule
+#endif
+                ESP_LOGI(TAG_IBOOST, "RX: System address captured from %s: %04X (RSSI=%.1f)",
+                         frame.type == PACKET_TYPE_IBOOST ? "iBoost" : frame.type == PACKET_TYPE_BUDDY ? "Buddy" : "Sender",
+                         address, rssi);
+                return true;
+            }
+
+            // A neighbouring installation; note it once rather than on every frame
+            if (!state->reported)
+            {
+                state->reported = true;
+                ESP_LOGI(TAG_IBOOST, "RX: Hearing another iBoost system %04X (RSSI=%.1f); its frames are ignored", address, rssi);
+            }
+            return false;
+        }
+
+        void iBoostBuddy::handle_packet_buddy_(const DecodedFrame &frame, float rssi, uint32_t time_ms)
+        {
+            // A consistently stronger Buddy or Sender takes over discovery, as the nearest system is most likely ours
+            if (!accept_system_(frame, rssi, true, time_ms))
+                return;
+            add_link_sample_(LINK_BUDDY, rssi, time_ms);
+            add_rollup_(ROLLUP_RSSI_BUDDY, rssi, time_ms);
+            record_packet_();
+        }
+
+        void iBoostBuddy::handle_packet_sender_(const DecodedFrame &frame, float rssi, uint32_t time_ms)
+        {
+            if (!accept_system_(frame, rssi, true, time_ms))
                 return;
+            add_link_sample_(LINK_SENDER, rssi, time_ms);
+            add_rollup_(ROLLUP_RSSI_SENDER, rssi, time_ms);
+
+            system_->sender_battery_low = frame.sender.battery_low; // Battery status from sender packet
+
+            // The Sender transmits on its own, so this import figure needs no poll from us
+            float import_watts = static_cast<float>(frame.sender.import_raw) / 360.0f;
+            if (!sender_import_check_.on_sender(import_watts, time_ms))
+                ESP_LOGV(TAG_IBOOST, "Sender import %.0f W out of range, ignored", import_watts);
+            else if (sender_import_check_.is_trusted())
+            {
+                live_state_.import_power = import_watts;
+#ifdef USE_IBOOST_SENDER_IMPORT
+                if (publish_(sender_import_, PUBLISH_SLOT_SENDER_IMPORT, import_watts, time_ms))
+                    ESP_LOGV(TAG_IBOOST, "Sender Import Power: %.1f W", import_watts);
+#endif
             }
-            if (rssi_buddy_)
-                rssi_buddy_->publish_state(rssi);
-            ESP_LOGVV(TAG_IBOOST, "RX: Buddy RSSI:%.1f  Data: %s", rssi, format_hex_pretty(buffer).c_str());
-            bool should_update = !is_system_address_valid_ || (rssi > system_address_rssi_);
-            if (should_update)
+            record_packet_();
+        }
+
+        void iBoostBuddy::process_packet(const std::vector<uint8_t> &x, float rssi)
+        {
+            // Runs in the radio callback: copy the frame out and return
+            uint32_t start_us = micros();
+            RawFrame raw;
+            raw.time_ms = millis();
+            raw.rssi = rssi;
+            raw.length = x.size() > 0xFF ? 0xFF : static_cast<uint8_t>(x.size());
+            memcpy(raw.data, x.data(), x.size() > FRAME_MAX_LENGTH ? FRAME_MAX_LENGTH : x.size());
+            if (rx_queue_.push(raw))
+            {
+#ifdef USE_IBOOST_DIAGNOSTICS
+                size_t depth = rx_queue_.size();
+                if (depth > rx_queue_peak_)
+                    rx_queue_peak_ = depth;
+#endif
+#ifdef USE_ESP32
+                if (decode_task_handle_ != nullptr)
+                    xTaskNotifyGive(decode_task_handle_);
+#endif
+            }
+            else
             {
-                system_address_byte0_ = buffer[0]; // addr0 is at index 0
-                system_address_byte1_ = buffer[1]; // addr1 is at index 1
-                is_system_address_valid_ = true;
-                system_address_rssi_ = rssi;
-                ESP_LOGI(TAG_IBOOST, "RX: System address captured from Buddy: %02X%02X (RSSI=%.1f)", buffer[0], buffer[1], rssi);
+                rx_dropped_++;
             }
-            update_and_publish_packet_count_();
+            record_blocking_(BLOCKING_RX, start_us);
         }
 
-        void iBoostBuddy::handle_packet_sender_(const std::vector<uint8_t> &buffer, float rssi)
+#ifdef USE_ESP32
+        void iBoostBuddy::decode_task_(void *param)
         {
-            if (buffer.size() < 44) // Adjusted for no length byte
+            auto *self = static_cast<iBoostBuddy *>(param);
+            RawFrame raw;
+            for (;;)
             {
-                return;
+                ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+                while (self->rx_queue_.pop(raw))
+                    self->decode_raw_(raw);
+            }
+        }
+#endif
+
+        void iBoostBuddy::add_rollup_(RollupMetric metric, float value, uint32_t now)
+        {
+            LockGuard lock(rollup_lock_);
+            rollups_.add(metric, value, now);
+        }
+
+        void iBoostBuddy::dump_rollups_json(std::string &out)
+        {
+            uint32_t now = millis();
+            char buffer[96];
+            snprintf(buffer, sizeof(buffer), "{\"uptime_ms\":%u,\"minute\":{\"period_s\":60", (unsigned) now);
+            out = buffer;
+            LockGuard lock(rollup_lock_);
+            for (auto &rollup : rollups_.minutes)
+                rollup.advance(now);
+            for (auto &rollup : rollups_.hours)
+                rollup.advance(now);
+            for (size_t i = 0; i < ROLLUP_METRIC_COUNT; i++)
+            {
+                out += ",";
+                append_rollup_json(out, ROLLUP_METRIC_NAMES[i], rollups_.minutes[i]);
+            }
+            out += "},\"hour\":{\"period_s\":3600";
+            for (size_t i = 0; i < ROLLUP_METRIC_COUNT; i++)
+            {
+                out += ",";
+                append_rollup_json(out, ROLLUP_METRIC_NAMES[i], rollups_.hours[i]);
             }
-            if (rssi_sender_)
-                rssi_sender_->publish_state(rssi);
-            ESP_LOGVV(TAG_IBOOST, "RX: Sender RSSI:%.1f  Data: %s", rssi, format_hex_pretty(buffer).c_str());
-            bool should_update = !is_system_address_valid_ || (rssi > system_address_rssi_);
-            if (should_update)
+            out += "}}";
+        }
+
+        // Publishes the mean of the last complete minute
+#ifdef USE_IBOOST_ROLLUP_SENSORS
+        void iBoostBuddy::publish_rollups_()
+        {
+            uint32_t now = millis();
+            LockGuard lock(rollup_lock_);
+            sensor::Sensor *const targets[] = {rollup_power_, rollup_import_};
+            const RollupMetric metrics[] = {ROLLUP_POWER, ROLLUP_IMPORT};
+            for (size_t i = 0; i < 2; i++)
             {
-                system_address_byte0_ = buffer[0]; // addr0 is at index 0
-                system_address_byte1_ = buffer[1]; // addr1 is at index 1
-                is_system_address_valid_ = true;
-                system_address_rssi_ = rssi;
-                ESP_LOGI(TAG_IBOOST, "RX: System address captured from Sender: %02X%02X (RSSI=%.1f)", buffer[0], buffer[1], rssi);
+                auto &rollup = rollups_.minutes[metrics[i]];
+                rollup.advance(now);
+                const RollupBucket &bucket = rollup.get(1);
+                if (targets[i] && bucket.count > 0)
+                    targets[i]->publish_state(bucket.mean());
             }
+        }
+#endif
 
-            is_sender_battery_low_ = (buffer[12] == 0x01); // Battery status from sender packet
-            update_and_publish_packet_count_();
+        void iBoostBuddy::dump_capture(std::vector<uint8_t> &out)
+        {
+            LockGuard lock(capture_lock_);
+            capture_.dump(out, millis());
         }
 
-        void iBoostBuddy::process_packet(const std::vector<uint8_t> &x, float rssi)
+        void iBoostBuddy::decode_raw_(const RawFrame &raw)
         {
-            if (x.size() < 3)
-            { // addr0 + addr1 + packet_type
-                ESP_LOGW(TAG_IBOOST, "RX: Packet too short: %zu bytes", x.size());
+            // Nothing is formatted here: log records are queued for loop(), and the raw
+            // bytes are in the capture ring
+            size_t stored = raw.length > FRAME_MAX_LENGTH ? FRAME_MAX_LENGTH : raw.length;
+            int32_t rssi_tenths = static_cast<int32_t>(raw.rssi * 10.0f);
+            int32_t type = stored >= FRAME_HEADER_LENGTH ? raw.data[2] : -1;
+            event_log_.record<ESPHOME_LOG_LEVEL_VERY_VERBOSE>(LOG_EVENT_RX_FRAME, raw.time_ms, raw.length, rssi_tenths, type);
+
+            if (capture_.get_size() > 0)
+            {
+                LockGuard lock(capture_lock_);
+                capture_.record(raw.data, raw.length, raw.rssi, raw.time_ms);
+            }
+
+            // Repeats are dropped before any decode or publish work
+            FrameKind kind = frame_kind(raw.data, stored);
+            rx_frames_[kind].fetch_add(1, std::memory_order_relaxed);
+            if (duplicate_filter_.is_duplicate(raw.data, stored, raw.time_ms))
+            {
+                rx_duplicates_[kind].fetch_add(1, std::memory_order_relaxed);
+                event_log_.record<ESPHOME_LOG_LEVEL_VERY_VERBOSE>(LOG_EVENT_RX_DUPLICATE, raw.time_ms, raw.length, rssi_tenths, type);
                 return;
             }
-            // Extract packet info
-            uint8_t packet_length = x.size();
-            uint8_t packet_type = x[2];
 
-            ESP_LOGVV(TAG_IBOOST, "RX: Processing packet: Length=0x%02X, Type=0x%02X, RSSI=%.1f", packet_length, packet_type, rssi);
-            ESP_LOGVV(TAG_IBOOST, "RX: Raw Data : %s", format_hex_pretty(x).c_str());
+            RxEvent event;
+            event.result = decode_frame(raw.data, raw.length, event.frame);
+            event.rssi = raw.rssi;
+            event.time_ms = raw.time_ms;
+            if (!event_queue_.push(event))
+            {
+                uint32_t dropped = event_dropped_.fetch_add(1, std::memory_order_relaxed) + 1;
+                event_log_.record<ESPHOME_LOG_LEVEL_WARN>(LOG_EVENT_RX_QUEUE_FULL, raw.time_ms, dropped);
+            }
+        }
 
-            // Validate packet length constraints
-            if (packet_length < 10 || packet_length > 62)
+        void iBoostBuddy::drain_event_log_()
+        {
+            LogEvent event;
+            while (event_log_.pop(event))
             {
-                ESP_LOGW(TAG_IBOOST, "RX: Invalid packet length: %d bytes", packet_length);
+                switch (event.id)
+                {
+                case LOG_EVENT_RX_FRAME:
+                    ESP_LOGVV(TAG_IBOOST, "RX: Processing packet at %u ms: Length=0x%02X, RSSI=%.1f, Type=0x%02X",
+                              (unsigned) event.time_ms, (unsigned) event.args[0], event.args[1] / 10.0f, (unsigned) event.args[2]);
+                    break;
+                case LOG_EVENT_RX_DUPLICATE:
+                    ESP_LOGVV(TAG_IBOOST, "RX: Dropped repeated frame at %u ms: Length=0x%02X, RSSI=%.1f, Type=0x%02X",
+                              (unsigned) event.time_ms, (unsigned) event.args[0], event.args[1] / 10.0f, (unsigned) event.args[2]);
+                    break;
+                case LOG_EVENT_RX_QUEUE_FULL:
+                    ESP_LOGW(TAG_IBOOST, "RX: Decoded frame queue full, frame dropped (%u so far)", (unsigned) event.args[0]);
+                    break;
+                }
+            }
+            uint32_t lost = event_log_.take_dropped();
+            if (lost > 0)
+                ESP_LOGV(TAG_IBOOST, "%u decoder log records lost", (unsigned) lost);
+        }
+
+        void iBoostBuddy::handle_event_(const RxEvent &event)
+        {
+            const DecodedFrame &frame = event.frame;
+            float rssi = event.rssi;
+            switch (event.result)
+            {
+            case DECODE_OK:
+                break;
+            case DECODE_TOO_SHORT:
+                ESP_LOGW(TAG_IBOOST, "RX: Packet too short: %u bytes", frame.length);
+                return;
+            case DECODE_INVALID_LENGTH:
+                ESP_LOGW(TAG_IBOOST, "RX: Invalid packet length: %u bytes", frame.length);
+                return;
+            case DECODE_UNKNOWN_TYPE:
+                ESP_LOGW(TAG_IBOOST, "RX: Unknown packet type: 0x%02X", frame.type);
                 return;
             }
 
-            switch (packet_type)
+            switch (frame.type)
             {
             case PACKET_TYPE_IBOOST:
-                ESP_LOGD(TAG_IBOOST, "RX: Found iBoost packet - sending to packet decoder");
-                handle_packet_iboost_(x, rssi);
+                ESP_LOGVV(TAG_IBOOST, "RX: Found iBoost packet - sending to packet decoder");
+                handle_packet_iboost_(frame, event.rssi, event.time_ms);
                 break;
 
-            case PACKET_TYPE_BUDDY: // should check is len 29
+            case PACKET_TYPE_BUDDY:
                 ESP_LOGVV(TAG_IBOOST, "RX: Found Buddy packet - sending to packet decoder");
-                handle_packet_buddy_(x, rssi);
+                handle_packet_buddy_(frame, rssi, event.time_ms);
                 break;
 
-            case PACKET_TYPE_SENDER: // should check is len 44
+            case PACKET_TYPE_SENDER:
                 ESP_LOGVV(TAG_IBOOST, "RX: Found Sender packet - sending to packet decoder");
-                handle_packet_sender_(x, rssi);
-                break;
-
-            default:
-                ESP_LOGW(TAG_IBOOST, "RX: Unknown packet type: 0x%02X", packet_type);
+                handle_packet_sender_(frame, rssi, event.time_ms);
                 break;
             }
         }
@@ -1,12 +1,39 @@
 #pragma once
-#include "esphome.h"
 #include "esphome/core/log.h"
 #include "esphome/core/component.h"
+#include "esphome/core/helpers.h"
+#include "esphome/core/preferences.h"
 #include "esphome/components/sensor/sensor.h"
 #include "esphome/components/text_sensor/text_sensor.h"
 #include "esphome/components/time/real_time_clock.h"
+#include "command_transaction.h"
+#include "duplicate_filter.h"
+#include "energy_integrator.h"
+#include "event_log.h"
+#include "history_log.h"
+#include "iboost_protocol.h"
+#include "link_quality.h"
+#include "packet_capture.h"
+#include "publish_filter.h"
+#include "request_scheduler.h"
+#include "request_tracker.h"
+#include "rollup.h"
+#include "rx_duty_cycle.h"
+#include "sender_import.h"
+#include "spsc_ring.h"
+#include "system_table.h"
+#include <atomic>
+#include <cmath>
 #include <vector>
 
+#ifdef USE_ESP32
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#endif
+
+// Only the headers above are needed to build this component; the radio is forward
+// declared and only esphiBoost.cpp talks to the sx126x driver, so the component can
+// be built against stand-ins for these few interfaces without the generated esphome.h.
 namespace esphome {
     namespace sx126x { class SX126x; }
 }
@@ -20,32 +47,270 @@ namespace esphome {
             CONTROL_PACKET_ACTION_BOOST_CANCEL = 2,
         };
 
+        // One publish cache per output
+        enum PublishSlot
+        {
+            PUBLISH_SLOT_HEATING_MODE = 0,
+            PUBLISH_SLOT_HEATING_WARN,
+            PUBLISH_SLOT_HEATING_POWER,
+            PUBLISH_SLOT_HEATING_IMPORT,
+            PUBLISH_SLOT_HEATING_BOOST_TIME,
+            PUBLISH_SLOT_HEATING_TODAY,
+            PUBLISH_SLOT_HEATING_YESTERDAY,
+            PUBLISH_SLOT_HEATING_LAST_7,
+            PUBLISH_SLOT_HEATING_LAST_28,
+            PUBLISH_SLOT_HEATING_TOTAL,
+            PUBLISH_SLOT_RSSI_IBOOST,
+            PUBLISH_SLOT_RSSI_BUDDY,
+            PUBLISH_SLOT_RSSI_SENDER,
+            PUBLISH_SLOT_SCHEDULER_STATUS,
+            PUBLISH_SLOT_LATENCY_P50,
+            PUBLISH_SLOT_LATENCY_P95,
+            PUBLISH_SLOT_LATENCY_P99,
+            PUBLISH_SLOT_LOSS_RATE,
+            PUBLISH_SLOT_TODAY_ESTIMATE,
+            PUBLISH_SLOT_LINK_LOSS_IBOOST,
+            PUBLISH_SLOT_LINK_LOSS_BUDDY,
+            PUBLISH_SLOT_LINK_LOSS_SENDER,
+            PUBLISH_SLOT_DUPLICATE_RATE_IBOOST,
+            PUBLISH_SLOT_DUPLICATE_RATE_BUDDY,
+            PUBLISH_SLOT_DUPLICATE_RATE_SENDER,
+            PUBLISH_SLOT_SENDER_IMPORT,
+            PUBLISH_SLOT_COUNT,
+        };
+
+        inline PublishClass publish_class_of(PublishSlot slot)
+        {
+            switch (slot)
+            {
+            case PUBLISH_SLOT_HEATING_POWER:
+            case PUBLISH_SLOT_HEATING_IMPORT:
+            case PUBLISH_SLOT_SENDER_IMPORT:
+                return PUBLISH_CLASS_POWER;
+            case PUBLISH_SLOT_HEATING_TODAY:
+            case PUBLISH_SLOT_HEATING_YESTERDAY:
+            case PUBLISH_SLOT_HEATING_LAST_7:
+            case PUBLISH_SLOT_HEATING_LAST_28:
+            case PUBLISH_SLOT_HEATING_TOTAL:
+            case PUBLISH_SLOT_TODAY_ESTIMATE:
+                return PUBLISH_CLASS_ENERGY;
+            case PUBLISH_SLOT_RSSI_IBOOST:
+            case PUBLISH_SLOT_RSSI_BUDDY:
+            case PUBLISH_SLOT_RSSI_SENDER:
+                return PUBLISH_CLASS_SIGNAL;
+            case PUBLISH_SLOT_LOSS_RATE:
+            case PUBLISH_SLOT_LINK_LOSS_IBOOST:
+            case PUBLISH_SLOT_LINK_LOSS_BUDDY:
+            case PUBLISH_SLOT_LINK_LOSS_SENDER:
+            case PUBLISH_SLOT_DUPLICATE_RATE_IBOOST:
+            case PUBLISH_SLOT_DUPLICATE_RATE_BUDDY:
+            case PUBLISH_SLOT_DUPLICATE_RATE_SENDER:
+                return PUBLISH_CLASS_PERCENT;
+            case PUBLISH_SLOT_HEATING_BOOST_TIME:
+            case PUBLISH_SLOT_LATENCY_P50:
+            case PUBLISH_SLOT_LATENCY_P95:
+            case PUBLISH_SLOT_LATENCY_P99:
+                return PUBLISH_CLASS_DURATION;
+            default:
+                return PUBLISH_CLASS_TEXT;
+            }
+        }
+
+        // Latest decoded values, for local consumers such as the e-ink dashboard.
+        // Numeric fields stay NAN until the first value arrives.
+        struct iBoostState
+        {
+            const char *mode = nullptr; // nullptr until the first iBoost frame
+            char warning[48] = "";
+            float power = NAN;          // W sent to the tank
+            float import_power = NAN;   // W drawn from the grid
+            uint8_t boost_time = 0;     // manual boost minutes remaining
+            float today = NAN;          // Wh
+            float today_estimate = NAN; // Wh, integrated from power between Today replies
+            float yesterday = NAN;
+            float last_7 = NAN;
+            float last_28 = NAN;
+            float total = NAN;
+            float rssi_iboost = NAN;    // dB
+            float rssi_buddy = NAN;
+            float rssi_sender = NAN;
+        };
+
+        // Flash-persisted warm start state; bump the version when the layout changes
+        static constexpr uint8_t SAVED_STATE_VERSION = 1;
+        struct iBoostSavedState
+        {
+            uint8_t version;
+            uint8_t counters_valid; // bit n set when counters[n] holds a value
+            uint16_t address;       // system followed, 0 with has_address false
+            bool has_address;
+            float rssi;             // best RSSI seen from that system
+            float counters[RequestScheduler::CODE_COUNT]; // Wh, indexed by code - DATA_REQUEST_TODAY
+        };
+
+        // Raw frame as copied out of the radio callback
+        struct RawFrame
+        {
+            uint32_t time_ms;
+            float rssi;
+            uint8_t length; // as received, clamped to 255; bytes past FRAME_MAX_LENGTH are dropped
+            uint8_t data[FRAME_MAX_LENGTH];
+        };
+
+        // Decoded frame handed back to loop()
+        struct RxEvent
+        {
+            DecodedFrame frame;
+            DecodeResult result;
+            float rssi;
+            uint32_t time_ms; // when the radio delivered the frame
+        };
+
+        // Received frames are counted per packet type
+        enum FrameKind
+        {
+            FRAME_KIND_IBOOST = 0,
+            FRAME_KIND_BUDDY,
+            FRAME_KIND_SENDER,
+            FRAME_KIND_OTHER, // unknown type or too short to have one
+            FRAME_KIND_COUNT,
+        };
+
+        inline FrameKind frame_kind(const uint8_t *data, size_t length)
+        {
+            if (length < FRAME_HEADER_LENGTH)
+                return FRAME_KIND_OTHER;
+            switch (data[2])
+            {
+            case PACKET_TYPE_IBOOST:
+                return FRAME_KIND_IBOOST;
+            case PACKET_TYPE_BUDDY:
+                return FRAME_KIND_BUDDY;
+            case PACKET_TYPE_SENDER:
+                return FRAME_KIND_SENDER;
+            default:
+                return FRAME_KIND_OTHER;
+            }
+        }
+
+        // Slots in each of the raw and decoded frame queues
+        static constexpr size_t RX_QUEUE_SLOTS = 16;
+
+        // Entry points whose worst-case main loop blocking time is recorded
+        enum BlockingSection
+        {
+            BLOCKING_RX = 0, // process_packet(), called from the radio's on_packet
+            BLOCKING_LOOP,
+            BLOCKING_UPDATE,
+            BLOCKING_SECTION_COUNT,
+        };
+
         class iBoostBuddy : public PollingComponent {
         public:
 
-            iBoostBuddy() : PollingComponent(10000) {} // poll every 10 seconds (fixed from 100000)
+            iBoostBuddy() : PollingComponent(10000) {} // scheduler tick every 10 seconds; not every tick transmits
 
             void set_time(time::RealTimeClock * t) { rtc_ = t; }
             void set_radio(esphome::sx126x::SX126x *r) { radio_ = r; }
 
-            // Optional wiring for sensors/text_sensors
+            // Only follow this system; without it the address is discovered from traffic
+            void set_system_address(uint16_t address)
+            {
+                system_ = systems_.find_or_insert(address);
+                system_address_fixed_ = true;
+            }
+
+            // Output groups that are only compiled in when __init__.py sees one of them configured.
+            // The live values behind them are always kept, as the display reads those.
+#ifdef USE_IBOOST_STATUS_SENSORS
             void set_packet_count(sensor::Sensor *s) { packet_count_ = s; }
-            void set_ts_last_packet(text_sensor::TextSensor *s) { ts_last_packet_ = s; }
             void set_heating_mode(text_sensor::TextSensor *s) { heating_mode_ = s; }
             void set_heating_warn(text_sensor::TextSensor *s) { heating_warn_ = s; }
             void set_heating_power(sensor::Sensor *s) { heating_power_ = s; }
             void set_heating_import(sensor::Sensor *s) { heating_import_ = s; }
             void set_heating_boost_time(sensor::Sensor *s) { heating_boost_time_ = s; }
+            void set_boost_command_status(text_sensor::TextSensor *s) { boost_command_status_ = s; }
+#endif
+#ifdef USE_IBOOST_ENERGY_SENSORS
             void set_heating_today(sensor::Sensor *s) { heating_today_ = s; }
             void set_heating_yesterday(sensor::Sensor *s) { heating_yesterday_ = s; }
             void set_heating_last_7(sensor::Sensor *s) { heating_last_7_ = s; }
             void set_heating_last_28(sensor::Sensor *s) { heating_last_28_ = s; }
             void set_heating_last_gt(sensor::Sensor *s) { heating_last_gt_ = s; }
+            void set_heating_today_estimate(sensor::Sensor *s);
+#endif
+#ifdef USE_IBOOST_RSSI_SENSORS
             void set_rssi_iboost(sensor::Sensor *s) { rssi_iboost_ = s; }
             void set_rssi_buddy(sensor::Sensor *s) { rssi_buddy_ = s; }
             void set_rssi_sender(sensor::Sensor *s) { rssi_sender_ = s; }
+#endif
+#ifdef USE_IBOOST_SENDER_IMPORT
+            void set_sender_import(sensor::Sensor *s) { sender_import_ = s; }
+#endif
+#ifdef USE_IBOOST_LAST_PACKET
+            void set_ts_last_packet(text_sensor::TextSensor *s) { ts_last_packet_ = s; }
+#endif
+#ifdef USE_IBOOST_DIAGNOSTICS
+            void set_link_loss_iboost(sensor::Sensor *s) { link_loss_[LINK_IBOOST] = s; }
+            void set_link_loss_buddy(sensor::Sensor *s) { link_loss_[LINK_BUDDY] = s; }
+            void set_link_loss_sender(sensor::Sensor *s) { link_loss_[LINK_SENDER] = s; }
+            void set_publish_suppressed(sensor::Sensor *s) { publish_suppressed_ = s; }
+            void set_scheduler_status(text_sensor::TextSensor *s) { scheduler_status_ = s; }
+            void set_latency_p50(sensor::Sensor *s) { latency_p50_ = s; }
+            void set_latency_p95(sensor::Sensor *s) { latency_p95_ = s; }
+            void set_latency_p99(sensor::Sensor *s) { latency_p99_ = s; }
+            void set_request_loss_rate(sensor::Sensor *s) { request_loss_rate_ = s; }
+            void set_rx_queue_depth(sensor::Sensor *s) { rx_queue_depth_ = s; }
+            void set_rx_queue_drops(sensor::Sensor *s) { rx_queue_drops_ = s; }
+            void set_first_data_time(sensor::Sensor *s) { first_data_time_ = s; }
+            void set_duplicate_rate_iboost(sensor::Sensor *s) { duplicate_rate_[FRAME_KIND_IBOOST] = s; }
+            void set_duplicate_rate_buddy(sensor::Sensor *s) { duplicate_rate_[FRAME_KIND_BUDDY] = s; }
+            void set_duplicate_rate_sender(sensor::Sensor *s) { duplicate_rate_[FRAME_KIND_SENDER] = s; }
+            void set_boost_command_latency(sensor::Sensor *s) { boost_command_latency_ = s; }
+#endif
+
+            // Publish deduplication and rate limiting
+            void set_publish_deadband(PublishClass c, float deadband) { publish_policies_[c].deadband = deadband; }
+            void set_publish_min_interval(PublishClass c, uint32_t ms) { publish_policies_[c].min_interval_ms = ms; }
+            void set_publish_max_interval(PublishClass c, uint32_t ms) { publish_policies_[c].max_interval_ms = ms; }
+            void set_stats_interval(uint32_t ms) { stats_interval_ms_ = ms; }
+            void set_link_quality_interval(uint32_t ms) { link_quality_interval_ms_ = ms; }
+
+            // Warm start: address and counters saved at most once per save interval
+            void set_restore(uint32_t hash) { restore_hash_ = hash; }
+            void set_save_interval(uint32_t ms) { save_interval_ms_ = ms; }
 
-            // Operations
+            // Component id; with several instances, ?id=<it> picks this one's web endpoints
+            void set_instance_id(const char *id) { instance_id_ = id; }
+            const char *get_instance_id() const { return instance_id_; }
+
+            // Raw frame capture, served at /iboost/capture when web_server is present
+            void set_capture_frames(size_t frames) { capture_.set_size(frames); }
+            void dump_capture(std::vector<uint8_t> &out);
+
+            // Repeated frames within this window are dropped before decoding (0 = keep all)
+            void set_duplicate_window(uint32_t ms) { duplicate_filter_.set_window(ms); }
+
+            // Minute and hour rollups, served as JSON at /iboost/rollups
+            void dump_rollups_json(std::string &out);
+#ifdef USE_IBOOST_ROLLUP_SENSORS
+            void set_rollup_power(sensor::Sensor *s) { rollup_power_ = s; }
+            void set_rollup_import(sensor::Sensor *s) { rollup_import_ = s; }
+#endif
+
+#ifdef USE_IBOOST_HISTORY
+            // Flash history log in the named data partition; unset keeps this instance's log off
+            void set_history_partition(const char *label) { history_partition_ = label; }
+            // Flash history log sectors, served at /iboost/history?sector=N
+            size_t get_history_sector_count() const { return history_.is_ready() ? history_.get_sector_count() : 0; }
+            bool read_history_sector(size_t sector, std::vector<uint8_t> &out);
+#endif
+#ifdef USE_IBOOST_RX_DUTY_CYCLE
+            // Radio sleep between predicted frames; only for an instance with the radio to itself
+            void set_rx_duty_cycle(bool enabled) { rx_duty_cycle_ = enabled; }
+#endif
+
+            // Operations; retransmitted until the iBoost reports the new boost time
             void boost_start(uint8_t minutes);
             void boost_cancel();
 
@@ -54,40 +319,206 @@ namespace esphome {
             void loop() override;   // Receiving done via callback -> process_packet()
             void update() override; // Polling trigger (send ping cycle)
             void dump_config() override;
+            void on_safe_shutdown() override; // flush unsaved state before an OTA or reboot
+
+            const iBoostState &get_live_state() const { return live_state_; }
 
             // Radio I/O exposed for the sx126x callback and send helpers
             void process_packet(const std::vector<uint8_t> &x, float rssi); // called by the sx126x
 
         private:
-            // Packet processing helpers
+            // Packet processing helpers: process_packet() only queues the raw frame,
+            // decode_raw_() runs on the decode task (or in loop() without one) and
+            // handle_event_() applies the result from loop()
+            void decode_raw_(const RawFrame &raw);
+            void handle_event_(const RxEvent &event);
+            void drain_event_log_();
+#ifdef USE_ESP32
+            static void decode_task_(void *param);
+#endif
+            void record_blocking_(BlockingSection section, uint32_t start_us);
 
-            // Packet handlers
-            void handle_packet_iboost_(const std::vector<uint8_t> &buffer, float rssi);
-            void handle_packet_buddy_(const std::vector<uint8_t> &buffer, float rssi);
-            void handle_packet_sender_(const std::vector<uint8_t> &buffer, float rssi);
+            // Packet handlers, fed with frames already decoded by decode_frame()
+            void handle_packet_iboost_(const DecodedFrame &frame, float rssi, uint32_t time_ms);
+            void handle_packet_buddy_(const DecodedFrame &frame, float rssi, uint32_t time_ms);
+            void handle_packet_sender_(const DecodedFrame &frame, float rssi, uint32_t time_ms);
+            // Records the frame against its system; true if it belongs to the system this
+            // instance follows. The first system heard is adopted; `may_switch` lets a
+            // system that is consistently stronger than the current choice replace it.
+            bool accept_system_(const DecodedFrame &frame, float rssi, bool may_switch, uint32_t time_ms);
 
             // Internal helpers
-            void send_packet_(const std::vector<uint8_t> &packet);
-            void update_and_publish_packet_count_();
-            void send_control_packet_(ControlPacketAction packet_mode, uint8_t boost_minutes);
-            uint8_t get_next_data_request_code_();
+            void send_packet_(const uint8_t *data, size_t length);
+            void record_packet_();
+            void publish_packet_stats_();
+            void add_link_sample_(LinkUnit unit, float rssi, uint32_t time_ms);
+            void publish_link_quality_();
+            bool publish_(sensor::Sensor *sensor, PublishSlot slot, float value, uint32_t now);
+            bool publish_(text_sensor::TextSensor *sensor, PublishSlot slot, const char *value, uint32_t now);
+            bool send_control_packet_(ControlPacketAction packet_mode, uint8_t boost_minutes, uint8_t request_code);
+            void send_data_request_(uint8_t request_code, uint32_t now);
+            void start_command_(uint8_t boost_minutes);
+            void run_command_(uint32_t now);
+            void publish_command_status_(const char *status);
+            void add_rollup_(RollupMetric metric, float value, uint32_t now);
+#ifdef USE_IBOOST_HISTORY
+            void log_history_();
+#endif
+#ifdef USE_IBOOST_RX_DUTY_CYCLE
+            void run_rx_duty_cycle_(uint32_t now);
+#endif
+            void restore_state_();
+            void save_state_();
+            float *counter_(uint8_t code);
+#ifdef USE_IBOOST_DIAGNOSTICS
+            void publish_request_stats_();
+            void publish_duplicate_stats_();
+            void publish_schedule_status_();
+#endif
+#ifdef USE_IBOOST_ROLLUP_SENSORS
+            void publish_rollups_();
+#endif
 
             // Sensors
+#ifdef USE_IBOOST_STATUS_SENSORS
             sensor::Sensor *packet_count_ = nullptr;
-            text_sensor::TextSensor *ts_last_packet_ = nullptr;
             text_sensor::TextSensor *heating_mode_ = nullptr;
             text_sensor::TextSensor *heating_warn_ = nullptr;
             sensor::Sensor *heating_power_ = nullptr;
             sensor::Sensor *heating_import_ = nullptr;
             sensor::Sensor *heating_boost_time_ = nullptr;
+            text_sensor::TextSensor *boost_command_status_ = nullptr; // Outcome of the last boost start/cancel
+#endif
+#ifdef USE_IBOOST_ENERGY_SENSORS
             sensor::Sensor *heating_today_ = nullptr;
             sensor::Sensor *heating_yesterday_ = nullptr;
             sensor::Sensor *heating_last_7_ = nullptr;
             sensor::Sensor *heating_last_28_ = nullptr;
             sensor::Sensor *heating_last_gt_ = nullptr;
-            sensor::Sensor *rssi_iboost_ = nullptr;   // Last RSSI seen from iBoost main unit
-            sensor::Sensor *rssi_buddy_ = nullptr;    // Last RSSI seen from Buddy unit
-            sensor::Sensor *rssi_sender_ = nullptr;   // Last RSSI seen from Sender unit
+            sensor::Sensor *heating_today_estimate_ = nullptr; // Today (Wh) integrated between real replies
+#endif
+#ifdef USE_IBOOST_RSSI_SENSORS
+            sensor::Sensor *rssi_iboost_ = nullptr;   // Smoothed RSSI of the iBoost main unit
+            sensor::Sensor *rssi_buddy_ = nullptr;    // Smoothed RSSI of the Buddy unit
+            sensor::Sensor *rssi_sender_ = nullptr;   // Smoothed RSSI of the Sender unit
+#endif
+#ifdef USE_IBOOST_SENDER_IMPORT
+            sensor::Sensor *sender_import_ = nullptr; // Import from each Sender frame, once cross-checked
+#endif
+#ifdef USE_IBOOST_LAST_PACKET
+            text_sensor::TextSensor *ts_last_packet_ = nullptr;
+            ESPTime last_packet_time_{};
+            bool last_packet_time_pending_ = false;
+#endif
+#ifdef USE_IBOOST_DIAGNOSTICS
+            sensor::Sensor *link_loss_[LINK_UNIT_COUNT] = {}; // Estimated frame loss per unit (%)
+            sensor::Sensor *publish_suppressed_ = nullptr; // Publishes held back by the publish cache
+            text_sensor::TextSensor *scheduler_status_ = nullptr; // Last data-request schedule decision
+            sensor::Sensor *latency_p50_ = nullptr;        // Data request round trip, median (ms)
+            sensor::Sensor *latency_p95_ = nullptr;
+            sensor::Sensor *latency_p99_ = nullptr;
+            sensor::Sensor *request_loss_rate_ = nullptr;  // Data requests never answered (%)
+            sensor::Sensor *rx_queue_depth_ = nullptr;     // Deepest RX queue backlog since the last stats publish
+            sensor::Sensor *rx_queue_drops_ = nullptr;     // Frames dropped because a queue was full
+            sensor::Sensor *first_data_time_ = nullptr;    // Seconds from setup() to the first frame from our system
+            sensor::Sensor *duplicate_rate_[FRAME_KIND_COUNT] = {}; // Share of frames dropped as repeats (%)
+            sensor::Sensor *boost_command_latency_ = nullptr;       // First send to confirmation (ms)
+            float published_queue_drops_ = NAN;
+            uint32_t published_suppressed_ = 0;
+#endif
+#ifdef USE_IBOOST_ROLLUP_SENSORS
+            sensor::Sensor *rollup_power_ = nullptr;       // Mean heating power over the last full minute
+            sensor::Sensor *rollup_import_ = nullptr;      // Mean import over the last full minute
+#endif
+
+            const char *instance_id_ = "";
+            uint32_t worst_blocking_us_[BLOCKING_SECTION_COUNT] = {};
+            iBoostState live_state_;
+
+            // Radio callback -> decode task -> loop()
+            SpscRing<RawFrame, RX_QUEUE_SLOTS> rx_queue_;
+            SpscRing<RxEvent, RX_QUEUE_SLOTS> event_queue_;
+            uint32_t rx_dropped_ = 0;                 // raw queue full, counted by the radio callback
+            std::atomic<uint32_t> event_dropped_{0};  // decoded queue full, counted by the decode task
+#ifdef USE_IBOOST_DIAGNOSTICS
+            size_t rx_queue_peak_ = 0;
+#endif
+            bool decode_in_loop_ = true; // no decode task running
+
+            // Decoder-side log records, formatted from loop()
+            EventLog<32> event_log_;
+
+            // Only touched by whichever side decodes; the counters are read from loop()
+            DuplicateFilter duplicate_filter_;
+            std::atomic<uint32_t> rx_frames_[FRAME_KIND_COUNT] = {};
+            std::atomic<uint32_t> rx_duplicates_[FRAME_KIND_COUNT] = {};
+#ifdef USE_ESP32
+            TaskHandle_t decode_task_handle_ = nullptr;
+#endif
+
+            // Filled by the decoder, read by the web server task
+            PacketCapture capture_;
+            Mutex capture_lock_;
+
+            // Updated from loop(), read by the web server task
+            Rollups rollups_;
+            Mutex rollup_lock_;
+
+#ifdef USE_IBOOST_HISTORY
+            const char *history_partition_ = nullptr;
+            FlashRegion *history_flash_ = nullptr; // history_partition_, if the partition table has it
+            HistoryLog history_;
+#endif
+#ifdef USE_IBOOST_RX_DUTY_CYCLE
+            // Puts the radio to sleep between the predicted frames of this system's units
+            RxDutyCycle rx_cycle_;
+            bool rx_duty_cycle_ = false;
+            bool radio_listening_ = true;
+#endif
+
+            // Per-unit link quality, published every link_quality_interval
+            LinkQuality links_[LINK_UNIT_COUNT];
+            uint32_t link_quality_interval_ms_ = 60000;
+
+            // Every system heard, and the one this instance follows (nullptr until known)
+            SystemTable systems_;
+            SystemState *system_ = nullptr;
+            bool system_address_fixed_ = false;
+            uint32_t untracked_frames_ = 0;
+
+            // Warm start
+            uint32_t restore_hash_ = 0; // 0 = not persisted
+            uint32_t save_interval_ms_ = 600000;
+            ESPPreferenceObject pref_;
+            iBoostSavedState saved_{};
+            bool restored_ = false;
+            uint32_t setup_ms_ = 0;
+            bool first_data_seen_ = false;
+
+            EnergyIntegrator today_integrator_;
+            uint16_t today_day_of_year_ = 0; // local day of the last frame, 0 until the clock is valid
+            SenderImportCheck sender_import_check_;
+
+            RequestScheduler scheduler_;
+            RequestTracker tracker_;
+
+            // Boost start/cancel in flight; data polls pause while it is active
+            CommandTransaction command_;
+            DutyCycleLimiter duty_cycle_;
+
+            // Publish cache state
+            PublishPolicy publish_policies_[PUBLISH_CLASS_COUNT] = {
+                default_publish_policy(PUBLISH_CLASS_POWER),
+                default_publish_policy(PUBLISH_CLASS_ENERGY),
+                default_publish_policy(PUBLISH_CLASS_SIGNAL),
+                default_publish_policy(PUBLISH_CLASS_PERCENT),
+                default_publish_policy(PUBLISH_CLASS_DURATION),
+                default_publish_policy(PUBLISH_CLASS_TEXT),
+            };
+            PublishFilter publish_filters_[PUBLISH_SLOT_COUNT];
+            uint32_t stats_interval_ms_ = 30000;
+            uint32_t total_packet_count_ = 0;
+            uint32_t published_packet_count_ = 0;
 
             time::RealTimeClock *rtc_ = nullptr;
             esphome::sx126x::SX126x *radio_ = nullptr; // native driver
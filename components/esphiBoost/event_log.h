@@ -0,0 +1,57 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include "esphome/core/log.h"
+#include "spsc_ring.h"
+
+namespace esphome
+{
+    namespace esphiBoost
+    {
+
+        // Messages the decode task can log; the text lives in iBoostBuddy::drain_event_log_()
+        enum LogEventId : uint8_t
+        {
+            LOG_EVENT_RX_FRAME = 0,   // args: length, RSSI * 10, packet type
+            LOG_EVENT_RX_DUPLICATE,   // args: length, RSSI * 10, packet type
+            LOG_EVENT_RX_QUEUE_FULL,  // args: total frames dropped so far
+        };
+
+        struct LogEvent
+        {
+            uint32_t time_ms;
+            LogEventId id;
+            int32_t args[3];
+        };
+
+        // Binary log records from a task that should not format text or take the logger's
+        // lock. Recording copies a few integers into a lock-free ring; loop() formats them
+        // later. Records below the compiled log level are discarded at compile time, so at
+        // the shipped DEBUG level the frame-by-frame events cost nothing.
+        template <size_t N>
+        class EventLog
+        {
+        public:
+            template <int LEVEL>
+            void record(LogEventId id, uint32_t time_ms, int32_t arg0 = 0, int32_t arg1 = 0, int32_t arg2 = 0)
+            {
+                if constexpr (LEVEL <= ESPHOME_LOG_LEVEL)
+                {
+                    LogEvent event{time_ms, id, {arg0, arg1, arg2}};
+                    if (!ring_.push(event))
+                        dropped_.fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+
+            bool pop(LogEvent &event) { return ring_.pop(event); }
+
+            // Records lost because loop() had not caught up; read and reset by the consumer
+            uint32_t take_dropped() { return dropped_.exchange(0, std::memory_order_relaxed); }
+
+        protected:
+            SpscRing<LogEvent, N> ring_;
+            std::atomic<uint32_t> dropped_{0};
+        };
+
+    } // namespace esphiBoost
+} // namespace esphome
@@ -0,0 +1,131 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+// Compile-time frame schemas. A frame layout is written once as a list of fields,
+// each naming a struct member, a byte offset and a codec; decode and encode are
+// generated from that list as straight-line code with no runtime table walk.
+
+namespace esphome
+{
+    namespace esphiBoost
+    {
+
+        // Codecs: how one field is laid out on the air. SIZE is the number of bytes a
+        // frame must contain for the field to be read.
+        struct CodecU8
+        {
+            static constexpr size_t SIZE = 1;
+            static uint8_t read(const uint8_t *p, size_t) { return p[0]; }
+            static void write(uint8_t *p, uint8_t value) { p[0] = value; }
+        };
+
+        // Flags reported as a whole byte; each codec says which byte value means true
+        struct CodecFlagZero
+        {
+            static constexpr size_t SIZE = 1;
+            static bool read(const uint8_t *p, size_t) { return p[0] == 0; }
+        };
+
+        struct CodecFlagNonZero
+        {
+            static constexpr size_t SIZE = 1;
+            static bool read(const uint8_t *p, size_t) { return p[0] != 0; }
+        };
+
+        struct CodecFlagOne
+        {
+            static constexpr size_t SIZE = 1;
+            static bool read(const uint8_t *p, size_t) { return p[0] == 0x01; }
+        };
+
+        // Frames are not aligned, so multi-byte fields are assembled byte by byte
+        struct CodecI16LE
+        {
+            static constexpr size_t SIZE = 2;
+            static int16_t read(const uint8_t *p, size_t) { return static_cast<int16_t>(p[0] | (p[1] << 8)); }
+        };
+
+        struct CodecI32LE
+        {
+            static constexpr size_t SIZE = 4;
+            static int32_t read(const uint8_t *p, size_t)
+            {
+                return static_cast<int32_t>(static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+                                            (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24));
+            }
+        };
+
+        // int32 LE at the very end of a frame that may stop one byte short; the bytes
+        // present are used and a missing top byte reads as zero
+        struct CodecI32LETail
+        {
+            static constexpr size_t SIZE = 3;
+            static int32_t read(const uint8_t *p, size_t available)
+            {
+                uint32_t top = available >= 4 ? static_cast<uint32_t>(p[3]) << 24 : 0;
+                return static_cast<int32_t>(static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+                                            (static_cast<uint32_t>(p[2]) << 16) | top);
+            }
+        };
+
+        template <typename> struct MemberPointerTraits;
+        template <typename C, typename T> struct MemberPointerTraits<T C::*>
+        {
+            using Frame = C;
+        };
+
+        // One frame byte range mapped onto a struct member
+        template <auto Member, size_t Offset, typename Codec>
+        struct Field
+        {
+            using Frame = typename MemberPointerTraits<decltype(Member)>::Frame;
+            static constexpr size_t END = Offset + Codec::SIZE;
+
+            static void decode(const uint8_t *data, size_t length, Frame &frame)
+            {
+                frame.*Member = Codec::read(data + Offset, length - Offset);
+            }
+            static void encode(uint8_t *data, const Frame &frame) { Codec::write(data + Offset, frame.*Member); }
+        };
+
+        // A byte that always carries the same value; written on encode, skipped on decode
+        template <size_t Offset, uint8_t Value>
+        struct Fixed
+        {
+            static constexpr size_t END = Offset + 1;
+
+            template <typename Frame> static void decode(const uint8_t *, size_t, Frame &) {}
+            template <typename Frame> static void encode(uint8_t *data, const Frame &) { data[Offset] = Value; }
+        };
+
+        template <typename... Fields>
+        struct FrameSchema
+        {
+            // Shortest frame that holds every field
+            static constexpr size_t MIN_LENGTH = [] {
+                size_t end = 0;
+                for (size_t field_end : {Fields::END...})
+                    end = field_end > end ? field_end : end;
+                return end;
+            }();
+
+            // `length` must be at least MIN_LENGTH
+            template <typename Frame> static void decode(const uint8_t *data, size_t length, Frame &frame)
+            {
+                (Fields::decode(data, length, frame), ...);
+            }
+
+            // Bytes not covered by the schema are sent as zero
+            template <size_t N, typename Frame> static void encode(std::array<uint8_t, N> &out, const Frame &frame)
+            {
+                static_assert(N >= MIN_LENGTH, "frame buffer shorter than its schema");
+                out.fill(0);
+                (Fields::encode(out.data(), frame), ...);
+            }
+        };
+
+    } // namespace esphiBoost
+} // namespace esphome
@@ -0,0 +1,226 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace esphome
+{
+    namespace esphiBoost
+    {
+
+        // Raw flash the history log is kept in. Offsets are relative to the region;
+        // erase works on whole HISTORY_SECTOR_SIZE sectors and leaves them 0xFF.
+        class FlashRegion
+        {
+        public:
+            virtual ~FlashRegion() = default;
+            virtual bool read(size_t offset, void *data, size_t length) = 0;
+            virtual bool write(size_t offset, const void *data, size_t length) = 0;
+            virtual bool erase_sector(size_t offset) = 0;
+            virtual size_t size() const = 0;
+        };
+
+        // Log layout, all integers little-endian (tools/iboost_history.py reads this):
+        //   every sector starts with a 32-byte header: "IBHL", u32 sequence, u8 version,
+        //   then fixed 32-byte records until the first slot still erased (type 0xFF).
+        //   record: u8 type, u8 reserved, u16 system address, u32 unix time (0 = clock
+        //   not set), 20 payload bytes, u32 FNV-1a of the first 28 bytes.
+        // Sectors are filled and erased strictly in rotation, so wear is spread evenly
+        // and nothing is ever rewritten in place; the sector with the highest sequence
+        // is the one being appended to.
+        static constexpr size_t HISTORY_SECTOR_SIZE = 4096;
+        static constexpr size_t HISTORY_RECORD_SIZE = 32;
+        static constexpr size_t HISTORY_RECORDS_PER_SECTOR = HISTORY_SECTOR_SIZE / HISTORY_RECORD_SIZE - 1; // slot 0 is the header
+        static constexpr size_t HISTORY_BATCH_RECORDS = 8; // 256 bytes; the header slot puts it across two flash pages
+        static constexpr uint32_t HISTORY_MAGIC = 0x4C484249; // "IBHL"
+        static constexpr uint8_t HISTORY_VERSION = 1;
+
+        enum HistoryRecordType : uint8_t
+        {
+            HISTORY_RECORD_COUNTERS = 1, // payload: i32 Wh today, yesterday, last 7, last 28, total (INT32_MIN = unknown)
+            HISTORY_RECORD_ROLLUP = 2,   // payload: i16 power min/max/mean W, i16 import min/max/mean W,
+                                         // i16 iBoost RSSI mean * 10, u16 samples, 4 reserved
+        };
+
+        struct HistoryRecord
+        {
+            uint8_t type;
+            uint8_t reserved;
+            uint16_t address;
+            uint32_t time;
+            uint8_t payload[20];
+            uint32_t check;
+        };
+        static_assert(sizeof(HistoryRecord) == HISTORY_RECORD_SIZE, "history record must stay 32 bytes");
+
+        // Append-only log over a FlashRegion. Records are held in RAM and written
+        // HISTORY_BATCH_RECORDS at a time, so the write count is a fraction of the record
+        // count; the erase count is one per HISTORY_RECORDS_PER_SECTOR records regardless
+        // of batching.
+        class HistoryLog
+        {
+        public:
+            // Finds the append position, or formats the region if it holds no log
+            bool begin(FlashRegion *flash)
+            {
+                flash_ = flash;
+                sector_count_ = flash->size() / HISTORY_SECTOR_SIZE;
+                if (sector_count_ < 2)
+                    return false;
+
+                bool found = false;
+                for (size_t sector = 0; sector < sector_count_; sector++)
+                {
+                    SectorHeader header;
+                    if (!flash_->read(sector * HISTORY_SECTOR_SIZE, &header, sizeof(header)) || header.magic != HISTORY_MAGIC ||
+                        header.version != HISTORY_VERSION)
+                        continue;
+                    if (!found || static_cast<int32_t>(header.sequence - sequence_) > 0)
+                    {
+                        found = true;
+                        sequence_ = header.sequence;
+                        sector_ = sector;
+                    }
+                }
+                if (!found)
+                    return start_sector_(0, 1);
+
+                // First erased slot in the newest sector
+                slot_ = HISTORY_RECORDS_PER_SECTOR;
+                for (size_t slot = 0; slot < HISTORY_RECORDS_PER_SECTOR; slot++)
+                {
+                    uint8_t type;
+                    if (!flash_->read(record_offset_(sector_, slot), &type, 1))
+                        return false;
+                    if (type == 0xFF)
+                    {
+                        slot_ = slot;
+                        break;
+                    }
+                }
+                ready_ = true;
+                return true;
+            }
+
+            // Queues a record; the batch is written once HISTORY_BATCH_RECORDS are pending.
+            // While flash keeps failing the batch stays full and new records are dropped.
+            void append(HistoryRecord record)
+            {
+                if (!ready_)
+                    return;
+                if (pending_ == HISTORY_BATCH_RECORDS && !flush())
+                {
+                    dropped_++;
+                    return;
+                }
+                record.check = checksum(record);
+                batch_[pending_++] = record;
+                if (pending_ == HISTORY_BATCH_RECORDS)
+                    flush();
+            }
+
+            // Writes the pending records. On failure the ones already written leave the
+            // batch and the rest are retried next time, into the same slots.
+            bool flush()
+            {
+                if (!ready_)
+                    return false;
+                size_t written = 0;
+                bool ok = true;
+                while (written < pending_)
+                {
+                    if (slot_ == HISTORY_RECORDS_PER_SECTOR && !start_sector_((sector_ + 1) % sector_count_, sequence_ + 1))
+                    {
+                        ok = false;
+                        break;
+                    }
+                    size_t run = pending_ - written;
+                    if (run > HISTORY_RECORDS_PER_SECTOR - slot_)
+                        run = HISTORY_RECORDS_PER_SECTOR - slot_;
+                    if (!flash_->write(record_offset_(sector_, slot_), &batch_[written], run * HISTORY_RECORD_SIZE))
+                    {
+                        ok = false;
+                        break;
+                    }
+                    writes_++;
+                    slot_ += run;
+                    written += run;
+                    records_ += run;
+                }
+                pending_ -= written;
+                if (pending_ > 0 && written > 0)
+                    memmove(&batch_[0], &batch_[written], pending_ * sizeof(HistoryRecord));
+                return ok;
+            }
+
+            static uint32_t checksum(const HistoryRecord &record)
+            {
+                const uint8_t *bytes = reinterpret_cast<const uint8_t *>(&record);
+                uint32_t hash = 2166136261UL; // FNV-1a
+                for (size_t i = 0; i < offsetof(HistoryRecord, check); i++)
+                {
+                    hash ^= bytes[i];
+                    hash *= 16777619UL;
+                }
+                return hash;
+            }
+
+            bool is_ready() const { return ready_; }
+            size_t get_sector_count() const { return sector_count_; }
+            size_t get_pending() const { return pending_; }
+            uint32_t get_records() const { return records_; }
+            uint32_t get_writes() const { return writes_; }
+            uint32_t get_erases() const { return erases_; }
+            uint32_t get_dropped() const { return dropped_; }
+
+        protected:
+            struct SectorHeader
+            {
+                uint32_t magic;
+                uint32_t sequence;
+                uint8_t version;
+                uint8_t reserved[HISTORY_RECORD_SIZE - 9];
+            };
+
+            static size_t record_offset_(size_t sector, size_t slot)
+            {
+                return sector * HISTORY_SECTOR_SIZE + (slot + 1) * HISTORY_RECORD_SIZE;
+            }
+
+            bool start_sector_(size_t sector, uint32_t sequence)
+            {
+                SectorHeader header;
+                memset(&header, 0xFF, sizeof(header));
+                header.magic = HISTORY_MAGIC;
+                header.sequence = sequence;
+                header.version = HISTORY_VERSION;
+                if (!flash_->erase_sector(sector * HISTORY_SECTOR_SIZE) ||
+                    !flash_->write(sector * HISTORY_SECTOR_SIZE, &header, sizeof(header)))
+                {
+                    ready_ = false;
+                    return false;
+                }
+                erases_++;
+                sector_ = sector;
+                sequence_ = sequence;
+                slot_ = 0;
+                ready_ = true;
+                return true;
+            }
+
+            FlashRegion *flash_ = nullptr;
+            bool ready_ = false;
+            size_t sector_count_ = 0;
+            size_t sector_ = 0;
+            size_t slot_ = 0;
+            uint32_t sequence_ = 0;
+            HistoryRecord batch_[HISTORY_BATCH_RECORDS];
+            size_t pending_ = 0;
+            uint32_t records_ = 0;
+            uint32_t writes_ = 0;
+            uint32_t erases_ = 0;
+            uint32_t dropped_ = 0;
+        };
+
+    } // namespace esphiBoost
+} // namespace esphome
@@ -0,0 +1,179 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include "frame_schema.h"
+
+// iBoost radio frame layouts and a decoder that works directly on the received
+// bytes. Nothing in here allocates or depends on ESPHome, so it is safe to call
+// from the radio callback for every frame. Field offsets live only in the
+// schemas below; adding a field means adding a member and a schema entry.
+
+namespace esphome
+{
+    namespace esphiBoost
+    {
+
+        // Request and response codes for iBoost data queries
+        enum DataRequestCodes
+        {
+            DATA_REQUEST_TODAY = 0xCA,        // Request today's energy savings
+            DATA_REQUEST_YESTERDAY = 0xCB,    // Request yesterday's energy savings
+            DATA_REQUEST_LAST_7_DAYS = 0xCC,  // Request last 7 days energy savings
+            DATA_REQUEST_LAST_28_DAYS = 0xCD, // Request last 28 days energy savings
+            DATA_REQUEST_TOTAL = 0xCE         // Request total energy savings
+        };
+
+        // Packet type identifiers for different device types in the iBoost system
+        enum PacketTypes
+        {
+            PACKET_TYPE_SENDER = 0x01, // Sender unit packet (value: 1)
+            PACKET_TYPE_BUDDY = 0x21,  // Buddy unit packet (value: 33) - indicates buddy is running
+            PACKET_TYPE_IBOOST = 0x22  // iBoost main unit packet (value: 34)
+        };
+
+        // Frame length limits (the radio strips the length byte)
+        static constexpr size_t FRAME_HEADER_LENGTH = 3; // addr0 + addr1 + packet_type
+        static constexpr size_t FRAME_MIN_LENGTH = 10;
+        static constexpr size_t FRAME_MAX_LENGTH = 62;
+        static constexpr size_t IBOOST_FRAME_MIN_LENGTH = 28;
+        static constexpr size_t BUDDY_FRAME_MIN_LENGTH = 28;
+        static constexpr size_t SENDER_FRAME_MIN_LENGTH = 44;
+
+        struct IBoostFrame
+        {
+            uint8_t boost_time;         // minutes remaining on a manual boost
+            bool water_heating;
+            bool cylinder_hot;
+            bool overheated;
+            int16_t power_sent_to_tank; // W
+            int32_t import_raw;         // grid import, divide by 360 for W
+            uint8_t data_code;          // DataRequestCodes answered by data_value
+            int32_t data_value;         // Wh
+        };
+
+        struct SenderFrame
+        {
+            bool battery_low;
+            int32_t import_raw; // grid import, divide by 360 for W; offset inferred, see SenderImportCheck
+        };
+
+        // Buddy (0x21) control frame as sent by this component
+        struct BuddyControlFrame
+        {
+            uint8_t address0;
+            uint8_t address1;
+            uint8_t command;       // BuddyCommands
+            uint8_t request_code;  // DataRequestCodes the reply should carry
+            uint8_t boost_minutes; // 0 for data requests and boost cancel
+        };
+
+        enum BuddyCommands
+        {
+            BUDDY_COMMAND_REQUEST_DATA = 0x08, // request group data
+            BUDDY_COMMAND_SET_BOOST = 0x18,    // set boost time
+        };
+
+        static constexpr size_t BUDDY_CONTROL_FRAME_LENGTH = 29;
+        using BuddyControlBuffer = std::array<uint8_t, BUDDY_CONTROL_FRAME_LENGTH>;
+
+        // Plain decoded view of one radio frame; only the member matching `type` is filled in
+        struct DecodedFrame
+        {
+            uint8_t address0;
+            uint8_t address1;
+            uint8_t type;
+            uint8_t length;
+            union
+            {
+                IBoostFrame iboost;
+                SenderFrame sender;
+            };
+        };
+
+        // Frame schemas: member, byte offset, codec
+
+        using FrameHeaderSchema = FrameSchema<
+            Field<&DecodedFrame::address0, 0, CodecU8>,
+            Field<&DecodedFrame::address1, 1, CodecU8>,
+            Field<&DecodedFrame::type, 2, CodecU8>>;
+
+        using IBoostFrameSchema = FrameSchema<
+            Field<&IBoostFrame::boost_time, 5, CodecU8>,             // manual boost minutes remaining
+            Field<&IBoostFrame::water_heating, 6, CodecFlagZero>,    // 0 while the element is heating
+            Field<&IBoostFrame::cylinder_hot, 7, CodecFlagNonZero>,  // tank up to temperature
+            Field<&IBoostFrame::overheated, 13, CodecFlagNonZero>,
+            Field<&IBoostFrame::power_sent_to_tank, 16, CodecI16LE>,
+            Field<&IBoostFrame::import_raw, 18, CodecI32LE>,
+            Field<&IBoostFrame::data_code, 24, CodecU8>,
+            Field<&IBoostFrame::data_value, 25, CodecI32LETail>>;    // minimum-length frames end one byte in
+
+        using SenderFrameSchema = FrameSchema<
+            Field<&SenderFrame::battery_low, 12, CodecFlagOne>,
+            Field<&SenderFrame::import_raw, 18, CodecI32LE>>;       // same place as in the iBoost frame
+
+        using BuddyControlSchema = FrameSchema<
+            Field<&BuddyControlFrame::address0, 0, CodecU8>,
+            Field<&BuddyControlFrame::address1, 1, CodecU8>,
+            Fixed<2, PACKET_TYPE_BUDDY>,
+            Field<&BuddyControlFrame::command, 3, CodecU8>,
+            Fixed<4, 0x92>,
+            Fixed<5, 0x07>,
+            Fixed<8, 0x24>,
+            Fixed<10, 0xA0>,
+            Fixed<11, 0xA0>,
+            Field<&BuddyControlFrame::request_code, 12, CodecU8>,
+            Fixed<14, 0xA0>,
+            Fixed<15, 0xA0>,
+            Fixed<16, 0xC8>,
+            Field<&BuddyControlFrame::boost_minutes, 17, CodecU8>>;
+
+        static_assert(FrameHeaderSchema::MIN_LENGTH == FRAME_HEADER_LENGTH, "header schema out of step");
+        static_assert(IBoostFrameSchema::MIN_LENGTH <= IBOOST_FRAME_MIN_LENGTH, "iBoost schema reads past a minimum frame");
+        static_assert(SenderFrameSchema::MIN_LENGTH <= SENDER_FRAME_MIN_LENGTH, "Sender schema reads past a minimum frame");
+
+        enum DecodeResult
+        {
+            DECODE_OK = 0,
+            DECODE_TOO_SHORT,      // shorter than the header, or than the frame type requires
+            DECODE_INVALID_LENGTH, // outside FRAME_MIN_LENGTH..FRAME_MAX_LENGTH
+            DECODE_UNKNOWN_TYPE,
+        };
+
+        inline DecodeResult decode_frame(const uint8_t *data, size_t length, DecodedFrame &out)
+        {
+            out.length = static_cast<uint8_t>(length);
+            if (length < FRAME_HEADER_LENGTH)
+                return DECODE_TOO_SHORT;
+
+            FrameHeaderSchema::decode(data, length, out);
+
+            if (length < FRAME_MIN_LENGTH || length > FRAME_MAX_LENGTH)
+                return DECODE_INVALID_LENGTH;
+
+            switch (out.type)
+            {
+            case PACKET_TYPE_IBOOST:
+                if (length < IBOOST_FRAME_MIN_LENGTH)
+                    return DECODE_TOO_SHORT;
+                IBoostFrameSchema::decode(data, length, out.iboost);
+                return DECODE_OK;
+            case PACKET_TYPE_BUDDY:
+                return length < BUDDY_FRAME_MIN_LENGTH ? DECODE_TOO_SHORT : DECODE_OK;
+            case PACKET_TYPE_SENDER:
+                if (length < SENDER_FRAME_MIN_LENGTH)
+                    return DECODE_TOO_SHORT;
+                SenderFrameSchema::decode(data, length, out.sender);
+                return DECODE_OK;
+            default:
+                return DECODE_UNKNOWN_TYPE;
+            }
+        }
+
+        inline void encode_control_frame(const BuddyControlFrame &frame, BuddyControlBuffer &out)
+        {
+            BuddyControlSchema::encode(out, frame);
+        }
+
+    } // namespace esphiBoost
+} // namespace esphome
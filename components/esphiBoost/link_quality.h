@@ -0,0 +1,195 @@
+#pragma once
+#include <cmath>
+#include <cstdint>
+
+namespace esphome
+{
+    namespace esphiBoost
+    {
+
+        // Exponentially weighted RSSI average shared by the link estimator and the
+        // per-system table; NAN until the first sample
+        static constexpr float LINK_RSSI_ALPHA = 0.125f;
+
+        inline float link_rssi_average(float average, float rssi)
+        {
+            return std::isnan(average) ? rssi : average + LINK_RSSI_ALPHA * (rssi - average);
+        }
+
+        // What one unit's link looked like since the previous take_window()
+        struct LinkWindow
+        {
+            uint32_t received = 0;
+            uint32_t missed = 0;
+            float rssi_min = NAN;
+            float rssi_max = NAN;
+
+            // Share of the expected frames that never arrived, NAN when none were expected
+            float loss_percent() const
+            {
+                uint32_t expected = received + missed;
+                return expected == 0 ? NAN : 100.0f * missed / expected;
+            }
+        };
+
+        // Link quality of one transmitter, updated in O(1) per frame. The units send on
+        // a fixed period that is learned from the inter-arrival times. Learning starts
+        // again from any gap that disagrees with the estimate, so a reply heard just after
+        // a scheduled frame cannot set the period; loss is only counted once SETTLE_GAPS
+        // gaps in a row agree. After that, a gap spanning several periods counts the
+        // frames that should have been in it as missed and a frame well between two
+        // periods is an extra one. A run of RELEARN_GAPS gaps off the period relearns it.
+        class LinkQuality
+        {
+        public:
+            static constexpr float INTERVAL_ALPHA = 0.0625f;
+            static constexpr uint32_t MAX_MISSED_PER_GAP = 60; // longer silences are outages, not loss
+            static constexpr uint8_t SETTLE_GAPS = 4;
+            static constexpr uint8_t RELEARN_GAPS = 4;
+            static constexpr uint32_t MIN_TOLERANCE_MS = 60; // loop() latency
+            static constexpr float MAX_JITTER_SHARE = 0.1f;  // gaps further off than this disagree
+
+            void add(float rssi, uint32_t time_ms)
+            {
+                rssi_average_ = link_rssi_average(rssi_average_, rssi);
+                if (window_.received == 0 || rssi < window_.rssi_min)
+                    window_.rssi_min = rssi;
+                if (window_.received == 0 || rssi > window_.rssi_max)
+                    window_.rssi_max = rssi;
+                window_.received++;
+
+                if (!has_last_)
+                {
+                    anchor_(time_ms);
+                    return;
+                }
+                uint32_t gap = time_ms - last_ms_;
+                if (!settled_)
+                {
+                    learn_(gap);
+                    anchor_(time_ms);
+                    return;
+                }
+                // Off the schedule (a reply to our own request, say): the next gap is
+                // still measured from the last frame on it
+                if (gap < interval_ms_ / 2)
+                    return;
+
+                uint32_t missed = missed_in_(gap);
+                float single = static_cast<float>(gap) / (missed + 1);
+                float deviation = std::fabs(single - interval_ms_);
+                if (deviation > tolerance_())
+                {
+                    if (++disagreeing_ >= RELEARN_GAPS)
+                    {
+                        relearn_(gap);
+                        anchor_(time_ms);
+                        return;
+                    }
+                }
+                else
+                {
+                    disagreeing_ = 0;
+                    // A gap of several periods trains the period too; only single-period gaps train the jitter
+                    if (missed < MAX_MISSED_PER_GAP)
+                        interval_ms_ += INTERVAL_ALPHA * (single - interval_ms_);
+                    if (missed == 0)
+                        jitter_ms_ += INTERVAL_ALPHA * (deviation - jitter_ms_);
+                }
+                if (missed > charged_)
+                    window_.missed += missed - charged_;
+                anchor_(time_ms);
+            }
+
+            // Closes the current window. Frames already overdue count as missed now,
+            // and are not counted again when the gap finally ends.
+            LinkWindow take_window(uint32_t now)
+            {
+                if (has_last_)
+                {
+                    uint32_t overdue = missed_in_(now - last_ms_);
+                    if (overdue > charged_)
+                    {
+                        window_.missed += overdue - charged_;
+                        charged_ = overdue;
+                    }
+                }
+                LinkWindow window = window_;
+                window_ = LinkWindow{};
+                return window;
+            }
+
+            float get_rssi_average() const { return rssi_average_; }
+            float get_interval_ms() const { return interval_ms_; }
+            float get_jitter_ms() const { return jitter_ms_; }
+            bool has_samples() const { return has_last_; }
+            bool is_settled() const { return settled_; }
+
+        protected:
+            void anchor_(uint32_t time_ms)
+            {
+                has_last_ = true;
+                last_ms_ = time_ms;
+                charged_ = 0;
+            }
+
+            void learn_(uint32_t gap)
+            {
+                float deviation = std::fabs(gap - interval_ms_);
+                if (interval_ms_ <= 0.0f || deviation > tolerance_())
+                {
+                    relearn_(gap);
+                    return;
+                }
+                interval_ms_ += INTERVAL_ALPHA * (gap - interval_ms_);
+                jitter_ms_ += INTERVAL_ALPHA * (deviation - jitter_ms_);
+                if (++agreeing_ >= SETTLE_GAPS)
+                    settled_ = true;
+            }
+
+            // Starts learning again from this gap
+            void relearn_(uint32_t gap)
+            {
+                settled_ = false;
+                agreeing_ = 0;
+                disagreeing_ = 0;
+                interval_ms_ = gap;
+                jitter_ms_ = 0.0f;
+            }
+
+            float tolerance_() const { return std::fmax(static_cast<float>(MIN_TOLERANCE_MS), interval_ms_ * MAX_JITTER_SHARE); }
+
+            // Frames expected but not heard in a gap: round(gap / period) - 1, none until the period has settled
+            uint32_t missed_in_(uint32_t gap) const
+            {
+                if (!settled_)
+                    return 0;
+                float periods = gap / interval_ms_ - 0.5f;
+                if (periods < 1.0f)
+                    return 0;
+                return periods > MAX_MISSED_PER_GAP ? MAX_MISSED_PER_GAP : static_cast<uint32_t>(periods);
+            }
+
+            bool has_last_ = false;
+            bool settled_ = false;
+            uint8_t agreeing_ = 0;    // gaps in a row that agreed while learning
+            uint8_t disagreeing_ = 0; // gaps in a row off the settled period
+            uint32_t last_ms_ = 0;
+            uint32_t charged_ = 0; // frames of the current gap already counted as missed
+            float rssi_average_ = NAN;
+            float interval_ms_ = 0.0f;
+            float jitter_ms_ = 0.0f;
+            LinkWindow window_;
+        };
+
+        // Units whose links are tracked
+        enum LinkUnit
+        {
+            LINK_IBOOST = 0,
+            LINK_BUDDY,
+            LINK_SENDER,
+            LINK_UNIT_COUNT,
+        };
+
+    } // namespace esphiBoost
+} // namespace esphome
@@ -0,0 +1,111 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include "iboost_protocol.h"
+
+namespace esphome
+{
+    namespace esphiBoost
+    {
+
+        // Capture dump format, all integers little-endian:
+        //   header  "IBCP", u8 version, u8 reserved, u16 record count,
+        //           u32 frames seen since boot, u32 device millis() at dump time
+        //   record  u32 millis() at receive, i16 RSSI in 0.1 dB, u8 frame length,
+        //           u8 bytes captured, then the captured bytes
+        // Records are oldest first. tools/iboost_capture.py reads this format.
+        static constexpr uint8_t CAPTURE_FORMAT_VERSION = 1;
+        static constexpr size_t CAPTURE_HEADER_SIZE = 16;
+        static constexpr size_t CAPTURE_RECORD_HEADER_SIZE = 8;
+
+        // Fixed-size ring of the most recent raw frames. Storage is allocated once
+        // when the size is configured; recording is a bounded copy into the next slot
+        // and the oldest frame is overwritten when full.
+        class PacketCapture
+        {
+        public:
+            void set_size(size_t frames)
+            {
+                records_.assign(frames, Record{});
+                next_ = 0;
+                stored_ = 0;
+            }
+
+            size_t get_size() const { return records_.size(); }
+            size_t get_stored() const { return stored_; }
+            uint32_t get_seen() const { return seen_; }
+
+            void record(const uint8_t *data, size_t length, float rssi, uint32_t now)
+            {
+                seen_++;
+                if (records_.empty())
+                    return;
+                Record &record = records_[next_];
+                record.time_ms = now;
+                record.rssi_decibels_x10 = static_cast<int16_t>(rssi * 10.0f);
+                record.length = length > 0xFF ? 0xFF : static_cast<uint8_t>(length);
+                record.captured = length > FRAME_MAX_LENGTH ? FRAME_MAX_LENGTH : static_cast<uint8_t>(length);
+                memcpy(record.data, data, record.captured);
+                next_ = next_ + 1 == records_.size() ? 0 : next_ + 1;
+                if (stored_ < records_.size())
+                    stored_++;
+            }
+
+            // Serialises the ring into `out` in the dump format above
+            void dump(std::vector<uint8_t> &out, uint32_t now) const
+            {
+                out.clear();
+                out.reserve(CAPTURE_HEADER_SIZE + stored_ * (CAPTURE_RECORD_HEADER_SIZE + FRAME_MAX_LENGTH));
+                const uint8_t magic[4] = {'I', 'B', 'C', 'P'};
+                out.insert(out.end(), magic, magic + sizeof(magic));
+                out.push_back(CAPTURE_FORMAT_VERSION);
+                out.push_back(0);
+                put_le16_(out, static_cast<uint16_t>(stored_));
+                put_le32_(out, seen_);
+                put_le32_(out, now);
+
+                size_t index = (next_ + records_.size() - stored_) % (records_.empty() ? 1 : records_.size());
+                for (size_t i = 0; i < stored_; i++)
+                {
+                    const Record &record = records_[index];
+                    put_le32_(out, record.time_ms);
+                    put_le16_(out, static_cast<uint16_t>(record.rssi_decibels_x10));
+                    out.push_back(record.length);
+                    out.push_back(record.captured);
+                    out.insert(out.end(), record.data, record.data + record.captured);
+                    index = index + 1 == records_.size() ? 0 : index + 1;
+                }
+            }
+
+        protected:
+            struct Record
+            {
+                uint32_t time_ms = 0;
+                int16_t rssi_decibels_x10 = 0;
+                uint8_t length = 0;   // length as received
+                uint8_t captured = 0; // bytes kept, capped at FRAME_MAX_LENGTH
+                uint8_t data[FRAME_MAX_LENGTH] = {};
+            };
+
+            static void put_le16_(std::vector<uint8_t> &out, uint16_t value)
+            {
+                out.push_back(value & 0xFF);
+                out.push_back(value >> 8);
+            }
+
+            static void put_le32_(std::vector<uint8_t> &out, uint32_t value)
+            {
+                put_le16_(out, value & 0xFFFF);
+                put_le16_(out, value >> 16);
+            }
+
+            std::vector<Record> records_;
+            size_t next_ = 0;
+            size_t stored_ = 0;
+            uint32_t seen_ = 0;
+        };
+
+    } // namespace esphiBoost
+} // namespace esphome
@@ -0,0 +1,112 @@
+#pragma once
+#include <cmath>
+#include <cstdint>
+
+namespace esphome
+{
+    namespace esphiBoost
+    {
+
+        // Rules deciding when a sensor value is worth publishing again
+        struct PublishPolicy
+        {
+            float deadband = 0.0f;         // numeric changes no larger than this are treated as unchanged
+            uint32_t min_interval_ms = 0;  // never publish a sensor more often than this
+            uint32_t max_interval_ms = 0;  // republish an unchanged value after this long (0 = never)
+        };
+
+        // Sensors sharing a unit share a policy; a deadband in watts means nothing in dB
+        enum PublishClass
+        {
+            PUBLISH_CLASS_POWER = 0, // W
+            PUBLISH_CLASS_ENERGY,    // Wh
+            PUBLISH_CLASS_SIGNAL,    // dB
+            PUBLISH_CLASS_PERCENT,   // %
+            PUBLISH_CLASS_DURATION,  // minutes and ms
+            PUBLISH_CLASS_TEXT,      // deadband unused
+            PUBLISH_CLASS_COUNT,
+        };
+
+        // Flicker in power and signal readings is held back; counters publish every change
+        inline PublishPolicy default_publish_policy(PublishClass publish_class)
+        {
+            PublishPolicy policy;
+            switch (publish_class)
+            {
+            case PUBLISH_CLASS_POWER:
+                policy.deadband = 10.0f;
+                break;
+            case PUBLISH_CLASS_SIGNAL:
+                policy.deadband = 1.0f;
+                break;
+            case PUBLISH_CLASS_PERCENT:
+                policy.deadband = 0.5f;
+                break;
+            default:
+                break;
+            }
+            return policy;
+        }
+
+        // Per-sensor publish cache: remembers what was last sent and when, and counts
+        // how many publishes it held back
+        class PublishFilter
+        {
+        public:
+            bool should_publish(float value, uint32_t now, const PublishPolicy &policy)
+            {
+                bool changed = !has_value_ || std::fabs(value - last_value_) > policy.deadband;
+                if (!admit_(changed, now, policy))
+                    return false;
+                last_value_ = value;
+                return true;
+            }
+
+            // Text values are compared by hash so the cache holds no string
+            bool should_publish(const char *text, uint32_t now, const PublishPolicy &policy)
+            {
+                uint32_t hash = hash_text_(text);
+                bool changed = !has_value_ || hash != last_hash_;
+                if (!admit_(changed, now, policy))
+                    return false;
+                last_hash_ = hash;
+                return true;
+            }
+
+            uint32_t get_suppressed() const { return suppressed_; }
+
+        protected:
+            bool admit_(bool changed, uint32_t now, const PublishPolicy &policy)
+            {
+                uint32_t since_last = now - last_publish_ms_;
+                bool due = has_value_ && policy.max_interval_ms > 0 && since_last >= policy.max_interval_ms;
+                if ((!changed && !due) || (has_value_ && since_last < policy.min_interval_ms))
+                {
+                    suppressed_++;
+                    return false;
+                }
+                has_value_ = true;
+                last_publish_ms_ = now;
+                return true;
+            }
+
+            static uint32_t hash_text_(const char *text)
+            {
+                uint32_t hash = 2166136261UL; // FNV-1a
+                while (*text)
+                {
+                    hash ^= static_cast<uint8_t>(*text++);
+                    hash *= 16777619UL;
+                }
+                return hash;
+            }
+
+            bool has_value_ = false;
+            float last_value_ = 0.0f;
+            uint32_t last_hash_ = 0;
+            uint32_t last_publish_ms_ = 0;
+            uint32_t suppressed_ = 0;
+        };
+
+    } // namespace esphiBoost
+} // namespace esphome
@@ -0,0 +1,185 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include "iboost_protocol.h"
+
+namespace esphome
+{
+    namespace esphiBoost
+    {
+
+        // Why the scheduler did (or did not) pick a code on a given tick
+        enum ScheduleDecision
+        {
+            SCHEDULE_IDLE = 0,    // every code is fresher than its interval
+            SCHEDULE_DUE,         // a code was overdue and was picked
+            SCHEDULE_PROBE,       // suspended, but sending an occasional probe
+            SCHEDULE_SUSPENDED,   // no iBoost reply seen recently; not transmitting
+        };
+
+        // Picks which energy counter to request next. Each code keeps its own polling
+        // interval that halves when the value is seen to change and grows while it
+        // stays the same, bounded per code. Replies to anyone's request (including
+        // a real Buddy's) count as fresh data.
+        class RequestScheduler
+        {
+        public:
+            static constexpr size_t CODE_COUNT = 5;
+            static constexpr uint32_t SUSPEND_AFTER_MS = 120000; // no iBoost frame for this long suspends polling
+            static constexpr uint32_t PROBE_INTERVAL_MS = 60000; // while suspended, probe this often
+
+            struct Slot
+            {
+                uint8_t code;
+                uint32_t min_interval_ms;
+                uint32_t max_interval_ms;
+                uint32_t interval_ms = 0;
+                uint32_t last_request_ms = 0;
+                uint32_t last_reply_ms = 0;
+                int32_t last_value = 0;
+                bool requested = false;
+                bool replied = false;
+                uint16_t changes = 0;
+            };
+
+            RequestScheduler()
+                : slots_{
+                      {DATA_REQUEST_TODAY, 10000, 60000},
+                      {DATA_REQUEST_YESTERDAY, 60000, 3600000},
+                      {DATA_REQUEST_LAST_7_DAYS, 60000, 3600000},
+                      {DATA_REQUEST_LAST_28_DAYS, 60000, 3600000},
+                      {DATA_REQUEST_TOTAL, 30000, 600000},
+                  }
+            {
+                for (auto &slot : slots_)
+                    slot.interval_ms = slot.min_interval_ms;
+            }
+
+            // Returns the code to request now, or 0 when nothing should be sent
+            uint8_t next_request(uint32_t now)
+            {
+                if (!started_)
+                {
+                    started_ = true;
+                    last_iboost_ms_ = now;
+                }
+
+                if (now - last_iboost_ms_ >= SUSPEND_AFTER_MS)
+                {
+                    if (now - last_probe_ms_ < PROBE_INTERVAL_MS)
+                        return decide_(SCHEDULE_SUSPENDED, 0);
+                    last_probe_ms_ = now;
+                    return decide_(SCHEDULE_PROBE, DATA_REQUEST_TODAY);
+                }
+
+                // Most overdue code relative to its own interval wins
+                Slot *best = nullptr;
+                uint32_t best_score = 0;
+                for (auto &slot : slots_)
+                {
+                    if (slot.requested)
+                        continue; // still in flight; RequestTracker handles retries
+                    uint32_t age = slot.replied ? now - slot.last_reply_ms : slot.interval_ms;
+                    if (age < slot.interval_ms)
+                        continue;
+                    uint32_t score = static_cast<uint32_t>((static_cast<uint64_t>(age) * 1000) / slot.interval_ms);
+                    if (best == nullptr || score > best_score)
+                    {
+                        best = &slot;
+                        best_score = score;
+                    }
+                }
+                if (best == nullptr)
+                    return decide_(SCHEDULE_IDLE, 0);
+                return decide_(SCHEDULE_DUE, best->code);
+            }
+
+            void on_request_sent(uint8_t code, uint32_t now)
+            {
+                Slot *slot = find_(code);
+                if (slot == nullptr)
+                    return;
+                slot->requested = true;
+                slot->last_request_ms = now;
+            }
+
+            // The request went unanswered after every retry; make the code eligible again
+            void on_request_lost(uint8_t code)
+            {
+                Slot *slot = find_(code);
+                if (slot != nullptr)
+                    slot->requested = false;
+            }
+
+            // Any iBoost frame proves the unit is listening
+            void on_iboost_frame(uint32_t now)
+            {
+                last_iboost_ms_ = now;
+                started_ = true;
+            }
+
+            void on_reply(uint8_t code, int32_t value, uint32_t now)
+            {
+                Slot *slot = find_(code);
+                if (slot == nullptr)
+                    return;
+                if (slot->replied && value != slot->last_value)
+                {
+                    slot->changes++;
+                    slot->interval_ms = slot->interval_ms / 2 < slot->min_interval_ms ? slot->min_interval_ms : slot->interval_ms / 2;
+                }
+                else if (slot->replied)
+                {
+                    uint32_t grown = slot->interval_ms + slot->interval_ms / 2;
+                    slot->interval_ms = grown > slot->max_interval_ms ? slot->max_interval_ms : grown;
+                }
+                slot->last_value = value;
+                slot->last_reply_ms = now;
+                slot->replied = true;
+                slot->requested = false;
+            }
+
+            // Replace a code's polling bounds, e.g. when its value can be estimated between polls
+            void set_interval_bounds(uint8_t code, uint32_t min_interval_ms, uint32_t max_interval_ms)
+            {
+                Slot *slot = find_(code);
+                if (slot == nullptr)
+                    return;
+                slot->min_interval_ms = min_interval_ms;
+                slot->max_interval_ms = max_interval_ms;
+                slot->interval_ms = min_interval_ms;
+            }
+
+            ScheduleDecision get_last_decision() const { return last_decision_; }
+            uint8_t get_last_code() const { return last_code_; }
+            uint32_t get_silence_ms(uint32_t now) const { return now - last_iboost_ms_; }
+            const Slot *get_slots() const { return slots_; }
+
+        protected:
+            uint8_t decide_(ScheduleDecision decision, uint8_t code)
+            {
+                last_decision_ = decision;
+                last_code_ = code;
+                return code;
+            }
+
+            Slot *find_(uint8_t code)
+            {
+                for (auto &slot : slots_)
+                {
+                    if (slot.code == code)
+                        return &slot;
+                }
+                return nullptr;
+            }
+
+            Slot slots_[CODE_COUNT];
+            bool started_ = false;
+            uint32_t last_iboost_ms_ = 0;
+            uint32_t last_probe_ms_ = 0;
+            ScheduleDecision last_decision_ = SCHEDULE_IDLE;
+            uint8_t last_code_ = 0;
+        };
+
+    } // namespace esphiBoost
+} // namespace esphome
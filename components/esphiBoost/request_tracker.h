@@ -0,0 +1,203 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include "request_scheduler.h"
+
+namespace esphome
+{
+    namespace esphiBoost
+    {
+
+        // Fixed-bucket round-trip latency histogram; percentiles are interpolated within a bucket
+        class LatencyHistogram
+        {
+        public:
+            static constexpr size_t BUCKET_COUNT = 11;
+
+            void record(uint32_t latency_ms)
+            {
+                size_t i = 0;
+                while (i < BUCKET_COUNT - 1 && latency_ms > BUCKET_UPPER_MS[i])
+                    i++;
+                counts_[i]++;
+                total_++;
+            }
+
+            uint32_t get_count() const { return total_; }
+
+            // percentile in 0..100; returns 0 while empty
+            float percentile(float percentile) const
+            {
+                if (total_ == 0)
+                    return 0.0f;
+                float target = total_ * percentile / 100.0f;
+                uint32_t seen = 0;
+                for (size_t i = 0; i < BUCKET_COUNT; i++)
+                {
+                    if (counts_[i] == 0)
+                        continue;
+                    if (seen + counts_[i] >= target)
+                    {
+                        float lower = i == 0 ? 0.0f : BUCKET_UPPER_MS[i - 1];
+                        float upper = BUCKET_UPPER_MS[i];
+                        return lower + (upper - lower) * (target - seen) / counts_[i];
+                    }
+                    seen += counts_[i];
+                }
+                return BUCKET_UPPER_MS[BUCKET_COUNT - 1];
+            }
+
+        protected:
+            // The last bucket catches everything up to the reply timeout
+            static constexpr uint32_t BUCKET_UPPER_MS[BUCKET_COUNT] = {20, 50, 100, 150, 200, 300, 500, 750, 1000, 1250, 1500};
+
+            uint32_t counts_[BUCKET_COUNT] = {};
+            uint32_t total_ = 0;
+        };
+
+        // In-flight table for data requests, keyed by request code. A 0x22 reply carrying
+        // the same code closes the entry; an entry that times out is retried after a
+        // jittered exponential backoff and counted as lost once the attempts run out.
+        // Replies can't be told apart from answers to another Buddy asking the same code,
+        // which at worst makes a latency sample look shorter than it was.
+        class RequestTracker
+        {
+        public:
+            static constexpr uint32_t REPLY_TIMEOUT_MS = 1500;
+            static constexpr uint32_t RETRY_BACKOFF_MS = 1000; // doubled for each further attempt
+            static constexpr uint32_t RETRY_JITTER_MS = 500;
+            static constexpr uint8_t MAX_ATTEMPTS = 3;
+
+            void on_sent(uint8_t code, uint32_t now)
+            {
+                Entry *entry = find_(code);
+                if (entry == nullptr)
+                    return;
+                if (entry->state == ENTRY_IDLE)
+                    entry->attempts = 0;
+                else
+                    retries_++;
+                entry->state = ENTRY_AWAITING_REPLY;
+                entry->attempts++;
+                entry->sent_ms = now;
+                entry->due_ms = now + REPLY_TIMEOUT_MS;
+                sent_++;
+            }
+
+            // Returns true if the reply matched an outstanding request. `now` is when the
+            // reply was received, which can predate a retry sent before it was handled;
+            // such a reply still closes the entry but gives no latency sample.
+            bool on_reply(uint8_t code, uint32_t now)
+            {
+                Entry *entry = find_(code);
+                if (entry == nullptr || entry->state == ENTRY_IDLE)
+                    return false;
+                if (entry->state == ENTRY_AWAITING_REPLY && static_cast<int32_t>(now - entry->sent_ms) >= 0)
+                    latency_.record(now - entry->sent_ms);
+                entry->state = ENTRY_IDLE;
+                answered_++;
+                return true;
+            }
+
+            // Advances timeouts. Returns a code that should be retransmitted now, or 0.
+            // `lost_code` is set when a request has used up its attempts.
+            uint8_t poll(uint32_t now, uint8_t &lost_code)
+            {
+                lost_code = 0;
+                for (auto &entry : entries_)
+                {
+                    if (entry.state == ENTRY_IDLE || static_cast<int32_t>(now - entry.due_ms) < 0)
+                        continue;
+                    if (entry.state == ENTRY_BACKOFF)
+                        return entry.code;
+
+                    // ENTRY_AWAITING_REPLY timed out
+                    if (entry.attempts >= MAX_ATTEMPTS)
+                    {
+                        entry.state = ENTRY_IDLE;
+                        lost_++;
+                        lost_code = entry.code;
+                        continue;
+                    }
+                    entry.state = ENTRY_BACKOFF;
+                    entry.due_ms = now + (RETRY_BACKOFF_MS << (entry.attempts - 1)) + next_jitter_();
+                }
+                return 0;
+            }
+
+            bool is_in_flight(uint8_t code) const
+            {
+                for (const auto &entry : entries_)
+                {
+                    if (entry.code == code)
+                        return entry.state != ENTRY_IDLE;
+                }
+                return false;
+            }
+
+            const LatencyHistogram &get_latency() const { return latency_; }
+            uint32_t get_sent() const { return sent_; }
+            uint32_t get_retries() const { return retries_; }
+            uint32_t get_answered() const { return answered_; }
+            uint32_t get_lost() const { return lost_; }
+
+            // Share of requests that were never answered, in percent
+            float get_loss_rate() const
+            {
+                uint32_t finished = answered_ + lost_;
+                return finished == 0 ? 0.0f : lost_ * 100.0f / finished;
+            }
+
+        protected:
+            // xorshift32; only needs to keep retries from two Buddies falling into lockstep
+            uint32_t next_jitter_()
+            {
+                jitter_state_ ^= jitter_state_ << 13;
+                jitter_state_ ^= jitter_state_ >> 17;
+                jitter_state_ ^= jitter_state_ << 5;
+                return jitter_state_ % RETRY_JITTER_MS;
+            }
+
+            enum EntryState : uint8_t
+            {
+                ENTRY_IDLE = 0,
+                ENTRY_AWAITING_REPLY,
+                ENTRY_BACKOFF,
+            };
+
+            struct Entry
+            {
+                uint8_t code;
+                EntryState state = ENTRY_IDLE;
+                uint8_t attempts = 0;
+                uint32_t sent_ms = 0;
+                uint32_t due_ms = 0; // reply deadline, or retry time while backing off
+            };
+
+            Entry *find_(uint8_t code)
+            {
+                for (auto &entry : entries_)
+                {
+                    if (entry.code == code)
+                        return &entry;
+                }
+                return nullptr;
+            }
+
+            Entry entries_[RequestScheduler::CODE_COUNT] = {
+                {DATA_REQUEST_TODAY},
+                {DATA_REQUEST_YESTERDAY},
+                {DATA_REQUEST_LAST_7_DAYS},
+                {DATA_REQUEST_LAST_28_DAYS},
+                {DATA_REQUEST_TOTAL},
+            };
+            LatencyHistogram latency_;
+            uint32_t sent_ = 0;
+            uint32_t retries_ = 0;
+            uint32_t answered_ = 0;
+            uint32_t lost_ = 0;
+            uint32_t jitter_state_ = 0x9E3779B9;
+        };
+
+    } // namespace esphiBoost
+} // namespace esphome
@@ -0,0 +1,104 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+namespace esphome
+{
+    namespace esphiBoost
+    {
+
+        // min / max / mean of the samples that fell into one period
+        struct RollupBucket
+        {
+            float min = 0.0f;
+            float max = 0.0f;
+            float sum = 0.0f;
+            uint16_t count = 0;
+
+            float mean() const { return count == 0 ? 0.0f : sum / count; }
+        };
+
+        // Fixed ring of SLOTS consecutive periods of PERIOD_MS, updated incrementally
+        // per sample. Periods are counted from boot on millis(), so bucket 0 is always
+        // the one in progress and bucket n the one n periods before it.
+        template <size_t SLOTS, uint32_t PERIOD_MS>
+        class Rollup
+        {
+        public:
+            static constexpr size_t SLOT_COUNT = SLOTS;
+            static constexpr uint32_t PERIOD = PERIOD_MS;
+
+            void add(float value, uint32_t now)
+            {
+                advance(now);
+                RollupBucket &bucket = buckets_[current_slot_];
+                if (bucket.count == 0)
+                {
+                    bucket.min = value;
+                    bucket.max = value;
+                }
+                else
+                {
+                    bucket.min = value < bucket.min ? value : bucket.min;
+                    bucket.max = value > bucket.max ? value : bucket.max;
+                }
+                bucket.sum += value;
+                if (bucket.count < UINT16_MAX)
+                    bucket.count++;
+            }
+
+            // Moves to the period containing `now`, clearing any periods that saw no samples
+            void advance(uint32_t now)
+            {
+                uint32_t period = now / PERIOD_MS;
+                uint32_t steps = period - current_period_;
+                if (steps == 0)
+                    return;
+                if (steps > SLOTS)
+                    steps = SLOTS;
+                for (uint32_t i = 0; i < steps; i++)
+                {
+                    current_slot_ = current_slot_ + 1 == SLOTS ? 0 : current_slot_ + 1;
+                    buckets_[current_slot_] = RollupBucket{};
+                }
+                current_period_ = period;
+            }
+
+            // age 0 is the current period
+            const RollupBucket &get(size_t age) const
+            {
+                return buckets_[(current_slot_ + SLOTS - age % SLOTS) % SLOTS];
+            }
+
+        protected:
+            RollupBucket buckets_[SLOTS];
+            size_t current_slot_ = 0;
+            uint32_t current_period_ = 0;
+        };
+
+        // Quantities rolled up per frame
+        enum RollupMetric
+        {
+            ROLLUP_POWER = 0,  // W sent to the tank
+            ROLLUP_IMPORT,     // W drawn from the grid
+            ROLLUP_RSSI_IBOOST,
+            ROLLUP_RSSI_BUDDY,
+            ROLLUP_RSSI_SENDER,
+            ROLLUP_METRIC_COUNT,
+        };
+
+        // One hour of minutes and one day of hours for each metric
+        struct Rollups
+        {
+            Rollup<60, 60000> minutes[ROLLUP_METRIC_COUNT];
+            Rollup<24, 3600000> hours[ROLLUP_METRIC_COUNT];
+
+            void add(RollupMetric metric, float value, uint32_t now)
+            {
+                minutes[metric].add(value, now);
+                hours[metric].add(value, now);
+            }
+        };
+
+    } // namespace esphiBoost
+} // namespace esphome
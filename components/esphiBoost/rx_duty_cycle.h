@@ -0,0 +1,224 @@
+#pragma once
+#include <cmath>
+#include <cstdint>
+#include "link_quality.h"
+
+namespace esphome
+{
+    namespace esphiBoost
+    {
+
+        // Transmit period and phase of one unit, learned from frame receive times. Once
+        // FRAMES_TO_LOCK gaps agree, the next frame is predicted at a whole number of
+        // periods after the last one. Every window that passes without a frame doubles
+        // the width of the next; after MAX_MISSED_WINDOWS the lock is dropped.
+        class RxPhase
+        {
+        public:
+            static constexpr uint8_t FRAMES_TO_LOCK = 4;
+            static constexpr uint8_t MAX_MISSED_WINDOWS = 4;
+            static constexpr uint32_t GUARD_MS = 60;           // loop() latency and radio wake-up
+            static constexpr float MAX_JITTER_SHARE = 0.1f;    // gaps further off than this never lock
+            static constexpr uint32_t MIN_PERIOD_MS = 1000;    // faster units are not worth sleeping for
+            static constexpr float PERIOD_ALPHA = 0.125f;
+
+            void reset() { *this = RxPhase{}; }
+
+            void on_frame(uint32_t time_ms)
+            {
+                if (!has_last_)
+                {
+                    anchor_(time_ms);
+                    return;
+                }
+                uint32_t since = time_ms - last_ms_;
+                if (period_ms_ <= 0.0f)
+                {
+                    period_ms_ = since;
+                    anchor_(time_ms);
+                    return;
+                }
+                uint32_t periods = periods_in_(since);
+                float single = static_cast<float>(since) / periods;
+                float deviation = std::fabs(single - period_ms_);
+                if (locked_)
+                {
+                    // Frames heard between windows (replies to our own requests, say) say
+                    // nothing about the schedule; only a run of them means it moved
+                    if (std::fabs(since - periods * period_ms_) > half_window_(periods - 1))
+                    {
+                        if (++off_phase_ >= FRAMES_TO_LOCK)
+                            unlock_(time_ms);
+                        return;
+                    }
+                }
+                else if (deviation > std::fmax(static_cast<float>(GUARD_MS), period_ms_ * MAX_JITTER_SHARE))
+                {
+                    // Start learning again from this gap
+                    consistent_ = 0;
+                    jitter_ms_ = 0.0f;
+                    period_ms_ = since;
+                    anchor_(time_ms);
+                    return;
+                }
+                period_ms_ += PERIOD_ALPHA * (single - period_ms_);
+                jitter_ms_ += PERIOD_ALPHA * (deviation - jitter_ms_);
+                if (!locked_ && ++consistent_ >= FRAMES_TO_LOCK && period_ms_ >= MIN_PERIOD_MS)
+                {
+                    locked_ = true;
+                    locks_++;
+                }
+                anchor_(time_ms);
+            }
+
+            // Milliseconds until the next predicted window opens, 0 inside one or while unlocked.
+            // A lock that has missed too many windows is dropped here.
+            uint32_t ms_until_window(uint32_t now)
+            {
+                if (!locked_)
+                    return 0;
+                uint32_t since = now - last_ms_;
+                uint32_t periods = periods_in_(since);
+                if (periods - 1 > MAX_MISSED_WINDOWS)
+                {
+                    unlock_(last_ms_);
+                    return 0;
+                }
+                float expected = periods * period_ms_;
+                float half = half_window_(periods - 1);
+                if (std::fabs(since - expected) <= half)
+                    return 0;
+                if (since < expected)
+                    return static_cast<uint32_t>(expected - half - since);
+                // Past this window: the next one, already wider for the miss
+                return static_cast<uint32_t>(expected + period_ms_ - half_window_(periods) - since);
+            }
+
+            bool is_locked() const { return locked_; }
+            bool has_frames() const { return has_last_; }
+            uint32_t get_last_ms() const { return last_ms_; }
+            float get_period_ms() const { return period_ms_; }
+            float get_jitter_ms() const { return jitter_ms_; }
+            uint32_t get_locks() const { return locks_; }
+            uint32_t get_unlocks() const { return unlocks_; }
+
+        protected:
+            void anchor_(uint32_t time_ms)
+            {
+                has_last_ = true;
+                last_ms_ = time_ms;
+                off_phase_ = 0;
+            }
+
+            void unlock_(uint32_t time_ms)
+            {
+                locked_ = false;
+                consistent_ = 0;
+                unlocks_++;
+                anchor_(time_ms);
+            }
+
+            // Whole periods in a gap, at least one
+            uint32_t periods_in_(uint32_t gap) const
+            {
+                uint32_t periods = static_cast<uint32_t>(gap / period_ms_ + 0.5f);
+                return periods < 1 ? 1 : periods;
+            }
+
+            // Half-width of a window after `missed` empty ones, never more than half a period
+            float half_window_(uint32_t missed) const
+            {
+                float half = GUARD_MS + 3.0f * jitter_ms_;
+                for (uint32_t i = 0; i < missed && half < period_ms_ / 2; i++)
+                    half *= 2;
+                return std::fmin(half, period_ms_ / 2);
+            }
+
+            bool has_last_ = false;
+            bool locked_ = false;
+            uint8_t consistent_ = 0; // agreeing gaps since learning (re)started
+            uint8_t off_phase_ = 0;  // frames outside the window since the last one inside
+            uint32_t last_ms_ = 0;
+            float period_ms_ = 0.0f;
+            float jitter_ms_ = 0.0f;
+            uint32_t locks_ = 0;
+            uint32_t unlocks_ = 0;
+        };
+
+        // Decides when the receiver may sleep: only while every unit heard recently is
+        // locked and none of their windows is close. Anything unexpected (a unit that is
+        // irregular or went quiet, or our own request awaiting a reply) keeps it listening.
+        class RxDutyCycle
+        {
+        public:
+            static constexpr uint32_t MIN_SLEEP_MS = 100;      // shorter gaps are not worth a mode change
+            static constexpr uint32_t UNIT_STALE_MS = 600000;  // units silent this long are ignored
+
+            void reset()
+            {
+                for (auto &phase : phases_)
+                    phase.reset();
+            }
+
+            void on_frame(LinkUnit unit, uint32_t time_ms) { phases_[unit].on_frame(time_ms); }
+
+            // Keep listening until `now + ms`, e.g. for the reply to a frame just sent
+            void hold_awake(uint32_t now, uint32_t ms)
+            {
+                if (!holding_ || static_cast<int32_t>(now + ms - hold_until_ms_) > 0)
+                    hold_until_ms_ = now + ms;
+                holding_ = true;
+            }
+
+            bool wants_rx(uint32_t now)
+            {
+                bool listen = wants_rx_(now);
+                if (has_state_)
+                    (listening_ ? listen_ms_ : sleep_ms_) += now - state_since_ms_;
+                has_state_ = true;
+                state_since_ms_ = now;
+                listening_ = listen;
+                return listen;
+            }
+
+            const RxPhase &get_phase(LinkUnit unit) const { return phases_[unit]; }
+            uint32_t get_listen_ms() const { return listen_ms_; }
+            uint32_t get_sleep_ms() const { return sleep_ms_; }
+
+        protected:
+            bool wants_rx_(uint32_t now)
+            {
+                if (holding_)
+                {
+                    if (static_cast<int32_t>(now - hold_until_ms_) < 0)
+                        return true;
+                    holding_ = false;
+                }
+                bool any_locked = false;
+                uint32_t until = UINT32_MAX;
+                for (auto &phase : phases_)
+                {
+                    if (!phase.has_frames() || now - phase.get_last_ms() > UNIT_STALE_MS)
+                        continue;
+                    uint32_t wait = phase.ms_until_window(now);
+                    if (!phase.is_locked())
+                        return true;
+                    any_locked = true;
+                    if (wait < until)
+                        until = wait;
+                }
+                return !any_locked || until < MIN_SLEEP_MS;
+            }
+
+            RxPhase phases_[LINK_UNIT_COUNT];
+            bool holding_ = false;
+            uint32_t hold_until_ms_ = 0;
+            bool has_state_ = false;
+            bool listening_ = true;
+            uint32_t state_since_ms_ = 0;
+            uint32_t listen_ms_ = 0;
+            uint32_t sleep_ms_ = 0;
+        };
+
+    } // namespace esphiBoost
+} // namespace esphome
@@ -0,0 +1,91 @@
+#pragma once
+#include <cmath>
+#include <cstdint>
+
+namespace esphome
+{
+    namespace esphiBoost
+    {
+
+        // The Sender's import field is located by analogy with the iBoost frame, which
+        // relays the same CT clamp reading, not from a documented layout. Its readings
+        // are therefore only published once several of them have matched the iBoost's
+        // own figure, and publishing stops again as soon as one no longer does. Pairs
+        // where both sides are below MIN_EVIDENCE_W count for nothing: a wrong field that
+        // reads zero would agree with a quiet grid connection for hours.
+        class SenderImportCheck
+        {
+        public:
+            static constexpr float LIMIT_W = 25000.0f;            // beyond a 100 A single-phase supply
+            static constexpr uint32_t PAIR_WINDOW_MS = 10000;     // Sender reading this recent is compared
+            static constexpr float TOLERANCE_W = 100.0f;          // or TOLERANCE_PERCENT, whichever is larger
+            static constexpr float TOLERANCE_PERCENT = 10.0f;
+            static constexpr uint8_t MATCHES_TO_TRUST = 3;
+            static constexpr float MIN_EVIDENCE_W = 500.0f;       // import or export this large on one side at least
+
+            enum Change : uint8_t
+            {
+                CHANGE_NONE = 0,
+                CHANGE_TRUSTED,
+                CHANGE_DISTRUSTED,
+            };
+
+            // A reading from a Sender frame; false if it cannot be a real import figure
+            bool on_sender(float watts, uint32_t time_ms)
+            {
+                if (std::isnan(watts) || std::fabs(watts) > LIMIT_W)
+                {
+                    implausible_++;
+                    return false;
+                }
+                last_w_ = watts;
+                last_ms_ = time_ms;
+                has_last_ = true;
+                return true;
+            }
+
+            // The iBoost's own import figure; compared with a Sender reading heard shortly before
+            Change on_iboost(float watts, uint32_t time_ms)
+            {
+                if (!has_last_ || time_ms - last_ms_ > PAIR_WINDOW_MS)
+                    return CHANGE_NONE;
+                has_last_ = false; // each Sender reading is compared once
+                if (std::fabs(watts) < MIN_EVIDENCE_W && std::fabs(last_w_) < MIN_EVIDENCE_W)
+                    return CHANGE_NONE;
+                float tolerance = std::fmax(TOLERANCE_W, std::fabs(watts) * TOLERANCE_PERCENT / 100.0f);
+                if (std::fabs(last_w_ - watts) <= tolerance)
+                {
+                    if (matches_ < MATCHES_TO_TRUST)
+                        matches_++;
+                    if (matches_ == MATCHES_TO_TRUST && !trusted_)
+                    {
+                        trusted_ = true;
+                        return CHANGE_TRUSTED;
+                    }
+                    return CHANGE_NONE;
+                }
+                matches_ = 0;
+                mismatches_++;
+                if (!trusted_)
+                    return CHANGE_NONE;
+                trusted_ = false;
+                return CHANGE_DISTRUSTED;
+            }
+
+            bool is_trusted() const { return trusted_; }
+            float get_last_w() const { return last_w_; }
+            uint32_t get_implausible() const { return implausible_; }
+            uint32_t get_mismatches() const { return mismatches_; }
+
+        protected:
+            float last_w_ = NAN;
+            uint32_t last_ms_ = 0;
+            bool has_last_ = false;
+            bool trusted_ = false;
+            uint8_t matches_ = 0;
+            uint32_t implausible_ = 0;
+            uint32_t mismatches_ = 0;
+        };
+
+    } // namespace esphiBoost
+} // namespace esphome
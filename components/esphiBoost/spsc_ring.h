@@ -0,0 +1,57 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace esphome
+{
+    namespace esphiBoost
+    {
+
+        // Lock-free ring of fixed-size slots for exactly one producer and one consumer,
+        // which may run on different cores. Slots are preallocated and items are copied
+        // in and out, so neither side ever allocates or waits. N must be a power of two.
+        template <typename T, size_t N>
+        class SpscRing
+        {
+            static_assert(N > 0 && (N & (N - 1)) == 0, "SpscRing size must be a power of two");
+
+        public:
+            static constexpr size_t CAPACITY = N;
+
+            // Producer side. Returns false, leaving the ring untouched, when it is full.
+            bool push(const T &item)
+            {
+                uint32_t head = head_.load(std::memory_order_relaxed);
+                if (head - tail_.load(std::memory_order_acquire) == N)
+                    return false;
+                slots_[head & (N - 1)] = item;
+                head_.store(head + 1, std::memory_order_release);
+                return true;
+            }
+
+            // Consumer side. Returns false when the ring is empty.
+            bool pop(T &item)
+            {
+                uint32_t tail = tail_.load(std::memory_order_relaxed);
+                if (tail == head_.load(std::memory_order_acquire))
+                    return false;
+                item = slots_[tail & (N - 1)];
+                tail_.store(tail + 1, std::memory_order_release);
+                return true;
+            }
+
+            // Items waiting; exact on either side, a snapshot from anywhere else
+            size_t size() const
+            {
+                return head_.load(std::memory_order_acquire) - tail_.load(std::memory_order_acquire);
+            }
+
+        protected:
+            T slots_[N]{};
+            std::atomic<uint32_t> head_{0}; // written by the producer only
+            std::atomic<uint32_t> tail_{0}; // written by the consumer only
+        };
+
+    } // namespace esphiBoost
+} // namespace esphome
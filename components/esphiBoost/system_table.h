@@ -0,0 +1,92 @@
+#pragma once
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+namespace esphome
+{
+    namespace esphiBoost
+    {
+
+        // What is known about one iBoost installation, keyed by the two address bytes
+        // every frame starts with
+        struct SystemState
+        {
+            uint16_t address = 0;
+            bool used = false;
+            bool reported = false;           // a frame from it was logged as ignored
+            bool sender_battery_low = false;
+            bool overheated = false;
+            float best_rssi = -1000.0f;      // dB, strongest frame heard
+            float rssi_average = NAN;        // dB, smoothed over its recent frames
+            uint32_t frames = 0;
+            uint32_t last_seen_ms = 0;
+        };
+
+        inline uint16_t system_address(uint8_t address0, uint8_t address1)
+        {
+            return static_cast<uint16_t>((address0 << 8) | address1);
+        }
+
+        // Fixed-capacity open-addressing table (linear probing) of every system heard.
+        // Entries are never removed, so pointers into the table stay valid.
+        class SystemTable
+        {
+        public:
+            static constexpr size_t CAPACITY = 8; // power of two
+
+            SystemState *find(uint16_t address)
+            {
+                size_t index = slot_(address);
+                for (size_t probe = 0; probe < CAPACITY; probe++)
+                {
+                    SystemState &entry = entries_[index];
+                    if (!entry.used)
+                        return nullptr;
+                    if (entry.address == address)
+                        return &entry;
+                    index = (index + 1) & (CAPACITY - 1);
+                }
+                return nullptr;
+            }
+
+            // Returns nullptr only when the table is full and `address` is not in it
+            SystemState *find_or_insert(uint16_t address)
+            {
+                size_t index = slot_(address);
+                for (size_t probe = 0; probe < CAPACITY; probe++)
+                {
+                    SystemState &entry = entries_[index];
+                    if (!entry.used)
+                    {
+                        entry.used = true;
+                        entry.address = address;
+                        count_++;
+                        return &entry;
+                    }
+                    if (entry.address == address)
+                        return &entry;
+                    index = (index + 1) & (CAPACITY - 1);
+                }
+                return nullptr;
+            }
+
+            size_t get_count() const { return count_; }
+            const SystemState *get_entries() const { return entries_; }
+
+        protected:
+            // Fibonacci hashing; neighbouring addresses land in different slots. The product
+            // is truncated to 32 bits first: unsigned long is 64 bits on LP64 hosts.
+            static size_t slot_(uint16_t address)
+            {
+                return static_cast<uint32_t>(address * 2654435769UL) >> (32 - 3);
+            }
+
+            static_assert(CAPACITY == 8, "slot_() shift assumes 8 entries");
+
+            SystemState entries_[CAPACITY];
+            size_t count_ = 0;
+        };
+
+    } // namespace esphiBoost
+} // namespace esphome
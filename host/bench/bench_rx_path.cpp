@@ -0,0 +1,182 @@
+// Receive-path microbenchmark: the cost of one frame from the radio callback
+// (process_packet) through decode and publish in loop(), per packet type, with
+// every heap allocation on that path counted.
+//
+//   iboost_bench [frames] [--log-level N]
+//
+// Exits non-zero if any frame allocated, so the short run under ctest guards the
+// zero-allocation property. Timings are host timings: compare them with each other
+// and across changes, not with the ESP32.
+//
+// iboost_bench is built at the default DEBUG log level, where the per-frame messages
+// compile out; iboost_bench_vv is the same code built at VERY_VERBOSE, where they are
+// recorded and drained. --log-level N also prints messages up to N (send stderr to
+// /dev/null), so the formatting is timed as well.
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <vector>
+#include "esphiBoost.h"
+#include "esphome/components/sx126x/sx126x.h"
+#include "frames.h"
+
+using namespace esphome;
+using namespace esphome::esphiBoost;
+
+namespace
+{
+  std::atomic<bool> counting{false};
+  std::atomic<uint64_t> allocations{0};
+} // namespace
+
+// Counts every allocation while `counting` is set; the deletes pair with the malloc below
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+void *operator new(size_t size)
+{
+  if (counting.load(std::memory_order_relaxed))
+    allocations.fetch_add(1, std::memory_order_relaxed);
+  void *p = malloc(size == 0 ? 1 : size);
+  if (p == nullptr)
+    throw std::bad_alloc();
+  return p;
+}
+
+void operator delete(void *p) noexcept { free(p); }
+void operator delete(void *p, size_t) noexcept { free(p); }
+
+namespace
+{
+  constexpr uint32_t FRAME_GAP_MS = 1100; // beyond the duplicate window
+
+  // Every per-frame output wired, as in the example YAML with diagnostics on
+  struct Rig
+  {
+    Rig()
+    {
+      buddy.set_radio(&radio);
+      buddy.set_packet_count(&packet_count);
+      buddy.set_heating_mode(&mode);
+      buddy.set_heating_warn(&warn);
+      buddy.set_heating_power(&power);
+      buddy.set_heating_import(&import_power);
+      buddy.set_sender_import(&sender_import);
+      buddy.set_heating_boost_time(&boost_time);
+      buddy.set_heating_today(&today);
+      buddy.set_heating_last_gt(&total);
+      buddy.set_rssi_iboost(&rssi_iboost);
+      buddy.set_rssi_buddy(&rssi_buddy);
+      buddy.set_rssi_sender(&rssi_sender);
+      buddy.set_ts_last_packet(&last_packet);
+      buddy.setup();
+    }
+
+    sx126x::SX126x radio;
+    iBoostBuddy buddy;
+    sensor::Sensor packet_count, power, import_power, sender_import, boost_time, today, total;
+    sensor::Sensor rssi_iboost, rssi_buddy, rssi_sender;
+    text_sensor::TextSensor mode, warn, last_packet;
+  };
+
+  // Distinct frames of one type, built before timing starts
+  std::vector<std::vector<uint8_t>> make_frames(uint8_t type, size_t count)
+  {
+    std::vector<std::vector<uint8_t>> out;
+    out.reserve(count);
+    for (size_t i = 0; i < count; i++)
+    {
+      switch (type)
+      {
+      case PACKET_TYPE_IBOOST:
+      {
+        frames::IBoostStatus status;
+        status.power = static_cast<int16_t>(500 + i % 2000);
+        status.import_raw = static_cast<int32_t>(360 * (i % 300));
+        status.data_code = i % 2 ? DATA_REQUEST_TODAY : DATA_REQUEST_TOTAL;
+        status.data_value = static_cast<int32_t>(i);
+        out.push_back(frames::iboost(status));
+        break;
+      }
+      case PACKET_TYPE_BUDDY:
+      {
+        auto frame = frames::buddy(0x1234);
+        frames::put_le(frame, 20, static_cast<uint32_t>(i), 4);
+        out.push_back(frame);
+        break;
+      }
+      default:
+        out.push_back(frames::sender(0x1234, static_cast<int32_t>(360 * (i % 300))));
+        break;
+      }
+    }
+    return out;
+  }
+
+  struct Result
+  {
+    double ns_per_frame;
+    double allocations_per_frame;
+  };
+
+  Result run(Rig &rig, const std::vector<std::vector<uint8_t>> &frames)
+  {
+    allocations = 0;
+    counting = true;
+    auto start = std::chrono::steady_clock::now();
+    for (const auto &frame : frames)
+    {
+      host::advance_millis(FRAME_GAP_MS);
+      rig.buddy.process_packet(frame, -80.0f);
+      rig.buddy.loop();
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    counting = false;
+    double ns = std::chrono::duration<double, std::nano>(elapsed).count();
+    return {ns / frames.size(), static_cast<double>(allocations) / frames.size()};
+  }
+} // namespace
+
+int main(int argc, char **argv)
+{
+  size_t count = 200000;
+  int log_level = ESPHOME_LOG_LEVEL_NONE;
+  for (int i = 1; i < argc; i++)
+  {
+    if (strcmp(argv[i], "--log-level") == 0 && i + 1 < argc)
+      log_level = atoi(argv[++i]);
+    else
+      count = strtoul(argv[i], nullptr, 10);
+  }
+  if (count == 0)
+    count = 1;
+  host::set_log_level(log_level);
+  host::set_micros(5000000);
+
+  struct Case
+  {
+    const char *name;
+    uint8_t type;
+  };
+  const Case cases[] = {{"iboost", PACKET_TYPE_IBOOST}, {"buddy", PACKET_TYPE_BUDDY}, {"sender", PACKET_TYPE_SENDER}};
+
+  Rig rig;
+  // Warm-up: the first frame of each type learns the system and sizes text states
+  for (const auto &c : cases)
+    run(rig, make_frames(c.type, 16));
+
+  bool allocated = false;
+  printf("log level: compiled %d, printed %d\n", ESPHOME_LOG_LEVEL, log_level);
+  printf("%-8s %10s %10s %13s\n", "type", "frames", "ns/frame", "allocs/frame");
+  for (const auto &c : cases)
+  {
+    auto frames = make_frames(c.type, count);
+    Result result = run(rig, frames);
+    printf("%-8s %10zu %10.1f %13.3f\n", c.name, count, result.ns_per_frame, result.allocations_per_frame);
+    allocated |= result.allocations_per_frame > 0.0;
+  }
+  if (allocated)
+    fprintf(stderr, "receive path allocated\n");
+  return allocated ? 1 : 0;
+}
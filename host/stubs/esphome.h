@@ -0,0 +1,7 @@
+#pragma once
+// Host stand-in for the generated umbrella header; only the core pieces exist here
+#include "esphome/core/component.h"
+#include "esphome/core/defines.h"
+#include "esphome/core/hal.h"
+#include "esphome/core/helpers.h"
+#include "esphome/core/log.h"
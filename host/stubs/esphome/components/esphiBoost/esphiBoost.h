@@ -0,0 +1,3 @@
+#pragma once
+// The display includes esphiBoost by its ESPHome path; on the host it lives in components/
+#include <esphiBoost.h>
@@ -0,0 +1,29 @@
+#pragma once
+#include <cmath>
+#include <cstdint>
+
+namespace esphome
+{
+  namespace sensor
+  {
+    class Sensor
+    {
+    public:
+      void publish_state(float state)
+      {
+        this->state = state;
+        has_state_ = true;
+        publish_count_++;
+      }
+      bool has_state() const { return has_state_; }
+      float get_state() const { return state; }
+      uint32_t get_publish_count() const { return publish_count_; } // host only
+
+      float state{NAN};
+
+    protected:
+      bool has_state_ = false;
+      uint32_t publish_count_ = 0;
+    };
+  } // namespace sensor
+} // namespace esphome
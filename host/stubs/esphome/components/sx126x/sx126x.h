@@ -0,0 +1,88 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace esphome
+{
+  namespace sx126x
+  {
+    enum class SX126xError
+    {
+      NONE = 0,
+      TIMEOUT,
+      INVALID_PARAMS,
+    };
+
+    enum SX126xStandbyMode
+    {
+      STDBY_RC = 0,
+      STDBY_XOSC = 1,
+    };
+
+    // Host stand-in for the sx126x driver. Transmitted frames are recorded, and
+    // frames injected from a test reach the on_packet callbacks only while the
+    // receiver is in RX, the way a sleeping radio would miss them.
+    class SX126x
+    {
+    public:
+      enum HostMode
+      {
+        HOST_MODE_RX = 0,
+        HOST_MODE_SLEEP,
+        HOST_MODE_STANDBY,
+      };
+
+      SX126xError transmit_packet(const std::vector<uint8_t> &packet)
+      {
+        transmitted.push_back(packet);
+        // The driver goes back to receiving after a transmission when rx_start is set
+        if (rx_start_)
+          set_mode_rx();
+        return SX126xError::NONE;
+      }
+      void set_mode_rx() { set_mode_(HOST_MODE_RX); }
+      void set_mode_sleep() { set_mode_(HOST_MODE_SLEEP); }
+      void set_mode_standby(SX126xStandbyMode mode) { set_mode_(HOST_MODE_STANDBY); }
+      void set_rx_start(bool rx_start) { rx_start_ = rx_start; }
+
+      // Stands in for the on_packet automation: x, rssi, snr
+      void add_on_packet_callback(std::function<void(const std::vector<uint8_t> &, float, float)> &&callback)
+      {
+        callbacks_.push_back(std::move(callback));
+      }
+
+      // Delivers a received frame; false if the radio was not listening
+      bool inject(const std::vector<uint8_t> &frame, float rssi, float snr = 10.0f)
+      {
+        if (mode_ != HOST_MODE_RX)
+        {
+          missed++;
+          return false;
+        }
+        for (auto &callback : callbacks_)
+          callback(frame, rssi, snr);
+        return true;
+      }
+
+      HostMode get_mode() const { return mode_; }
+      uint32_t get_mode_changes() const { return mode_changes_; }
+
+      std::vector<std::vector<uint8_t>> transmitted;
+      uint32_t missed = 0;
+
+    protected:
+      void set_mode_(HostMode mode)
+      {
+        if (mode != mode_)
+          mode_changes_++;
+        mode_ = mode;
+      }
+
+      std::vector<std::function<void(const std::vector<uint8_t> &, float, float)>> callbacks_;
+      HostMode mode_ = HOST_MODE_RX;
+      uint32_t mode_changes_ = 0;
+      bool rx_start_ = true;
+    };
+  } // namespace sx126x
+} // namespace esphome
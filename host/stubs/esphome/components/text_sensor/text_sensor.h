@@ -0,0 +1,29 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+namespace esphome
+{
+  namespace text_sensor
+  {
+    class TextSensor
+    {
+    public:
+      void publish_state(const std::string &state)
+      {
+        this->state = state;
+        has_state_ = true;
+        publish_count_++;
+      }
+      bool has_state() const { return has_state_; }
+      const std::string &get_state() const { return state; }
+      uint32_t get_publish_count() const { return publish_count_; } // host only
+
+      std::string state;
+
+    protected:
+      bool has_state_ = false;
+      uint32_t publish_count_ = 0;
+    };
+  } // namespace text_sensor
+} // namespace esphome
@@ -0,0 +1,40 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+
+namespace esphome
+{
+  struct ESPTime
+  {
+    uint8_t second;
+    uint8_t minute;
+    uint8_t hour;
+    uint8_t day_of_week;  // 1 = Sunday
+    uint8_t day_of_month;
+    uint16_t day_of_year;
+    uint8_t month;
+    uint16_t year;
+    time_t timestamp;
+
+    bool is_valid() const { return year >= 2019; }
+    size_t strftime(char *buffer, size_t buffer_len, const char *format);
+    static ESPTime from_epoch_utc(time_t epoch);
+  };
+
+  namespace time
+  {
+    // Host stand-in: invalid until host_set_utc(), then runs on with millis()
+    class RealTimeClock
+    {
+    public:
+      ESPTime now();
+      ESPTime utcnow() { return now(); }
+      void host_set_utc(time_t epoch);
+
+    protected:
+      time_t epoch_ = 0;
+      uint32_t set_at_ms_ = 0;
+    };
+  } // namespace time
+} // namespace esphome
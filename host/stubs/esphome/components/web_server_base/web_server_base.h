@@ -0,0 +1,105 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Host stand-in for the parts of the async web server the components use. A
+// request is built by the test, routed with WebServerBase::host_handle() and the
+// response it was sent is kept on the request for inspection.
+
+#define HTTP_GET 1
+#define HTTP_POST 2
+
+class AsyncWebServerResponse
+{
+public:
+  AsyncWebServerResponse(int code, const char *content_type, const uint8_t *data, size_t length)
+      : code(code), content_type(content_type != nullptr ? content_type : ""), body(data, data + length)
+  {
+  }
+  void addHeader(const char *name, const char *value) { headers.emplace_back(name, value); }
+
+  int code;
+  std::string content_type;
+  std::vector<uint8_t> body;
+  std::vector<std::pair<std::string, std::string>> headers;
+};
+
+class AsyncWebServerRequest
+{
+public:
+  AsyncWebServerRequest(int method, const std::string &url) : method_(method), url_(url) {}
+
+  int method() const { return method_; }
+  std::string url() const { return url_; }
+  bool hasArg(const char *name) const { return args_.count(name) != 0; }
+  std::string arg(const char *name) const
+  {
+    auto it = args_.find(name);
+    return it == args_.end() ? std::string() : it->second;
+  }
+
+  AsyncWebServerResponse *beginResponse(int code, const char *content_type, const uint8_t *data, size_t length)
+  {
+    return new AsyncWebServerResponse(code, content_type, data, length);
+  }
+  void send(AsyncWebServerResponse *response) { response_.reset(response); }
+  void send(int code, const char *content_type = "", const std::string &content = "")
+  {
+    send(beginResponse(code, content_type, reinterpret_cast<const uint8_t *>(content.data()), content.size()));
+  }
+
+  void host_add_arg(const std::string &name, const std::string &value) { args_[name] = value; }
+  const AsyncWebServerResponse *host_response() const { return response_.get(); }
+
+protected:
+  int method_;
+  std::string url_;
+  std::map<std::string, std::string> args_;
+  std::unique_ptr<AsyncWebServerResponse> response_;
+};
+
+class AsyncWebHandler
+{
+public:
+  virtual ~AsyncWebHandler() = default;
+  virtual bool canHandle(AsyncWebServerRequest *request) const { return false; }
+  virtual void handleRequest(AsyncWebServerRequest *request) {}
+  virtual bool isRequestHandlerTrivial() const { return true; }
+};
+
+namespace esphome
+{
+  namespace web_server_base
+  {
+    class WebServerBase
+    {
+    public:
+      void add_handler(AsyncWebHandler *handler) { handlers_.emplace_back(handler); }
+
+      // Hands the request to the first handler that accepts it; false if none did
+      bool host_handle(AsyncWebServerRequest *request)
+      {
+        for (auto &handler : handlers_)
+        {
+          if (handler->canHandle(request))
+          {
+            handler->handleRequest(request);
+            return true;
+          }
+        }
+        return false;
+      }
+      size_t host_handler_count() const { return handlers_.size(); }
+
+    protected:
+      std::vector<std::unique_ptr<AsyncWebHandler>> handlers_;
+    };
+
+    extern WebServerBase *global_web_server_base;
+  } // namespace web_server_base
+} // namespace esphome
@@ -0,0 +1,74 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+#include "esphome/core/hal.h"
+
+namespace esphome
+{
+  namespace setup_priority
+  {
+    extern const float HARDWARE;
+    extern const float DATA;
+    extern const float PROCESSOR;
+    extern const float LATE;
+  } // namespace setup_priority
+
+  // Host stand-in: set_interval()/set_timeout() are kept per component and run by
+  // host_run_scheduled(), which host::App calls the way the ESPHome scheduler would
+  class Component
+  {
+  public:
+    virtual ~Component() = default;
+    virtual void setup() {}
+    virtual void loop() {}
+    virtual void dump_config() {}
+    virtual float get_setup_priority() const { return 0.0f; }
+    virtual void on_shutdown() {}
+    virtual void on_safe_shutdown() {}
+    void mark_failed() { failed_ = true; }
+    bool is_failed() const { return failed_; }
+
+    // Runs every interval and timeout due at `now`; each runs at most once per call
+    void host_run_scheduled(uint32_t now);
+
+  protected:
+    void set_interval(const std::string &name, uint32_t interval, std::function<void()> &&f);
+    void set_interval(uint32_t interval, std::function<void()> &&f) { set_interval("", interval, std::move(f)); }
+    void set_timeout(const std::string &name, uint32_t timeout, std::function<void()> &&f);
+    void set_timeout(uint32_t timeout, std::function<void()> &&f) { set_timeout("", timeout, std::move(f)); }
+    bool cancel_interval(const std::string &name) { return cancel_(name); }
+    bool cancel_timeout(const std::string &name) { return cancel_(name); }
+    void defer(std::function<void()> &&f) { set_timeout("", 0, std::move(f)); }
+
+  private:
+    struct HostTimer
+    {
+      std::string name;
+      uint32_t interval;
+      uint32_t next_ms;
+      bool repeat;
+      bool cancelled;
+      std::function<void()> f;
+    };
+    void schedule_(const std::string &name, uint32_t delay, bool repeat, std::function<void()> &&f);
+    bool cancel_(const std::string &name);
+
+    std::vector<HostTimer> host_timers_;
+    bool failed_ = false;
+  };
+
+  class PollingComponent : public Component
+  {
+  public:
+    PollingComponent() = default;
+    explicit PollingComponent(uint32_t update_interval) : update_interval_(update_interval) {}
+    virtual void update() = 0;
+    virtual void set_update_interval(uint32_t update_interval) { update_interval_ = update_interval; }
+    virtual uint32_t get_update_interval() const { return update_interval_; }
+
+  protected:
+    uint32_t update_interval_ = 0;
+  };
+} // namespace esphome
@@ -0,0 +1,2 @@
+#pragma once
+// Host build: the USE_* defines ESPHome would generate are passed by host/CMakeLists.txt
@@ -0,0 +1,29 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+namespace esphome
+{
+  uint32_t millis();
+  uint32_t micros();
+  void delay(uint32_t ms);
+  void delayMicroseconds(uint32_t us);
+
+  namespace host
+  {
+    // The clock millis() and micros() read; it only moves when a test moves it
+    void set_micros(uint64_t us);
+    void advance_millis(uint32_t ms);
+    void advance_micros(uint32_t us);
+  } // namespace host
+
+  class GPIOPin
+  {
+  public:
+    virtual ~GPIOPin() = default;
+    virtual void setup() {}
+    virtual bool digital_read() { return false; }
+    virtual void digital_write(bool value) {}
+    virtual std::string dump_summary() const { return ""; }
+  };
+} // namespace esphome
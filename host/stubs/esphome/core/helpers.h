@@ -0,0 +1,32 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace esphome
+{
+  std::string format_hex_pretty(const uint8_t *data, size_t length);
+  std::string format_hex_pretty(const std::vector<uint8_t> &data);
+
+  class Mutex
+  {
+  public:
+    void lock() { mutex_.lock(); }
+    void unlock() { mutex_.unlock(); }
+
+  protected:
+    std::mutex mutex_;
+  };
+
+  class LockGuard
+  {
+  public:
+    explicit LockGuard(Mutex &mutex) : mutex_(mutex) { mutex_.lock(); }
+    ~LockGuard() { mutex_.unlock(); }
+
+  protected:
+    Mutex &mutex_;
+  };
+} // namespace esphome
@@ -0,0 +1,80 @@
+#pragma once
+#include "esphome/core/defines.h"
+
+// Host stand-in for ESPHome logging. Levels above ESPHOME_LOG_LEVEL compile to
+// nothing as on the device; the rest are counted per level and printed only when
+// the runtime level (HOST_LOG_LEVEL in the environment, default none) allows.
+
+#define ESPHOME_LOG_LEVEL_NONE 0
+#define ESPHOME_LOG_LEVEL_ERROR 1
+#define ESPHOME_LOG_LEVEL_WARN 2
+#define ESPHOME_LOG_LEVEL_INFO 3
+#define ESPHOME_LOG_LEVEL_CONFIG 4
+#define ESPHOME_LOG_LEVEL_DEBUG 5
+#define ESPHOME_LOG_LEVEL_VERBOSE 6
+#define ESPHOME_LOG_LEVEL_VERY_VERBOSE 7
+
+#ifndef ESPHOME_LOG_LEVEL
+#define ESPHOME_LOG_LEVEL ESPHOME_LOG_LEVEL_DEBUG
+#endif
+
+namespace esphome
+{
+  namespace host
+  {
+    void log_printf(int level, const char *tag, const char *format, ...) __attribute__((format(printf, 3, 4)));
+
+    // Messages logged at `level` since the last reset_log_counts()
+    unsigned log_count(int level);
+    void reset_log_counts();
+    void set_log_level(int level);
+  } // namespace host
+} // namespace esphome
+
+#define ESPHOME_HOST_LOG_(level, tag, ...) ::esphome::host::log_printf(level, tag, __VA_ARGS__)
+#define ESPHOME_HOST_LOG_NONE_(...) \
+  do \
+  { \
+  } while (0)
+
+#if ESPHOME_LOG_LEVEL >= ESPHOME_LOG_LEVEL_ERROR
+#define ESP_LOGE(tag, ...) ESPHOME_HOST_LOG_(ESPHOME_LOG_LEVEL_ERROR, tag, __VA_ARGS__)
+#else
+#define ESP_LOGE(tag, ...) ESPHOME_HOST_LOG_NONE_()
+#endif
+#if ESPHOME_LOG_LEVEL >= ESPHOME_LOG_LEVEL_WARN
+#define ESP_LOGW(tag, ...) ESPHOME_HOST_LOG_(ESPHOME_LOG_LEVEL_WARN, tag, __VA_ARGS__)
+#else
+#define ESP_LOGW(tag, ...) ESPHOME_HOST_LOG_NONE_()
+#endif
+#if ESPHOME_LOG_LEVEL >= ESPHOME_LOG_LEVEL_INFO
+#define ESP_LOGI(tag, ...) ESPHOME_HOST_LOG_(ESPHOME_LOG_LEVEL_INFO, tag, __VA_ARGS__)
+#else
+#define ESP_LOGI(tag, ...) ESPHOME_HOST_LOG_NONE_()
+#endif
+#if ESPHOME_LOG_LEVEL >= ESPHOME_LOG_LEVEL_CONFIG
+#define ESP_LOGCONFIG(tag, ...) ESPHOME_HOST_LOG_(ESPHOME_LOG_LEVEL_CONFIG, tag, __VA_ARGS__)
+#else
+#define ESP_LOGCONFIG(tag, ...) ESPHOME_HOST_LOG_NONE_()
+#endif
+#if ESPHOME_LOG_LEVEL >= ESPHOME_LOG_LEVEL_DEBUG
+#define ESP_LOGD(tag, ...) ESPHOME_HOST_LOG_(ESPHOME_LOG_LEVEL_DEBUG, tag, __VA_ARGS__)
+#else
+#define ESP_LOGD(tag, ...) ESPHOME_HOST_LOG_NONE_()
+#endif
+#if ESPHOME_LOG_LEVEL >= ESPHOME_LOG_LEVEL_VERBOSE
+#define ESP_LOGV(tag, ...) ESPHOME_HOST_LOG_(ESPHOME_LOG_LEVEL_VERBOSE, tag, __VA_ARGS__)
+#else
+#define ESP_LOGV(tag, ...) ESPHOME_HOST_LOG_NONE_()
+#endif
+#if ESPHOME_LOG_LEVEL >= ESPHOME_LOG_LEVEL_VERY_VERBOSE
+#define ESP_LOGVV(tag, ...) ESPHOME_HOST_LOG_(ESPHOME_LOG_LEVEL_VERY_VERBOSE, tag, __VA_ARGS__)
+#else
+#define ESP_LOGVV(tag, ...) ESPHOME_HOST_LOG_NONE_()
+#endif
+
+#define LOG_SENSOR(prefix, type, obj) ESPHOME_HOST_LOG_NONE_()
+#define LOG_TEXT_SENSOR(prefix, type, obj) ESPHOME_HOST_LOG_NONE_()
+#define LOG_UPDATE_INTERVAL(this) ESPHOME_HOST_LOG_NONE_()
+#define LOG_PIN(prefix, pin) ESPHOME_HOST_LOG_NONE_()
+#define YESNO(b) ((b) ? "YES" : "NO")
@@ -0,0 +1,64 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <vector>
+
+namespace esphome
+{
+  class ESPPreferences;
+
+  // Host stand-in: saved blobs live in the ESPPreferences object that made the
+  // preference, so a second component instance can "boot" from what the first saved
+  class ESPPreferenceObject
+  {
+  public:
+    ESPPreferenceObject() = default;
+    ESPPreferenceObject(ESPPreferences *owner, uint32_t type) : owner_(owner), type_(type) {}
+
+    template <typename T> bool save(const T *src);
+    template <typename T> bool load(T *dest);
+
+  protected:
+    ESPPreferences *owner_ = nullptr;
+    uint32_t type_ = 0;
+  };
+
+  class ESPPreferences
+  {
+  public:
+    template <typename T> ESPPreferenceObject make_preference(uint32_t type, bool in_flash)
+    {
+      return ESPPreferenceObject(this, type);
+    }
+    template <typename T> ESPPreferenceObject make_preference(uint32_t type) { return ESPPreferenceObject(this, type); }
+    bool sync() { return true; }
+
+    std::map<uint32_t, std::vector<uint8_t>> host_store;
+    uint32_t host_saves = 0;
+  };
+
+  template <typename T> bool ESPPreferenceObject::save(const T *src)
+  {
+    if (owner_ == nullptr)
+      return false;
+    const uint8_t *bytes = reinterpret_cast<const uint8_t *>(src);
+    owner_->host_store[type_].assign(bytes, bytes + sizeof(T));
+    owner_->host_saves++;
+    return true;
+  }
+
+  template <typename T> bool ESPPreferenceObject::load(T *dest)
+  {
+    if (owner_ == nullptr)
+      return false;
+    auto it = owner_->host_store.find(type_);
+    if (it == owner_->host_store.end() || it->second.size() != sizeof(T))
+      return false;
+    memcpy(dest, it->second.data(), sizeof(T));
+    return true;
+  }
+
+  extern ESPPreferences *global_preferences;
+} // namespace esphome
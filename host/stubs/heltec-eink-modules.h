@@ -0,0 +1,128 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "esphome/core/hal.h"
+
+// Host stand-in for the Heltec e-ink driver and the Adafruit GFX pieces the display
+// uses. The panel keeps a 1bpp frame buffer plus the image last pushed to the glass and
+// counts what each call costs. As in the real driver, update() and clear() return only
+// once the refresh is over: they move the fake clock on by the simulated refresh time.
+
+enum Colors : uint16_t
+{
+  BLACK = 0,
+  WHITE = 1,
+};
+
+// Adafruit GFX built-in 5x7 font, printable ASCII only, one byte per column (LSB = top row)
+extern const uint8_t HOST_GFX_FONT[][5];
+
+class GFXcanvas1
+{
+public:
+  GFXcanvas1(int16_t w, int16_t h) : width_(w), height_(h), pixels_(static_cast<size_t>(w) * h, 0) {}
+
+  void fillScreen(uint16_t color) { pixels_.assign(pixels_.size(), color != 0); }
+  void setTextWrap(bool wrap) {}
+  void drawPixel(int16_t x, int16_t y, uint16_t color)
+  {
+    if (x >= 0 && y >= 0 && x < width_ && y < height_)
+      pixels_[y * width_ + x] = color != 0;
+  }
+  bool getPixel(int16_t x, int16_t y) const
+  {
+    return x >= 0 && y >= 0 && x < width_ && y < height_ && pixels_[y * width_ + x];
+  }
+  // Text size 1 only; characters outside printable ASCII draw nothing
+  void drawChar(int16_t x, int16_t y, unsigned char c, uint16_t color, uint16_t bg, uint8_t size);
+
+protected:
+  int16_t width_;
+  int16_t height_;
+  std::vector<bool> pixels_;
+};
+
+class EInkDisplay_WirelessPaperV1_1
+{
+public:
+  static const int PANEL_WIDTH = 250; // landscape
+  static const int PANEL_HEIGHT = 122;
+
+  // Simulated time each kind of refresh holds BUSY, and so the caller
+  uint32_t full_refresh_ms = 2000;
+  uint32_t fast_refresh_ms = 300;
+
+  EInkDisplay_WirelessPaperV1_1();
+
+  void landscape() { landscape_ = true; }
+  int16_t width() const { return landscape_ ? PANEL_WIDTH : PANEL_HEIGHT; }
+  int16_t height() const { return landscape_ ? PANEL_HEIGHT : PANEL_WIDTH; }
+
+  void fastmodeOn() { fast_mode_ = true; }
+  void fastmodeOff() { fast_mode_ = false; }
+  // Blanks the buffer and the glass with a full refresh; blocks until it is done
+  void clear();
+  // Pushes the buffer to the glass, fast or full depending on the mode; blocks until it is done
+  void update();
+  // Adafruit GFX drawing as the Heltec library inherits it: every primitive ends in one
+  // drawPixel() per pixel, and text wraps to the next 8-pixel row at the right edge
+  void drawPixel(int16_t x, int16_t y, uint16_t color);
+  void fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
+  void drawBitmap(int16_t x, int16_t y, const uint8_t *bitmap, int16_t w, int16_t h, uint16_t color, uint16_t bg);
+  void setCursor(int16_t x, int16_t y)
+  {
+    cursor_x_ = x;
+    cursor_y_ = y;
+  }
+  void setTextColor(uint16_t color) { text_color_ = text_bg_ = color; }
+  void setTextColor(uint16_t color, uint16_t bg)
+  {
+    text_color_ = color;
+    text_bg_ = bg;
+  }
+  void setTextWrap(bool wrap) { wrap_ = wrap; }
+  void print(const char *text);
+
+  // BUSY line for PaperDisplay::set_busy_pin(): high while a refresh is in progress, so
+  // never seen high between calls
+  esphome::GPIOPin *host_busy_pin() { return &busy_pin_; }
+  bool host_busy() const;
+
+  // What the glass shows, as a binary PBM (P4) in the same layout as PaperDisplay's snapshot
+  void host_render_pbm(std::string &out) const;
+  bool host_shown_pixel(int x, int y) const { return shown_[y * PANEL_WIDTH + x]; }
+
+  uint32_t host_full_refreshes = 0;
+  uint32_t host_fast_refreshes = 0;
+  uint32_t host_draw_calls = 0;     // fillRect() and drawBitmap() calls
+  uint32_t host_pixels_drawn = 0;   // drawPixel() calls that landed on the panel
+  uint32_t host_pixels_changed = 0; // pixels that differed from the glass when pushed
+  uint32_t host_busy_ms = 0;        // simulated refresh time spent inside update() and clear(), summed
+
+protected:
+  class BusyPin : public esphome::GPIOPin
+  {
+  public:
+    explicit BusyPin(EInkDisplay_WirelessPaperV1_1 *panel) : panel_(panel) {}
+    bool digital_read() override { return panel_->host_busy(); }
+
+  protected:
+    EInkDisplay_WirelessPaperV1_1 *panel_;
+  };
+
+  void refresh_(uint32_t busy_ms);
+
+  bool landscape_ = false;
+  bool fast_mode_ = false;
+  int16_t cursor_x_ = 0;
+  int16_t cursor_y_ = 0;
+  uint16_t text_color_ = BLACK;
+  uint16_t text_bg_ = BLACK; // same as the color: transparent, as in GFX
+  bool wrap_ = true;
+  uint32_t busy_until_ms_ = 0;
+  BusyPin busy_pin_;
+  // One entry per pixel in landscape order, true = black
+  std::vector<bool> buffer_;
+  std::vector<bool> shown_;
+};
@@ -0,0 +1,182 @@
+#include "heltec-eink-modules.h"
+#include <cstdio>
+
+using esphome::millis;
+
+const uint8_t HOST_GFX_FONT[][5] = {
+    {0x00, 0x00, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x5F, 0x00, 0x00}, {0x00, 0x07, 0x00, 0x07, 0x00}, // ' ' ! "
+    {0x14, 0x7F, 0x14, 0x7F, 0x14}, {0x24, 0x2A, 0x7F, 0x2A, 0x12}, {0x23, 0x13, 0x08, 0x64, 0x62}, // # $ %
+    {0x36, 0x49, 0x56, 0x20, 0x50}, {0x00, 0x08, 0x07, 0x03, 0x00}, {0x00, 0x1C, 0x22, 0x41, 0x00}, // & ' (
+    {0x00, 0x41, 0x22, 0x1C, 0x00}, {0x2A, 0x1C, 0x7F, 0x1C, 0x2A}, {0x08, 0x08, 0x3E, 0x08, 0x08}, // ) * +
+    {0x00, 0x50, 0x30, 0x00, 0x00}, {0x08, 0x08, 0x08, 0x08, 0x08}, {0x00, 0x60, 0x60, 0x00, 0x00}, // , - .
+    {0x20, 0x10, 0x08, 0x04, 0x02}, {0x3E, 0x51, 0x49, 0x45, 0x3E}, {0x00, 0x42, 0x7F, 0x40, 0x00}, // / 0 1
+    {0x42, 0x61, 0x51, 0x49, 0x46}, {0x21, 0x41, 0x45, 0x4B, 0x31}, {0x18, 0x14, 0x12, 0x7F, 0x10}, // 2 3 4
+    {0x27, 0x45, 0x45, 0x45, 0x39}, {0x3C, 0x4A, 0x49, 0x49, 0x30}, {0x01, 0x71, 0x09, 0x05, 0x03}, // 5 6 7
+    {0x36, 0x49, 0x49, 0x49, 0x36}, {0x06, 0x49, 0x49, 0x29, 0x1E}, {0x00, 0x36, 0x36, 0x00, 0x00}, // 8 9 :
+    {0x00, 0x56, 0x36, 0x00, 0x00}, {0x08, 0x14, 0x22, 0x41, 0x00}, {0x14, 0x14, 0x14, 0x14, 0x14}, // ; < =
+    {0x00, 0x41, 0x22, 0x14, 0x08}, {0x02, 0x01, 0x51, 0x09, 0x06}, {0x32, 0x49, 0x79, 0x41, 0x3E}, // > ? @
+    {0x7E, 0x11, 0x11, 0x11, 0x7E}, {0x7F, 0x49, 0x49, 0x49, 0x36}, {0x3E, 0x41, 0x41, 0x41, 0x22}, // A B C
+    {0x7F, 0x41, 0x41, 0x22, 0x1C}, {0x7F, 0x49, 0x49, 0x49, 0x41}, {0x7F, 0x09, 0x09, 0x09, 0x01}, // D E F
+    {0x3E, 0x41, 0x49, 0x49, 0x7A}, {0x7F, 0x08, 0x08, 0x08, 0x7F}, {0x00, 0x41, 0x7F, 0x41, 0x00}, // G H I
+    {0x20, 0x40, 0x41, 0x3F, 0x01}, {0x7F, 0x08, 0x14, 0x22, 0x41}, {0x7F, 0x40, 0x40, 0x40, 0x40}, // J K L
+    {0x7F, 0x02, 0x0C, 0x02, 0x7F}, {0x7F, 0x04, 0x08, 0x10, 0x7F}, {0x3E, 0x41, 0x41, 0x41, 0x3E}, // M N O
+    {0x7F, 0x09, 0x09, 0x09, 0x06}, {0x3E, 0x41, 0x51, 0x21, 0x5E}, {0x7F, 0x09, 0x19, 0x29, 0x46}, // P Q R
+    {0x46, 0x49, 0x49, 0x49, 0x31}, {0x01, 0x01, 0x7F, 0x01, 0x01}, {0x3F, 0x40, 0x40, 0x40, 0x3F}, // S T U
+    {0x1F, 0x20, 0x40, 0x20, 0x1F}, {0x3F, 0x40, 0x38, 0x40, 0x3F}, {0x63, 0x14, 0x08, 0x14, 0x63}, // V W X
+    {0x07, 0x08, 0x70, 0x08, 0x07}, {0x61, 0x51, 0x49, 0x45, 0x43}, {0x00, 0x7F, 0x41, 0x41, 0x00}, // Y Z [
+    {0x02, 0x04, 0x08, 0x10, 0x20}, {0x00, 0x41, 0x41, 0x7F, 0x00}, {0x04, 0x02, 0x01, 0x02, 0x04}, // \ ] ^
+    {0x40, 0x40, 0x40, 0x40, 0x40}, {0x00, 0x01, 0x02, 0x04, 0x00}, {0x20, 0x54, 0x54, 0x54, 0x78}, // _ ` a
+    {0x7F, 0x48, 0x44, 0x44, 0x38}, {0x38, 0x44, 0x44, 0x44, 0x20}, {0x38, 0x44, 0x44, 0x48, 0x7F}, // b c d
+    {0x38, 0x54, 0x54, 0x54, 0x18}, {0x08, 0x7E, 0x09, 0x01, 0x02}, {0x0C, 0x52, 0x52, 0x52, 0x3E}, // e f g
+    {0x7F, 0x08, 0x04, 0x04, 0x78}, {0x00, 0x44, 0x7D, 0x40, 0x00}, {0x20, 0x40, 0x44, 0x3D, 0x00}, // h i j
+    {0x7F, 0x10, 0x28, 0x44, 0x00}, {0x00, 0x41, 0x7F, 0x40, 0x00}, {0x7C, 0x04, 0x18, 0x04, 0x78}, // k l m
+    {0x7C, 0x08, 0x04, 0x04, 0x78}, {0x38, 0x44, 0x44, 0x44, 0x38}, {0x7C, 0x14, 0x14, 0x14, 0x08}, // n o p
+    {0x08, 0x14, 0x14, 0x18, 0x7C}, {0x7C, 0x08, 0x04, 0x04, 0x08}, {0x48, 0x54, 0x54, 0x54, 0x20}, // q r s
+    {0x04, 0x3F, 0x44, 0x40, 0x20}, {0x3C, 0x40, 0x40, 0x20, 0x7C}, {0x1C, 0x20, 0x40, 0x20, 0x1C}, // t u v
+    {0x3C, 0x40, 0x30, 0x40, 0x3C}, {0x44, 0x28, 0x10, 0x28, 0x44}, {0x0C, 0x50, 0x50, 0x50, 0x3C}, // w x y
+    {0x44, 0x64, 0x54, 0x4C, 0x44}, {0x00, 0x08, 0x36, 0x41, 0x00}, {0x00, 0x00, 0x7F, 0x00, 0x00}, // z { |
+    {0x00, 0x41, 0x36, 0x08, 0x00}, {0x02, 0x01, 0x02, 0x04, 0x02},                                 // } ~
+};
+static_assert(sizeof(HOST_GFX_FONT) / sizeof(HOST_GFX_FONT[0]) == 0x7E - 0x20 + 1, "one entry per printable character");
+
+// Adafruit's drawChar() at size 1: a pixel per set bit, and per clear bit too unless
+// the background is the text color
+template<typename Target>
+static void draw_gfx_char(Target &target, int16_t x, int16_t y, unsigned char c, uint16_t color, uint16_t bg)
+{
+  if (c < 0x20 || c > 0x7E)
+    return;
+  const uint8_t *columns = HOST_GFX_FONT[c - 0x20];
+  for (int col = 0; col < 6; col++)
+  {
+    uint8_t bits = col < 5 ? columns[col] : 0;
+    for (int row = 0; row < 8; row++)
+    {
+      if (bits & (1 << row))
+        target.drawPixel(x + col, y + row, color);
+      else if (bg != color)
+        target.drawPixel(x + col, y + row, bg);
+    }
+  }
+}
+
+void GFXcanvas1::drawChar(int16_t x, int16_t y, unsigned char c, uint16_t color, uint16_t bg, uint8_t size)
+{
+  draw_gfx_char(*this, x, y, c, color, bg);
+}
+
+EInkDisplay_WirelessPaperV1_1::EInkDisplay_WirelessPaperV1_1()
+    : busy_pin_(this), buffer_(PANEL_WIDTH * PANEL_HEIGHT, false), shown_(PANEL_WIDTH * PANEL_HEIGHT, false)
+{
+}
+
+void EInkDisplay_WirelessPaperV1_1::clear()
+{
+  buffer_.assign(buffer_.size(), false);
+  shown_.assign(shown_.size(), false);
+  host_full_refreshes++;
+  refresh_(full_refresh_ms);
+}
+
+void EInkDisplay_WirelessPaperV1_1::update()
+{
+  for (size_t i = 0; i < buffer_.size(); i++)
+  {
+    if (buffer_[i] != shown_[i])
+      host_pixels_changed++;
+  }
+  shown_ = buffer_;
+  if (fast_mode_)
+    host_fast_refreshes++;
+  else
+    host_full_refreshes++;
+  refresh_(fast_mode_ ? fast_refresh_ms : full_refresh_ms);
+}
+
+void EInkDisplay_WirelessPaperV1_1::drawPixel(int16_t x, int16_t y, uint16_t color)
+{
+  if (x < 0 || y < 0 || x >= PANEL_WIDTH || y >= PANEL_HEIGHT)
+    return;
+  buffer_[y * PANEL_WIDTH + x] = color == BLACK;
+  host_pixels_drawn++;
+}
+
+void EInkDisplay_WirelessPaperV1_1::fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color)
+{
+  host_draw_calls++;
+  for (int16_t col = x; col < x + w; col++)
+  {
+    for (int16_t row = y; row < y + h; row++)
+      drawPixel(col, row, color);
+  }
+}
+
+void EInkDisplay_WirelessPaperV1_1::drawBitmap(int16_t x, int16_t y, const uint8_t *bitmap, int16_t w, int16_t h,
+                                               uint16_t color, uint16_t bg)
+{
+  host_draw_calls++;
+  int stride = (w + 7) / 8;
+  for (int row = 0; row < h; row++)
+  {
+    for (int col = 0; col < w; col++)
+    {
+      bool set = bitmap[row * stride + col / 8] & (0x80 >> (col & 7));
+      drawPixel(x + col, y + row, set ? color : bg);
+    }
+  }
+}
+
+void EInkDisplay_WirelessPaperV1_1::print(const char *text)
+{
+  for (; *text != '\0'; text++)
+  {
+    if (*text == '\n')
+    {
+      cursor_x_ = 0;
+      cursor_y_ += 8;
+      continue;
+    }
+    if (wrap_ && cursor_x_ + 6 > width())
+    {
+      cursor_x_ = 0;
+      cursor_y_ += 8;
+    }
+    draw_gfx_char(*this, cursor_x_, cursor_y_, static_cast<unsigned char>(*text), text_color_, text_bg_);
+    cursor_x_ += 6;
+  }
+}
+
+bool EInkDisplay_WirelessPaperV1_1::host_busy() const
+{
+  return static_cast<int32_t>(busy_until_ms_ - millis()) > 0;
+}
+
+void EInkDisplay_WirelessPaperV1_1::host_render_pbm(std::string &out) const
+{
+  char header[32];
+  snprintf(header, sizeof(header), "P4\n%d %d\n", PANEL_WIDTH, PANEL_HEIGHT);
+  out = header;
+  int stride = (PANEL_WIDTH + 7) / 8;
+  for (int y = 0; y < PANEL_HEIGHT; y++)
+  {
+    for (int byte = 0; byte < stride; byte++)
+    {
+      uint8_t bits = 0;
+      for (int bit = 0; bit < 8 && byte * 8 + bit < PANEL_WIDTH; bit++)
+      {
+        if (shown_[y * PANEL_WIDTH + byte * 8 + bit])
+          bits |= 0x80 >> bit;
+      }
+      out.push_back(static_cast<char>(bits));
+    }
+  }
+}
+
+// The Heltec driver waits for BUSY to clear before update() and clear() return, so the
+// refresh time passes inside the call
+void EInkDisplay_WirelessPaperV1_1::refresh_(uint32_t busy_ms)
+{
+  busy_until_ms_ = millis() + busy_ms;
+  host_busy_ms += busy_ms;
+  esphome::host::advance_millis(busy_ms);
+}
@@ -0,0 +1,64 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "esphome/core/component.h"
+#include "esphome/core/hal.h"
+
+namespace esphome
+{
+  namespace host
+  {
+    // Stands in for App: runs setup() once, then loop(), due intervals and update()
+    // of every component on the fake clock, a fixed step at a time
+    class App
+    {
+    public:
+      void add(Component *component) { components_.push_back({component, nullptr, 0}); }
+      void add(PollingComponent *component) { components_.push_back({component, component, 0}); }
+
+      void setup()
+      {
+        for (auto &entry : components_)
+        {
+          entry.component->setup();
+          entry.next_update_ms = millis();
+        }
+      }
+
+      // One pass over every component at the current time
+      void step()
+      {
+        uint32_t now = millis();
+        for (auto &entry : components_)
+        {
+          entry.component->loop();
+          entry.component->host_run_scheduled(now);
+          if (entry.poller != nullptr && static_cast<int32_t>(now - entry.next_update_ms) >= 0)
+          {
+            entry.next_update_ms = now + entry.poller->get_update_interval();
+            entry.poller->update();
+          }
+        }
+      }
+
+      // Steps the clock forward `ms` in increments of `step_ms`, calling step() each time
+      void run_for(uint32_t ms, uint32_t step_ms = 16)
+      {
+        for (uint32_t elapsed = 0; elapsed < ms; elapsed += step_ms)
+        {
+          advance_millis(step_ms);
+          step();
+        }
+      }
+
+    protected:
+      struct Entry
+      {
+        Component *component;
+        PollingComponent *poller;
+        uint32_t next_update_ms;
+      };
+      std::vector<Entry> components_;
+    };
+  } // namespace host
+} // namespace esphome
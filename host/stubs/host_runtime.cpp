@@ -0,0 +1,262 @@
+// Host implementations behind the ESPHome stand-ins
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <string>
+#include <esp_partition.h>
+#include "esphome/core/component.h"
+#include "esphome/core/hal.h"
+#include "esphome/core/helpers.h"
+#include "esphome/core/log.h"
+#include "esphome/core/preferences.h"
+#include "esphome/components/time/real_time_clock.h"
+#include "esphome/components/web_server_base/web_server_base.h"
+
+namespace esphome
+{
+  namespace setup_priority
+  {
+    const float HARDWARE = 800.0f;
+    const float DATA = 600.0f;
+    const float PROCESSOR = 400.0f;
+    const float LATE = -100.0f;
+  } // namespace setup_priority
+
+  static uint64_t clock_us = 0;
+
+  uint32_t millis() { return static_cast<uint32_t>(clock_us / 1000); }
+  uint32_t micros() { return static_cast<uint32_t>(clock_us); }
+  void delay(uint32_t ms) { clock_us += static_cast<uint64_t>(ms) * 1000; }
+  void delayMicroseconds(uint32_t us) { clock_us += us; }
+
+  namespace host
+  {
+    void set_micros(uint64_t us) { clock_us = us; }
+    void advance_millis(uint32_t ms) { clock_us += static_cast<uint64_t>(ms) * 1000; }
+    void advance_micros(uint32_t us) { clock_us += us; }
+
+    static unsigned log_counts[ESPHOME_LOG_LEVEL_VERY_VERBOSE + 1];
+    static int runtime_level = -1;
+
+    void set_log_level(int level) { runtime_level = level; }
+
+    void log_printf(int level, const char *tag, const char *format, ...)
+    {
+      if (level >= 0 && level <= ESPHOME_LOG_LEVEL_VERY_VERBOSE)
+        log_counts[level]++;
+      if (runtime_level < 0)
+      {
+        const char *env = getenv("HOST_LOG_LEVEL");
+        runtime_level = env != nullptr ? atoi(env) : ESPHOME_LOG_LEVEL_NONE;
+      }
+      if (level > runtime_level)
+        return;
+      static const char LETTERS[] = "-EWICDVV";
+      fprintf(stderr, "[%c][%s] ", LETTERS[level], tag);
+      va_list args;
+      va_start(args, format);
+      vfprintf(stderr, format, args);
+      va_end(args);
+      fputc('\n', stderr);
+    }
+
+    unsigned log_count(int level) { return level >= 0 && level <= ESPHOME_LOG_LEVEL_VERY_VERBOSE ? log_counts[level] : 0; }
+    void reset_log_counts() { memset(log_counts, 0, sizeof(log_counts)); }
+
+    struct HostPartition
+    {
+      esp_partition_t partition;
+      std::unique_ptr<uint8_t[]> data;
+    };
+    static std::map<std::string, HostPartition> partitions;
+
+    uint8_t *add_partition(const char *label, size_t size)
+    {
+      HostPartition &entry = partitions[label];
+      entry.partition = esp_partition_t{};
+      entry.partition.type = ESP_PARTITION_TYPE_DATA;
+      entry.partition.subtype = ESP_PARTITION_SUBTYPE_ANY;
+      entry.partition.size = size;
+      entry.partition.erase_size = 4096;
+      snprintf(entry.partition.label, sizeof(entry.partition.label), "%s", label);
+      entry.data.reset(new uint8_t[size]);
+      memset(entry.data.get(), 0xFF, size);
+      return entry.data.get();
+    }
+
+    void remove_partitions() { partitions.clear(); }
+
+    static HostPartition *find_partition(const esp_partition_t *partition)
+    {
+      for (auto &entry : partitions)
+      {
+        if (&entry.second.partition == partition)
+          return &entry.second;
+      }
+      return nullptr;
+    }
+  } // namespace host
+
+  // Component scheduler
+  void Component::schedule_(const std::string &name, uint32_t delay, bool repeat, std::function<void()> &&f)
+  {
+    if (!name.empty())
+      cancel_(name);
+    host_timers_.push_back(HostTimer{name, delay, millis() + delay, repeat, false, std::move(f)});
+  }
+
+  void Component::set_interval(const std::string &name, uint32_t interval, std::function<void()> &&f)
+  {
+    schedule_(name, interval, true, std::move(f));
+  }
+
+  void Component::set_timeout(const std::string &name, uint32_t timeout, std::function<void()> &&f)
+  {
+    schedule_(name, timeout, false, std::move(f));
+  }
+
+  bool Component::cancel_(const std::string &name)
+  {
+    bool found = false;
+    for (auto &timer : host_timers_)
+    {
+      if (!timer.cancelled && timer.name == name)
+      {
+        timer.cancelled = true;
+        found = true;
+      }
+    }
+    return found;
+  }
+
+  void Component::host_run_scheduled(uint32_t now)
+  {
+    // Callbacks may schedule more; only those present at the start are considered
+    size_t count = host_timers_.size();
+    for (size_t i = 0; i < count; i++)
+    {
+      if (host_timers_[i].cancelled || static_cast<int32_t>(now - host_timers_[i].next_ms) < 0)
+        continue;
+      std::function<void()> f = host_timers_[i].f;
+      if (host_timers_[i].repeat)
+      {
+        uint32_t next = host_timers_[i].next_ms + host_timers_[i].interval;
+        host_timers_[i].next_ms = static_cast<int32_t>(now - next) >= 0 ? now + host_timers_[i].interval : next;
+      }
+      else
+      {
+        host_timers_[i].cancelled = true;
+      }
+      f();
+    }
+    for (size_t i = host_timers_.size(); i-- > 0;)
+    {
+      if (host_timers_[i].cancelled)
+        host_timers_.erase(host_timers_.begin() + i);
+    }
+  }
+
+  std::string format_hex_pretty(const uint8_t *data, size_t length)
+  {
+    std::string out;
+    char buffer[4];
+    for (size_t i = 0; i < length; i++)
+    {
+      snprintf(buffer, sizeof(buffer), i + 1 < length ? "%02X." : "%02X", data[i]);
+      out += buffer;
+    }
+    return out;
+  }
+
+  std::string format_hex_pretty(const std::vector<uint8_t> &data) { return format_hex_pretty(data.data(), data.size()); }
+
+  static ESPPreferences host_preferences;
+  ESPPreferences *global_preferences = &host_preferences;
+
+  ESPTime ESPTime::from_epoch_utc(time_t epoch)
+  {
+    struct tm tm;
+    gmtime_r(&epoch, &tm);
+    ESPTime time{};
+    time.second = tm.tm_sec;
+    time.minute = tm.tm_min;
+    time.hour = tm.tm_hour;
+    time.day_of_week = tm.tm_wday + 1;
+    time.day_of_month = tm.tm_mday;
+    time.day_of_year = tm.tm_yday + 1;
+    time.month = tm.tm_mon + 1;
+    time.year = tm.tm_year + 1900;
+    time.timestamp = epoch;
+    return time;
+  }
+
+  size_t ESPTime::strftime(char *buffer, size_t buffer_len, const char *format)
+  {
+    struct tm tm;
+    gmtime_r(&timestamp, &tm);
+    return ::strftime(buffer, buffer_len, format, &tm);
+  }
+
+  namespace time
+  {
+    ESPTime RealTimeClock::now()
+    {
+      if (epoch_ == 0)
+        return ESPTime{};
+      return ESPTime::from_epoch_utc(epoch_ + (millis() - set_at_ms_) / 1000);
+    }
+
+    void RealTimeClock::host_set_utc(time_t epoch)
+    {
+      epoch_ = epoch;
+      set_at_ms_ = millis();
+    }
+  } // namespace time
+
+  namespace web_server_base
+  {
+    WebServerBase *global_web_server_base = nullptr;
+  } // namespace web_server_base
+} // namespace esphome
+
+const esp_partition_t *esp_partition_find_first(esp_partition_type_t type, esp_partition_subtype_t subtype,
+                                                const char *label)
+{
+  auto it = esphome::host::partitions.find(label != nullptr ? label : "");
+  if (it == esphome::host::partitions.end() || it->second.partition.type != type)
+    return nullptr;
+  return &it->second.partition;
+}
+
+esp_err_t esp_partition_read(const esp_partition_t *partition, size_t offset, void *dst, size_t size)
+{
+  esphome::host::HostPartition *entry = esphome::host::find_partition(partition);
+  if (entry == nullptr || offset + size > partition->size)
+    return ESP_ERR_INVALID_SIZE;
+  memcpy(dst, entry->data.get() + offset, size);
+  return ESP_OK;
+}
+
+esp_err_t esp_partition_write(const esp_partition_t *partition, size_t offset, const void *src, size_t size)
+{
+  esphome::host::HostPartition *entry = esphome::host::find_partition(partition);
+  if (entry == nullptr || offset + size > partition->size)
+    return ESP_ERR_INVALID_SIZE;
+  const uint8_t *bytes = static_cast<const uint8_t *>(src);
+  for (size_t i = 0; i < size; i++)
+    entry->data[offset + i] &= bytes[i];
+  return ESP_OK;
+}
+
+esp_err_t esp_partition_erase_range(const esp_partition_t *partition, size_t offset, size_t size)
+{
+  esphome::host::HostPartition *entry = esphome::host::find_partition(partition);
+  if (entry == nullptr || offset % partition->erase_size != 0 || size % partition->erase_size != 0 ||
+      offset + size > partition->size)
+    return ESP_ERR_INVALID_ARG;
+  memset(entry->data.get() + offset, 0xFF, size);
+  return ESP_OK;
+}
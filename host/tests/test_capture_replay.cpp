@@ -0,0 +1,75 @@
+#include <gtest/gtest.h>
+#include "capture_replay.h"
+#include "esphome/components/sx126x/sx126x.h"
+#include "frames.h"
+
+using namespace esphome;
+using namespace esphome::esphiBoost;
+
+namespace
+{
+  std::vector<uint8_t> make_capture(const std::vector<std::vector<uint8_t>> &frames, uint32_t gap_ms)
+  {
+    PacketCapture capture;
+    capture.set_size(16);
+    uint32_t now = 70000;
+    for (const auto &frame : frames)
+    {
+      capture.record(frame.data(), frame.size(), -77.5f, now);
+      now += gap_ms;
+    }
+    std::vector<uint8_t> out;
+    capture.dump(out, now);
+    return out;
+  }
+} // namespace
+
+TEST(CaptureReplay, ParsesWhatPacketCaptureDumps)
+{
+  auto frame = frames::sender(0x1234, 360 * 50);
+  std::vector<capture_replay::Record> records;
+  ASSERT_TRUE(capture_replay::parse(make_capture({frame, frame}, 2500), records));
+  ASSERT_EQ(records.size(), 2u);
+  EXPECT_EQ(records[0].frame, frame);
+  EXPECT_FLOAT_EQ(records[0].rssi, -77.5f);
+  EXPECT_EQ(records[1].time_ms - records[0].time_ms, 2500u);
+}
+
+TEST(CaptureReplay, RejectsTruncatedOrForeignData)
+{
+  auto bytes = make_capture({frames::iboost({})}, 1000);
+  std::vector<capture_replay::Record> records;
+  bytes.pop_back();
+  EXPECT_FALSE(capture_replay::parse(bytes, records));
+  bytes[0] = 'X';
+  EXPECT_FALSE(capture_replay::parse(bytes, records));
+}
+
+TEST(CaptureReplay, ReplaysThroughProcessPacketAtTheOriginalSpacing)
+{
+  host::set_micros(5000000);
+  frames::IBoostStatus first;
+  first.power = 900;
+  frames::IBoostStatus second;
+  second.power = 1300;
+  second.import_raw = 360 * 80;
+  std::vector<capture_replay::Record> records;
+  ASSERT_TRUE(capture_replay::parse(make_capture({frames::iboost(first), frames::iboost(second)}, 9000), records));
+
+  sx126x::SX126x radio;
+  iBoostBuddy buddy;
+  sensor::Sensor power, import_power;
+  buddy.set_radio(&radio);
+  buddy.set_heating_power(&power);
+  buddy.set_heating_import(&import_power);
+  host::App app;
+  app.add(&buddy);
+  app.setup();
+
+  uint32_t start = millis();
+  capture_replay::replay(app, buddy, records, false);
+  EXPECT_EQ(millis() - start, 9000u);
+  EXPECT_FLOAT_EQ(power.state, 1300.0f);
+  EXPECT_FLOAT_EQ(import_power.state, 80.0f);
+  EXPECT_FALSE(radio.transmitted.empty()); // polled between the two frames
+}
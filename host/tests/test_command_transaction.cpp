@@ -0,0 +1,149 @@
+#include <gtest/gtest.h>
+#include <vector>
+#include "command_transaction.h"
+
+using namespace esphome::esphiBoost;
+
+namespace
+{
+  // Polls a transaction every 10 ms from `from` to `to`, sending and probing as asked;
+  // returns the send times
+  std::vector<uint32_t> drive(CommandTransaction &command, DutyCycleLimiter &limiter, uint32_t from, uint32_t to,
+                              uint32_t *probes = nullptr)
+  {
+    std::vector<uint32_t> sends;
+    for (uint32_t now = from; now < to && command.is_active(); now += 10)
+    {
+      switch (command.poll(now, limiter))
+      {
+      case COMMAND_ACTION_SEND:
+        command.on_sent(now);
+        limiter.on_transmit(now, CONTROL_FRAME_AIRTIME_US);
+        sends.push_back(now);
+        break;
+      case COMMAND_ACTION_PROBE:
+        command.on_probe_sent();
+        limiter.on_transmit(now, CONTROL_FRAME_AIRTIME_US);
+        if (probes != nullptr)
+          (*probes)++;
+        break;
+      default:
+        break;
+      }
+    }
+    return sends;
+  }
+} // namespace
+
+TEST(DutyCycleLimiter, EachFrameEarnsItsOffTime)
+{
+  DutyCycleLimiter limiter;
+  EXPECT_EQ(limiter.next_allowed(500), 500u);
+  limiter.on_transmit(1000, CONTROL_FRAME_AIRTIME_US);
+  uint32_t off_ms = (CONTROL_FRAME_AIRTIME_US * 99 + 999) / 1000;
+  EXPECT_EQ(limiter.next_allowed(1000), 1000 + off_ms);
+  EXPECT_EQ(limiter.next_allowed(1000 + off_ms + 5), 1000 + off_ms + 5);
+  EXPECT_EQ(limiter.get_window_used_us(), CONTROL_FRAME_AIRTIME_US);
+}
+
+TEST(DutyCycleLimiter, SpentBudgetWaitsForTheNextWindow)
+{
+  DutyCycleLimiter limiter;
+  // Short frames, each respecting its own off-time, until the hour's airtime is used up
+  uint32_t now = 0;
+  uint32_t frames = 0;
+  while (limiter.next_allowed(now) < DutyCycleLimiter::WINDOW_MS)
+  {
+    now = limiter.next_allowed(now);
+    limiter.on_transmit(now, 100000);
+    frames++;
+  }
+  EXPECT_EQ(frames, DutyCycleLimiter::WINDOW_BUDGET_US / 100000);
+  EXPECT_LE(limiter.get_window_used_us(), DutyCycleLimiter::WINDOW_BUDGET_US);
+  EXPECT_EQ(limiter.next_allowed(now + 1), DutyCycleLimiter::WINDOW_MS);
+
+  // A new window starts with a fresh budget
+  limiter.on_transmit(DutyCycleLimiter::WINDOW_MS, CONTROL_FRAME_AIRTIME_US);
+  EXPECT_EQ(limiter.get_window_used_us(), CONTROL_FRAME_AIRTIME_US);
+}
+
+TEST(CommandTransaction, ConfirmedByAMatchingStatus)
+{
+  CommandTransaction command;
+  DutyCycleLimiter limiter;
+  command.start(30, 1000);
+  ASSERT_EQ(drive(command, limiter, 1000, 1100).size(), 1u);
+
+  // A frame received before the command went out says nothing
+  EXPECT_FALSE(command.on_status(30, 990));
+  EXPECT_FALSE(command.on_status(0, 1250));
+  // The remaining time may already have ticked down a minute
+  EXPECT_TRUE(command.on_status(29, 1400));
+  EXPECT_EQ(command.get_outcome(), COMMAND_CONFIRMED);
+  EXPECT_EQ(command.get_latency_ms(), 400u);
+  EXPECT_EQ(command.get_attempts(), 1u);
+  EXPECT_EQ(command.poll(1500, limiter), COMMAND_ACTION_NONE);
+}
+
+TEST(CommandTransaction, CancelOnlyMatchesZero)
+{
+  CommandTransaction command;
+  DutyCycleLimiter limiter;
+  command.start(0, 0);
+  drive(command, limiter, 0, 100);
+  EXPECT_FALSE(command.on_status(1, 200));
+  EXPECT_TRUE(command.on_status(0, 300));
+}
+
+TEST(CommandTransaction, RetriesWithBackoffThenTimesOut)
+{
+  CommandTransaction command;
+  DutyCycleLimiter limiter;
+  command.start(60, 0);
+  uint32_t probes = 0;
+  std::vector<uint32_t> sends = drive(command, limiter, 0, 60000, &probes);
+
+  ASSERT_EQ(sends.size(), CommandTransaction::MAX_ATTEMPTS);
+  EXPECT_EQ(probes, CommandTransaction::MAX_ATTEMPTS); // one status request per silent window
+  for (size_t i = 1; i < sends.size(); i++)
+  {
+    uint32_t backoff = CommandTransaction::RETRY_BACKOFF_MS << (i - 1);
+    uint32_t gap = sends[i] - sends[i - 1];
+    EXPECT_GE(gap, CommandTransaction::CONFIRM_TIMEOUT_MS + backoff) << "retry " << i;
+    EXPECT_LT(gap, CommandTransaction::CONFIRM_TIMEOUT_MS + backoff + CommandTransaction::RETRY_JITTER_MS + 10)
+        << "retry " << i;
+  }
+  EXPECT_EQ(command.get_outcome(), COMMAND_TIMED_OUT);
+  EXPECT_EQ(command.get_timed_out(), 1u);
+  // A late status no longer counts
+  EXPECT_FALSE(command.on_status(60, sends.back() + 5000));
+}
+
+TEST(CommandTransaction, RetryWaitsForTheAirtimeBudget)
+{
+  CommandTransaction command;
+  DutyCycleLimiter limiter;
+  limiter.on_transmit(0, DutyCycleLimiter::WINDOW_BUDGET_US - 1000); // the hour's airtime is spent
+  uint32_t allowed = limiter.next_allowed(0);
+  ASSERT_EQ(allowed, DutyCycleLimiter::WINDOW_MS);
+
+  command.start(15, 10);
+  EXPECT_TRUE(drive(command, limiter, 10, allowed).empty());
+  std::vector<uint32_t> sends = drive(command, limiter, allowed, allowed + 100);
+  ASSERT_EQ(sends.size(), 1u);
+  EXPECT_LT(sends[0] - allowed, 10u);
+}
+
+TEST(CommandTransaction, NewCommandSupersedesTheOneInFlight)
+{
+  CommandTransaction command;
+  DutyCycleLimiter limiter;
+  command.start(30, 0);
+  drive(command, limiter, 0, 100);
+  command.start(0, 200);
+  EXPECT_EQ(command.get_attempts(), 0u);
+  EXPECT_FALSE(command.on_status(30, 250)); // the old target no longer confirms anything
+  std::vector<uint32_t> sends = drive(command, limiter, 200, 400);
+  ASSERT_EQ(sends.size(), 1u);
+  EXPECT_TRUE(command.on_status(0, sends[0] + 100));
+}
@@ -0,0 +1,42 @@
+#include <gtest/gtest.h>
+#include "duplicate_filter.h"
+
+using esphome::esphiBoost::DuplicateFilter;
+
+TEST(DuplicateFilter, DropsRepeatsWithinTheWindow)
+{
+  DuplicateFilter filter;
+  filter.set_window(1000);
+  const uint8_t a[] = {1, 2, 3, 4};
+  const uint8_t b[] = {1, 2, 3, 5};
+  EXPECT_FALSE(filter.is_duplicate(a, sizeof(a), 0));
+  EXPECT_TRUE(filter.is_duplicate(a, sizeof(a), 200));
+  EXPECT_FALSE(filter.is_duplicate(b, sizeof(b), 300));
+  EXPECT_FALSE(filter.is_duplicate(a, 3, 400)); // length is part of the identity
+  // Timed from the first copy, so repeats keep expiring on schedule
+  EXPECT_TRUE(filter.is_duplicate(a, sizeof(a), 999));
+  EXPECT_FALSE(filter.is_duplicate(a, sizeof(a), 1000));
+}
+
+TEST(DuplicateFilter, ZeroWindowKeepsEverything)
+{
+  DuplicateFilter filter;
+  filter.set_window(0);
+  const uint8_t a[] = {9, 9};
+  EXPECT_FALSE(filter.is_duplicate(a, sizeof(a), 0));
+  EXPECT_FALSE(filter.is_duplicate(a, sizeof(a), 1));
+}
+
+TEST(DuplicateFilter, RemembersOnlyTheLastFewFrames)
+{
+  DuplicateFilter filter;
+  filter.set_window(1000);
+  uint8_t frame[2] = {0, 0};
+  for (uint8_t i = 0; i <= DuplicateFilter::SLOTS; i++)
+  {
+    frame[0] = i;
+    EXPECT_FALSE(filter.is_duplicate(frame, sizeof(frame), i));
+  }
+  frame[0] = 0; // pushed out by the SLOTS frames after it
+  EXPECT_FALSE(filter.is_duplicate(frame, sizeof(frame), 20));
+}
@@ -0,0 +1,78 @@
+#include <gtest/gtest.h>
+#include "energy_integrator.h"
+
+using namespace esphome::esphiBoost;
+
+TEST(EnergyIntegrator, NoEstimateBeforeTheFirstCounter)
+{
+  EnergyIntegrator integrator;
+  integrator.add_sample(2000.0f, 0);
+  integrator.add_sample(2000.0f, 10000);
+  EXPECT_FALSE(integrator.has_estimate());
+  EXPECT_FLOAT_EQ(integrator.reconcile(1000.0f), 0.0f); // nothing to compare with yet
+  EXPECT_TRUE(integrator.has_estimate());
+  EXPECT_FLOAT_EQ(integrator.estimate(), 1000.0f);
+}
+
+TEST(EnergyIntegrator, IntegratesTrapezoidsBetweenFrames)
+{
+  EnergyIntegrator integrator;
+  integrator.reconcile(500.0f);
+  integrator.add_sample(1000.0f, 0);
+  // 1000 W rising to 3000 W over a minute averages 2000 W
+  integrator.add_sample(3000.0f, 60000);
+  EXPECT_NEAR(integrator.estimate(), 500.0f + 2000.0f / 60, 0.01f);
+  // A frame every 10 s for an hour: 10 s falling to 1800 W, then 3590 s steady
+  for (uint32_t t = 70000; t <= 3660000; t += 10000)
+    integrator.add_sample(1800.0f, t);
+  EXPECT_NEAR(integrator.estimate(), 500.0f + 2000.0f / 60 + 2400.0f * 10 / 3600 + 1800.0f * 3590 / 3600, 0.5f);
+}
+
+TEST(EnergyIntegrator, LongGapIsNotIntegrated)
+{
+  EnergyIntegrator integrator;
+  integrator.reconcile(0.0f);
+  integrator.add_sample(3000.0f, 0);
+  integrator.add_sample(3000.0f, EnergyIntegrator::MAX_GAP_MS + 1);
+  EXPECT_FLOAT_EQ(integrator.estimate(), 0.0f);
+  integrator.add_sample(3000.0f, EnergyIntegrator::MAX_GAP_MS + 1 + 1200);
+  EXPECT_NEAR(integrator.estimate(), 1.0f, 0.01f);
+}
+
+TEST(EnergyIntegrator, ReconcileReportsTheDriftAndReanchors)
+{
+  EnergyIntegrator integrator;
+  integrator.reconcile(1000.0f);
+  integrator.add_sample(3600.0f, 0);
+  integrator.add_sample(3600.0f, 60000); // 60 Wh
+  EXPECT_NEAR(integrator.reconcile(1050.0f), 10.0f, 0.01f);
+  EXPECT_FLOAT_EQ(integrator.estimate(), 1050.0f);
+  integrator.add_sample(3600.0f, 120000);
+  EXPECT_NEAR(integrator.estimate(), 1110.0f, 0.01f);
+}
+
+TEST(EnergyIntegrator, NewDayStartsFromZero)
+{
+  EnergyIntegrator integrator;
+  integrator.reconcile(8000.0f);
+  integrator.add_sample(3600.0f, 0);
+  integrator.add_sample(3600.0f, 60000);
+  integrator.new_day();
+  EXPECT_TRUE(integrator.has_estimate());
+  EXPECT_FLOAT_EQ(integrator.estimate(), 0.0f);
+  // Integration carries on from the frame before midnight
+  integrator.add_sample(3600.0f, 70000);
+  EXPECT_NEAR(integrator.estimate(), 10.0f, 0.01f);
+  EXPECT_NEAR(integrator.reconcile(12.0f), -2.0f, 0.01f);
+}
+
+TEST(EnergyIntegrator, CounterBelowTheAnchorIsTheIBoostsOwnRollover)
+{
+  EnergyIntegrator integrator;
+  integrator.reconcile(8000.0f);
+  integrator.add_sample(3600.0f, 0);
+  integrator.add_sample(3600.0f, 60000);
+  // No clock here, or the iBoost's midnight came first: the drop is not drift
+  EXPECT_FLOAT_EQ(integrator.reconcile(20.0f), 0.0f);
+  EXPECT_FLOAT_EQ(integrator.estimate(), 20.0f);
+}
@@ -0,0 +1,140 @@
+#include <gtest/gtest.h>
+#include <cstring>
+#include <string>
+#include "glyph_renderer.h"
+
+using namespace esphome::esphWirelessPaper;
+
+namespace
+{
+  bool bit(const uint8_t *bits, int stride, int x, int y) { return bits[y * stride + x / 8] & (0x80 >> (x & 7)); }
+
+  GlyphAtlas built_atlas()
+  {
+    GlyphAtlas atlas;
+    atlas.build();
+    return atlas;
+  }
+
+  // `text` through GFX drawChar() onto a canvas the size of a LineBitmap
+  GFXcanvas1 gfx_line(int x, const char *text)
+  {
+    GFXcanvas1 canvas(LineBitmap::WIDTH, LineBitmap::HEIGHT);
+    for (; *text != '\0'; text++, x += GLYPH_ADVANCE)
+      canvas.drawChar(x, 0, static_cast<unsigned char>(*text), 1, 0, 1);
+    return canvas;
+  }
+
+  void expect_same(const LineBitmap &line, const GFXcanvas1 &canvas)
+  {
+    for (int y = 0; y < LineBitmap::HEIGHT; y++)
+    {
+      for (int x = 0; x < LineBitmap::WIDTH; x++)
+        ASSERT_EQ(bit(line.data(), LineBitmap::STRIDE, x, y), canvas.getPixel(x, y)) << x << "," << y;
+    }
+  }
+} // namespace
+
+TEST(GlyphAtlas, MatchesGfxForEveryPrintableCharacter)
+{
+  GlyphAtlas atlas = built_atlas();
+  ASSERT_TRUE(atlas.is_built());
+  for (int c = GLYPH_FIRST; c <= GLYPH_LAST; c++)
+  {
+    GFXcanvas1 canvas(GLYPH_ADVANCE, GLYPH_ROWS);
+    canvas.drawChar(0, 0, static_cast<unsigned char>(c), 1, 0, 1);
+    const uint8_t *glyph = atlas.glyph(static_cast<char>(c));
+    for (int row = 0; row < GLYPH_ROWS; row++)
+    {
+      for (int col = 0; col < GLYPH_ADVANCE; col++)
+        EXPECT_EQ((glyph[row] & (0x80 >> col)) != 0, canvas.getPixel(col, row)) << "'" << char(c) << "' " << col << "," << row;
+    }
+  }
+}
+
+TEST(GlyphAtlas, NonPrintableDrawsAsQuestionMark)
+{
+  GlyphAtlas atlas = built_atlas();
+  EXPECT_EQ(atlas.glyph('\t'), atlas.glyph('?'));
+  EXPECT_EQ(atlas.glyph(static_cast<char>(0x7F)), atlas.glyph('?'));
+  EXPECT_EQ(atlas.glyph(static_cast<char>(0xB0)), atlas.glyph('?')); // e.g. a UTF-8 byte of a degree sign
+}
+
+TEST(LineBitmap, DrawTextMatchesGfxAtAnyOffset)
+{
+  GlyphAtlas atlas = built_atlas();
+  const char *text = "Heating 1420 W ~|@";
+  for (int x : {0, 1, 3, 7, 8, 13})
+  {
+    LineBitmap line;
+    line.clear();
+    EXPECT_EQ(line.draw_text(atlas, x, text), x + GLYPH_ADVANCE * static_cast<int>(strlen(text)));
+    expect_same(line, gfx_line(x, text));
+  }
+}
+
+TEST(LineBitmap, TextPastTheRightEdgeIsCutOff)
+{
+  GlyphAtlas atlas = built_atlas();
+  std::string text(60, 'W');
+  LineBitmap line;
+  line.clear();
+  // 42 whole glyphs fit in 256 px from x = 2; the 43rd would end at 260
+  int end = line.draw_text(atlas, 2, text.c_str());
+  EXPECT_EQ(end, 2 + 42 * GLYPH_ADVANCE);
+  GFXcanvas1 canvas = gfx_line(2, std::string(42, 'W').c_str());
+  expect_same(line, canvas);
+  // Further text starts where the last one stopped and is cut off just the same
+  EXPECT_EQ(line.draw_text(atlas, end, "W"), end);
+}
+
+TEST(LineBitmap, CopyToReplacesFromXToTheRightEdge)
+{
+  GlyphAtlas atlas = built_atlas();
+  LineBitmap line;
+  line.clear();
+  line.draw_text(atlas, 0, "AB");
+
+  const int width = 100;
+  const int height = 12;
+  const int stride = (width + 7) / 8;
+  uint8_t frame[height * stride];
+  memset(frame, 0xFF, sizeof(frame));
+  line.copy_to(frame, stride, width, height, 21, 5);
+
+  GFXcanvas1 expected = gfx_line(21, "AB");
+  for (int y = 0; y < height; y++)
+  {
+    for (int x = 0; x < width; x++)
+    {
+      bool in_line = y >= 5 && x >= 21;
+      bool want = in_line ? expected.getPixel(x, y - 5) : true;
+      ASSERT_EQ(bit(frame, stride, x, y), want) << x << "," << y;
+    }
+  }
+}
+
+TEST(LineBitmap, CopyToClipsAtTheFrameEdges)
+{
+  GlyphAtlas atlas = built_atlas();
+  LineBitmap line;
+  line.clear();
+  line.draw_text(atlas, 0, "888888");
+
+  const int width = 20;
+  const int height = 4;
+  const int stride = 4; // one spare byte past the frame width, which must stay untouched
+  uint8_t frame[height * stride + 1];
+  memset(frame, 0xAA, sizeof(frame));
+  line.copy_to(frame, stride, width, height, 3, 1);
+  for (int y = 0; y < height; y++)
+    EXPECT_EQ(frame[y * stride + 3], 0xAA) << "row " << y;
+  EXPECT_EQ(frame[height * stride], 0xAA);
+
+  // Off the frame altogether: nothing changes
+  uint8_t before[sizeof(frame)];
+  memcpy(before, frame, sizeof(frame));
+  line.copy_to(frame, stride, width, height, width, 0);
+  line.copy_to(frame, stride, width, height, -1, 0);
+  EXPECT_EQ(memcmp(before, frame, sizeof(frame)), 0);
+}
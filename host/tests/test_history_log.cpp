@@ -0,0 +1,338 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+#include "history_log.h"
+
+using namespace esphome::esphiBoost;
+
+namespace
+{
+  // NOR flash kept in a temporary file: writes can only clear bits, erase sets a
+  // sector back to 0xFF. Writes can be made to fail, optionally after programming
+  // part of the data, the way a brown-out or a flash error leaves them.
+  class FileFlash : public FlashRegion
+  {
+  public:
+    explicit FileFlash(size_t sectors) : size_(sectors * HISTORY_SECTOR_SIZE), file_(tmpfile())
+    {
+      std::vector<uint8_t> blank(size_, 0xFF);
+      fwrite(blank.data(), 1, blank.size(), file_);
+    }
+    ~FileFlash() override { fclose(file_); }
+
+    bool read(size_t offset, void *data, size_t length) override
+    {
+      if (offset + length > size_)
+        return false;
+      fseek(file_, static_cast<long>(offset), SEEK_SET);
+      return fread(data, 1, length, file_) == length;
+    }
+
+    bool write(size_t offset, const void *data, size_t length) override
+    {
+      if (offset + length > size_)
+        return false;
+      bool fail = false;
+      if (good_writes > 0)
+        good_writes--;
+      else if (failing_writes > 0)
+      {
+        failing_writes--;
+        fail = true;
+        if (length > torn_bytes)
+          length = torn_bytes;
+      }
+      std::vector<uint8_t> cells(length);
+      read(offset, cells.data(), length);
+      for (size_t i = 0; i < length; i++)
+        cells[i] &= static_cast<const uint8_t *>(data)[i];
+      poke(offset, cells.data(), length);
+      return !fail;
+    }
+
+    bool erase_sector(size_t offset) override
+    {
+      if (failing_erases > 0)
+      {
+        failing_erases--;
+        return false;
+      }
+      std::vector<uint8_t> blank(HISTORY_SECTOR_SIZE, 0xFF);
+      poke(offset - offset % HISTORY_SECTOR_SIZE, blank.data(), blank.size());
+      return true;
+    }
+
+    size_t size() const override { return size_; }
+
+    // Sets bytes directly, as corruption would
+    void poke(size_t offset, const void *data, size_t length)
+    {
+      fseek(file_, static_cast<long>(offset), SEEK_SET);
+      fwrite(data, 1, length, file_);
+      fflush(file_);
+    }
+
+    int good_writes = 0;    // before failing_writes start
+    int failing_writes = 0;
+    int failing_erases = 0;
+    size_t torn_bytes = 0; // programmed by a failing write before it gives up
+
+  protected:
+    size_t size_;
+    FILE *file_;
+  };
+
+  HistoryRecord record(uint32_t n)
+  {
+    HistoryRecord r{};
+    r.type = HISTORY_RECORD_COUNTERS;
+    r.address = 0x1234;
+    r.time = n;
+    for (size_t i = 0; i < sizeof(r.payload); i++)
+      r.payload[i] = static_cast<uint8_t>(n + i);
+    return r;
+  }
+
+  size_t slot_offset(size_t sector, size_t slot) { return sector * HISTORY_SECTOR_SIZE + (slot + 1) * HISTORY_RECORD_SIZE; }
+
+  uint32_t header_sequence(FlashRegion &flash, size_t sector)
+  {
+    uint32_t header[2];
+    flash.read(sector * HISTORY_SECTOR_SIZE, header, sizeof(header));
+    return header[0] == HISTORY_MAGIC ? header[1] : 0;
+  }
+
+  // Reads the log back the way tools/iboost_history.py does: sectors oldest first by
+  // sequence, records up to the first erased slot, bad checksums counted and skipped
+  struct Contents
+  {
+    std::vector<uint32_t> times;
+    size_t corrupt = 0;
+  };
+
+  Contents read_back(FlashRegion &flash)
+  {
+    std::vector<std::pair<uint32_t, size_t>> sectors;
+    for (size_t sector = 0; sector < flash.size() / HISTORY_SECTOR_SIZE; sector++)
+    {
+      uint32_t header[2];
+      flash.read(sector * HISTORY_SECTOR_SIZE, header, sizeof(header));
+      if (header[0] == HISTORY_MAGIC)
+        sectors.push_back({header[1], sector});
+    }
+    std::sort(sectors.begin(), sectors.end(), [](const std::pair<uint32_t, size_t> &a, const std::pair<uint32_t, size_t> &b) {
+      return static_cast<int32_t>(a.first - b.first) < 0;
+    });
+    Contents contents;
+    for (const auto &sector : sectors)
+    {
+      for (size_t slot = 0; slot < HISTORY_RECORDS_PER_SECTOR; slot++)
+      {
+        HistoryRecord r;
+        flash.read(slot_offset(sector.second, slot), &r, sizeof(r));
+        if (r.type == 0xFF)
+          break;
+        if (r.check != HistoryLog::checksum(r))
+          contents.corrupt++;
+        else
+          contents.times.push_back(r.time);
+      }
+    }
+    return contents;
+  }
+
+  std::vector<uint32_t> range(uint32_t first, uint32_t last)
+  {
+    std::vector<uint32_t> times;
+    for (uint32_t n = first; n <= last; n++)
+      times.push_back(n);
+    return times;
+  }
+} // namespace
+
+TEST(HistoryLog, FormatsAnEmptyRegionAndBatchesWrites)
+{
+  FileFlash flash(4);
+  HistoryLog log;
+  ASSERT_TRUE(log.begin(&flash));
+  EXPECT_EQ(header_sequence(flash, 0), 1u);
+  EXPECT_EQ(log.get_erases(), 1u);
+
+  for (uint32_t n = 1; n <= 2 * HISTORY_BATCH_RECORDS + 3; n++)
+    log.append(record(n));
+  EXPECT_EQ(log.get_writes(), 2u);
+  EXPECT_EQ(log.get_pending(), 3u);
+  EXPECT_EQ(read_back(flash).times, range(1, 2 * HISTORY_BATCH_RECORDS));
+
+  ASSERT_TRUE(log.flush());
+  EXPECT_EQ(read_back(flash).times, range(1, 2 * HISTORY_BATCH_RECORDS + 3));
+}
+
+TEST(HistoryLog, WrapsAroundTheRegion)
+{
+  FileFlash flash(3);
+  HistoryLog log;
+  ASSERT_TRUE(log.begin(&flash));
+  uint32_t total = 3 * HISTORY_RECORDS_PER_SECTOR + 10;
+  for (uint32_t n = 1; n <= total; n++)
+    log.append(record(n));
+  ASSERT_TRUE(log.flush());
+
+  // Sector 0 was erased again for the newest records; the oldest sector went with it
+  EXPECT_EQ(header_sequence(flash, 0), 4u);
+  EXPECT_EQ(header_sequence(flash, 1), 2u);
+  EXPECT_EQ(header_sequence(flash, 2), 3u);
+  EXPECT_EQ(log.get_erases(), 4u);
+  Contents contents = read_back(flash);
+  EXPECT_EQ(contents.corrupt, 0u);
+  EXPECT_EQ(contents.times, range(HISTORY_RECORDS_PER_SECTOR + 1, total));
+}
+
+TEST(HistoryLog, ResumesAfterARebootWhereItLeftOff)
+{
+  FileFlash flash(3);
+  uint32_t total = 2 * HISTORY_RECORDS_PER_SECTOR + 5;
+  {
+    HistoryLog log;
+    ASSERT_TRUE(log.begin(&flash));
+    for (uint32_t n = 1; n <= total; n++)
+      log.append(record(n));
+    ASSERT_TRUE(log.flush());
+  }
+
+  HistoryLog log;
+  ASSERT_TRUE(log.begin(&flash));
+  EXPECT_EQ(log.get_erases(), 0u); // nothing reformatted
+  log.append(record(total + 1));
+  ASSERT_TRUE(log.flush());
+  EXPECT_EQ(read_back(flash).times, range(1, total + 1));
+}
+
+TEST(HistoryLog, NewestSectorSurvivesSequenceWrap)
+{
+  FileFlash flash(3);
+  {
+    HistoryLog log;
+    ASSERT_TRUE(log.begin(&flash));
+  }
+  // Sequences running over the top of the range: sector 2 is the newest
+  const uint32_t SEQUENCES[] = {UINT32_MAX - 1, UINT32_MAX, 0};
+  for (size_t sector = 0; sector < 3; sector++)
+  {
+    uint32_t header[2] = {HISTORY_MAGIC, SEQUENCES[sector]};
+    uint8_t version = HISTORY_VERSION;
+    flash.poke(sector * HISTORY_SECTOR_SIZE, header, sizeof(header));
+    flash.poke(sector * HISTORY_SECTOR_SIZE + sizeof(header), &version, 1);
+  }
+
+  HistoryLog log;
+  ASSERT_TRUE(log.begin(&flash));
+  log.append(record(7));
+  ASSERT_TRUE(log.flush());
+  HistoryRecord r;
+  flash.read(slot_offset(2, 0), &r, sizeof(r));
+  EXPECT_EQ(r.time, 7u);
+}
+
+TEST(HistoryLog, TornRecordIsNeitherReusedNorTrusted)
+{
+  FileFlash flash(3);
+  {
+    HistoryLog log;
+    ASSERT_TRUE(log.begin(&flash));
+    for (uint32_t n = 1; n <= HISTORY_BATCH_RECORDS; n++)
+      log.append(record(n));
+    // Power lost part way through the next batch: only its first 40 bytes made it
+    for (uint32_t n = HISTORY_BATCH_RECORDS + 1; n < 2 * HISTORY_BATCH_RECORDS; n++)
+      log.append(record(n));
+    flash.failing_writes = 1;
+    flash.torn_bytes = 40;
+    log.append(record(2 * HISTORY_BATCH_RECORDS));
+  }
+
+  HistoryLog log;
+  ASSERT_TRUE(log.begin(&flash));
+  log.append(record(100));
+  ASSERT_TRUE(log.flush());
+  // The complete record before the tear stays, the torn one fails its checksum, and
+  // the log carries on after it rather than writing over programmed bits
+  Contents contents = read_back(flash);
+  std::vector<uint32_t> expected = range(1, HISTORY_BATCH_RECORDS + 1);
+  expected.push_back(100);
+  EXPECT_EQ(contents.times, expected);
+  EXPECT_EQ(contents.corrupt, 1u);
+}
+
+TEST(HistoryLog, CorruptRecordFailsItsChecksum)
+{
+  FileFlash flash(2);
+  HistoryLog log;
+  ASSERT_TRUE(log.begin(&flash));
+  for (uint32_t n = 1; n <= HISTORY_BATCH_RECORDS; n++)
+    log.append(record(n));
+  uint8_t flipped = 0x00;
+  flash.poke(slot_offset(0, 3) + 10, &flipped, 1);
+  Contents contents = read_back(flash);
+  EXPECT_EQ(contents.corrupt, 1u);
+  EXPECT_EQ(contents.times.size(), HISTORY_BATCH_RECORDS - 1);
+}
+
+TEST(HistoryLog, FailedWriteIsRetriedWithoutDuplicates)
+{
+  FileFlash flash(3);
+  HistoryLog log;
+  ASSERT_TRUE(log.begin(&flash));
+  // Fill up to four slots short of the sector end, so the next batch spans two sectors
+  uint32_t n = 0;
+  while (n < HISTORY_RECORDS_PER_SECTOR - 4)
+    log.append(record(++n));
+  ASSERT_TRUE(log.flush());
+
+  // The run into the new sector fails after programming some bytes...
+  flash.good_writes = 2; // the four records that fit, and the new sector's header
+  flash.failing_writes = 1;
+  flash.torn_bytes = 50;
+  for (size_t i = 0; i < HISTORY_BATCH_RECORDS; i++)
+    log.append(record(++n));
+  EXPECT_EQ(log.get_pending(), 4u);
+
+  // ...and the retry writes each remaining record exactly once
+  ASSERT_TRUE(log.flush());
+  EXPECT_EQ(log.get_pending(), 0u);
+  Contents contents = read_back(flash);
+  EXPECT_EQ(contents.corrupt, 0u);
+  EXPECT_EQ(contents.times, range(1, n));
+}
+
+TEST(HistoryLog, PersistentFailureDropsNewRecordsInsteadOfOverrunning)
+{
+  FileFlash flash(2);
+  HistoryLog log;
+  ASSERT_TRUE(log.begin(&flash));
+  flash.failing_writes = 1000;
+  for (uint32_t n = 1; n <= 5 * HISTORY_BATCH_RECORDS; n++)
+    log.append(record(n));
+  EXPECT_TRUE(log.is_ready());
+  EXPECT_EQ(log.get_pending(), HISTORY_BATCH_RECORDS);
+  EXPECT_EQ(log.get_dropped(), 4 * HISTORY_BATCH_RECORDS);
+  EXPECT_EQ(log.get_records(), 0u);
+
+  // Once flash works again the batch that was held goes out, in order
+  flash.failing_writes = 0;
+  ASSERT_TRUE(log.flush());
+  EXPECT_EQ(read_back(flash).times, range(1, HISTORY_BATCH_RECORDS));
+}
+
+TEST(HistoryLog, FailedEraseClosesTheLog)
+{
+  FileFlash flash(2);
+  HistoryLog log;
+  ASSERT_TRUE(log.begin(&flash));
+  flash.failing_erases = 1;
+  for (uint32_t n = 1; n <= HISTORY_RECORDS_PER_SECTOR + 2 * HISTORY_BATCH_RECORDS; n++)
+    log.append(record(n));
+  EXPECT_FALSE(log.is_ready());
+  EXPECT_LE(log.get_pending(), HISTORY_BATCH_RECORDS);
+  EXPECT_FALSE(log.flush());
+}
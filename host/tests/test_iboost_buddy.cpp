@@ -0,0 +1,305 @@
+#include <gtest/gtest.h>
+#include <esp_partition.h>
+#include "esphiBoost.h"
+#include "esphome/components/sx126x/sx126x.h"
+#include "esphome/components/web_server_base/web_server_base.h"
+#include "frames.h"
+#include "host_app.h"
+
+using namespace esphome;
+using namespace esphome::esphiBoost;
+
+namespace
+{
+  // One iBoostBuddy wired to the fake radio the way the example YAML wires it
+  struct Rig
+  {
+    explicit Rig(uint32_t restore_hash = 0)
+    {
+      radio.add_on_packet_callback([this](const std::vector<uint8_t> &x, float rssi, float) { buddy.process_packet(x, rssi); });
+      buddy.set_radio(&radio);
+      buddy.set_heating_mode(&mode);
+      buddy.set_heating_power(&power);
+      buddy.set_heating_import(&import_power);
+      buddy.set_heating_today(&today);
+      buddy.set_heating_last_gt(&total);
+      if (restore_hash != 0)
+        buddy.set_restore(restore_hash);
+      app.add(&buddy);
+    }
+
+    // Delivers a frame and lets loop() pick it up
+    void receive(const std::vector<uint8_t> &frame, float rssi = -80.0f)
+    {
+      radio.inject(frame, rssi);
+      app.step();
+    }
+
+    sx126x::SX126x radio;
+    iBoostBuddy buddy;
+    text_sensor::TextSensor mode;
+    sensor::Sensor power;
+    sensor::Sensor import_power;
+    sensor::Sensor today;
+    sensor::Sensor total;
+    host::App app;
+  };
+
+  class BuddyTest : public ::testing::Test
+  {
+  protected:
+    void SetUp() override
+    {
+      host::set_micros(5000000);
+      global_preferences->host_store.clear();
+    }
+  };
+} // namespace
+
+TEST_F(BuddyTest, PublishesIBoostStatus)
+{
+  Rig rig;
+  rig.app.setup();
+  EXPECT_EQ(rig.mode.state, "Initializing...");
+
+  frames::IBoostStatus status;
+  status.power = 1500;
+  status.import_raw = 360 * 200;
+  rig.receive(frames::iboost(status));
+
+  EXPECT_FLOAT_EQ(rig.power.state, 1500.0f);
+  EXPECT_FLOAT_EQ(rig.import_power.state, 200.0f);
+  EXPECT_EQ(rig.mode.state, "ON: Heating from Solar");
+  EXPECT_FLOAT_EQ(rig.buddy.get_live_state().power, 1500.0f);
+}
+
+TEST_F(BuddyTest, PollsOnceTheSystemIsKnownAndTakesTheReply)
+{
+  Rig rig;
+  rig.app.setup();
+  rig.app.step();
+  EXPECT_TRUE(rig.radio.transmitted.empty()); // nobody to ask yet
+
+  rig.receive(frames::iboost({}));
+  rig.app.run_for(10000);
+  ASSERT_FALSE(rig.radio.transmitted.empty());
+  const std::vector<uint8_t> &request = rig.radio.transmitted.back();
+  ASSERT_EQ(request.size(), BUDDY_CONTROL_FRAME_LENGTH);
+  EXPECT_EQ(request[0], 0x12);
+  EXPECT_EQ(request[1], 0x34);
+  EXPECT_EQ(request[2], PACKET_TYPE_BUDDY);
+  EXPECT_EQ(request[3], BUDDY_COMMAND_REQUEST_DATA);
+  uint8_t code = request[12];
+
+  frames::IBoostStatus reply;
+  reply.data_code = code;
+  reply.data_value = 4321;
+  rig.receive(frames::iboost(reply));
+  sensor::Sensor &expected = code == DATA_REQUEST_TODAY ? rig.today : rig.total;
+  EXPECT_FLOAT_EQ(expected.state, 4321.0f);
+}
+
+TEST_F(BuddyTest, ReplyLatencyIsTakenFromTheReceiveTime)
+{
+  Rig rig;
+  sensor::Sensor p99;
+  rig.buddy.set_latency_p99(&p99);
+  rig.app.setup();
+  rig.receive(frames::iboost({}));
+  size_t sent = rig.radio.transmitted.size();
+  while (rig.radio.transmitted.size() == sent)
+    rig.app.run_for(16);
+
+  host::advance_millis(40);
+  frames::IBoostStatus reply;
+  reply.data_code = rig.radio.transmitted.back()[12];
+  reply.data_value = 1;
+  rig.radio.inject(frames::iboost(reply), -80.0f);
+  host::advance_millis(1200); // loop() held up after the reply arrived
+  rig.app.step();
+  rig.app.run_for(30000);
+  ASSERT_TRUE(p99.has_state());
+  EXPECT_LE(p99.state, 100.0f);
+}
+
+TEST_F(BuddyTest, IgnoresNeighbouringSystems)
+{
+  Rig rig;
+  rig.app.setup();
+  frames::IBoostStatus ours;
+  ours.power = 100;
+  rig.receive(frames::iboost(ours), -70.0f);
+
+  frames::IBoostStatus theirs;
+  theirs.address = 0x9999;
+  theirs.power = 2000;
+  for (int i = 0; i < 20; i++)
+  {
+    rig.app.run_for(10000);
+    theirs.data_value = i; // not a repeat
+    rig.receive(frames::iboost(theirs), -50.0f);
+  }
+  EXPECT_FLOAT_EQ(rig.power.state, 100.0f);
+}
+
+TEST_F(BuddyTest, WarmStartPollsWithoutWaitingForTraffic)
+{
+  {
+    Rig first(0x5A5A);
+    first.app.setup();
+    frames::IBoostStatus status;
+    status.data_code = DATA_REQUEST_TOTAL;
+    status.data_value = 987654;
+    first.receive(frames::iboost(status));
+    first.buddy.on_safe_shutdown();
+  }
+
+  Rig second(0x5A5A);
+  second.app.setup();
+  EXPECT_FLOAT_EQ(second.total.state, 987654.0f); // restored, not re-polled
+  second.app.step();
+  ASSERT_FALSE(second.radio.transmitted.empty());
+  EXPECT_EQ(second.radio.transmitted[0][0], 0x12);
+  EXPECT_EQ(second.radio.transmitted[0][1], 0x34);
+}
+
+TEST_F(BuddyTest, RepeatedFrameIsHandledOnce)
+{
+  Rig rig;
+  rig.app.setup();
+  frames::IBoostStatus status;
+  status.power = 700;
+  auto frame = frames::iboost(status);
+  rig.receive(frame);
+  uint32_t publishes = rig.power.get_publish_count();
+
+  status.power = 800;
+  auto changed = frames::iboost(status);
+  rig.radio.inject(changed, -80.0f);
+  rig.radio.inject(changed, -80.0f);
+  rig.app.step();
+  EXPECT_FLOAT_EQ(rig.power.state, 800.0f);
+  EXPECT_EQ(rig.power.get_publish_count(), publishes + 1);
+}
+
+TEST_F(BuddyTest, PublishPolicyFollowsTheUnit)
+{
+  Rig rig;
+  rig.buddy.set_publish_deadband(PUBLISH_CLASS_ENERGY, 50.0f);
+  rig.app.setup();
+  frames::IBoostStatus status;
+  status.power = 700;
+  status.data_code = DATA_REQUEST_TODAY;
+  status.data_value = 1000;
+  rig.receive(frames::iboost(status));
+  uint32_t power_publishes = rig.power.get_publish_count();
+  uint32_t today_publishes = rig.today.get_publish_count();
+
+  // Within the default power deadband, and within the one set for energy
+  status.power = 705;
+  status.data_value = 1040;
+  rig.receive(frames::iboost(status));
+  EXPECT_EQ(rig.power.get_publish_count(), power_publishes);
+  EXPECT_EQ(rig.today.get_publish_count(), today_publishes);
+
+  // Beyond both
+  status.power = 720;
+  status.data_value = 1060;
+  rig.receive(frames::iboost(status));
+  EXPECT_FLOAT_EQ(rig.power.state, 720.0f);
+  EXPECT_FLOAT_EQ(rig.today.state, 1060.0f);
+}
+
+TEST_F(BuddyTest, EachInstanceLogsHistoryToItsOwnPartition)
+{
+  uint8_t *first_log = host::add_partition("iboost_log", 2 * HISTORY_SECTOR_SIZE);
+  uint8_t *second_log = host::add_partition("iboost_log_2", 2 * HISTORY_SECTOR_SIZE);
+  Rig first;
+  Rig second;
+  first.buddy.set_history_partition("iboost_log");
+  second.buddy.set_history_partition("iboost_log_2");
+  first.app.setup();
+  second.app.setup();
+
+  frames::IBoostStatus status;
+  status.data_value = 4321;
+  first.receive(frames::iboost(status));
+  first.app.run_for(3601000, 1000); // past the hourly append
+  first.buddy.on_safe_shutdown();
+  second.buddy.on_safe_shutdown();
+
+  EXPECT_EQ(first_log[HISTORY_RECORD_SIZE], HISTORY_RECORD_COUNTERS);
+  EXPECT_EQ(second_log[0], HISTORY_MAGIC & 0xFF); // formatted...
+  EXPECT_EQ(second_log[HISTORY_RECORD_SIZE], 0xFF); // ...but nothing from the first instance
+  host::remove_partitions();
+}
+
+TEST_F(BuddyTest, TodayEstimateRestartsAtMidnight)
+{
+  Rig rig;
+  time::RealTimeClock rtc;
+  sensor::Sensor estimate;
+  rig.buddy.set_time(&rtc);
+  rig.buddy.set_heating_today_estimate(&estimate);
+  rig.app.setup();
+  rtc.host_set_utc(1760745600 - 60); // 23:59 UTC
+
+  frames::IBoostStatus status;
+  status.power = 3600;
+  status.data_code = DATA_REQUEST_TODAY;
+  status.data_value = 9000;
+  rig.receive(frames::iboost(status));
+  status.data_code = 0;
+  for (int i = 0; i < 5; i++)
+  {
+    rig.app.run_for(10000);
+    rig.receive(frames::iboost(status));
+  }
+  ASSERT_NEAR(estimate.state, 9050.0f, 1.0f);
+
+  // Past midnight the estimate counts from zero, not from yesterday's total
+  for (int i = 0; i < 3; i++)
+  {
+    rig.app.run_for(10000);
+    rig.receive(frames::iboost(status));
+  }
+  EXPECT_LT(estimate.state, 40.0f);
+  EXPECT_GT(estimate.state, 0.0f);
+}
+
+TEST_F(BuddyTest, WebRequestsPickTheInstanceById)
+{
+  web_server_base::WebServerBase server;
+  web_server_base::global_web_server_base = &server;
+  Rig first;
+  Rig second;
+  first.buddy.set_instance_id("upstairs");
+  second.buddy.set_instance_id("garage");
+  first.buddy.set_capture_frames(8);
+  second.buddy.set_capture_frames(8);
+  first.app.setup();
+  second.app.setup();
+  first.receive(frames::iboost({}));
+  second.receive(frames::buddy(0x1234));
+  second.app.run_for(1100);
+  second.receive(frames::buddy(0x1234, 1));
+
+  auto capture = [&](const char *id) -> std::vector<uint8_t> {
+    AsyncWebServerRequest request(HTTP_GET, "/iboost/capture");
+    if (id != nullptr)
+      request.host_add_arg("id", id);
+    if (!server.host_handle(&request))
+      return {};
+    return request.host_response()->body;
+  };
+  std::vector<uint8_t> first_dump, second_dump;
+  first.buddy.dump_capture(first_dump);
+  second.buddy.dump_capture(second_dump);
+  ASSERT_NE(first_dump, second_dump);
+
+  EXPECT_EQ(capture("upstairs"), first_dump);
+  EXPECT_EQ(capture("garage"), second_dump);
+  EXPECT_EQ(capture(nullptr), first_dump); // no id: the first instance, as with a single one
+  EXPECT_TRUE(capture("loft").empty());
+  web_server_base::global_web_server_base = nullptr;
+}
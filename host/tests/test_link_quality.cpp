@@ -0,0 +1,105 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include "link_quality.h"
+
+using namespace esphome::esphiBoost;
+
+TEST(LinkQuality, LearnsPeriodAndCountsGaps)
+{
+  LinkQuality link;
+  uint32_t t = 0;
+  for (int i = 0; i < 20; i++, t += 10000)
+    link.add(-80.0f, t + (i % 2 ? 30 : -30));
+  EXPECT_NEAR(link.get_interval_ms(), 10000.0f, 100.0f);
+
+  LinkWindow window = link.take_window(t);
+  EXPECT_EQ(window.received, 20u);
+  EXPECT_EQ(window.missed, 0u);
+  EXPECT_FLOAT_EQ(window.loss_percent(), 0.0f);
+
+  // Two frames lost, then one heard
+  t += 20000;
+  link.add(-80.0f, t);
+  window = link.take_window(t);
+  EXPECT_EQ(window.received, 1u);
+  EXPECT_EQ(window.missed, 2u);
+}
+
+TEST(LinkQuality, OverdueFramesAreChargedOnce)
+{
+  LinkQuality link;
+  for (uint32_t t = 0; t <= 50000; t += 10000)
+    link.add(-70.0f, t);
+  link.take_window(50000);
+
+  // Silence: 3 frames overdue at the window close...
+  LinkWindow window = link.take_window(85000);
+  EXPECT_EQ(window.received, 0u);
+  EXPECT_EQ(window.missed, 3u);
+  // ...and only the rest once the gap ends
+  link.add(-70.0f, 100000);
+  window = link.take_window(100000);
+  EXPECT_EQ(window.missed, 1u);
+  EXPECT_EQ(window.received, 1u);
+}
+
+TEST(LinkQuality, RssiAverageAndRange)
+{
+  LinkQuality link;
+  EXPECT_TRUE(std::isnan(link.get_rssi_average()));
+  link.add(-90.0f, 0);
+  EXPECT_FLOAT_EQ(link.get_rssi_average(), -90.0f);
+  link.add(-70.0f, 10000);
+  EXPECT_FLOAT_EQ(link.get_rssi_average(), -90.0f + LINK_RSSI_ALPHA * 20.0f);
+  LinkWindow window = link.take_window(10000);
+  EXPECT_FLOAT_EQ(window.rssi_min, -90.0f);
+  EXPECT_FLOAT_EQ(window.rssi_max, -70.0f);
+  EXPECT_TRUE(std::isnan(link.take_window(10001).loss_percent()));
+}
+
+TEST(LinkQuality, ShortFirstGapDoesNotSetThePeriod)
+{
+  // A reply 200 ms after the first status frame, then the unit's usual 10 s period
+  LinkQuality link;
+  link.add(-80.0f, 0);
+  link.add(-80.0f, 200);
+  uint32_t t = 0;
+  for (int i = 1; i <= 30; i++)
+    link.add(-80.0f, t = i * 10000 + (i % 2 ? 40 : -40));
+  EXPECT_TRUE(link.is_settled());
+  EXPECT_NEAR(link.get_interval_ms(), 10000.0f, 100.0f);
+  LinkWindow window = link.take_window(t);
+  EXPECT_EQ(window.received, 32u);
+  EXPECT_EQ(window.missed, 0u);
+
+  // Once settled, another reply between two periods is extra and the schedule holds
+  link.add(-80.0f, t + 200);
+  link.add(-80.0f, t + 10000);
+  link.add(-80.0f, t + 30000);
+  window = link.take_window(t + 30000);
+  EXPECT_EQ(window.received, 3u);
+  EXPECT_EQ(window.missed, 1u);
+  EXPECT_NEAR(link.get_interval_ms(), 10000.0f, 100.0f);
+}
+
+TEST(LinkQuality, RelearnsAPeriodThatChanged)
+{
+  LinkQuality link;
+  uint32_t t = 0;
+  for (int i = 0; i < 10; i++, t += 10000)
+    link.add(-80.0f, t);
+  ASSERT_TRUE(link.is_settled());
+
+  // Every 15 s from here; a few gaps are charged before the period is relearnt
+  t -= 10000;
+  for (int i = 0; i < 10; i++)
+    link.add(-80.0f, t += 15000);
+  EXPECT_TRUE(link.is_settled());
+  EXPECT_NEAR(link.get_interval_ms(), 15000.0f, 100.0f);
+  link.take_window(t);
+  for (int i = 0; i < 10; i++)
+    link.add(-80.0f, t += 15000);
+  LinkWindow window = link.take_window(t);
+  EXPECT_EQ(window.received, 10u);
+  EXPECT_EQ(window.missed, 0u);
+}
@@ -0,0 +1,179 @@
+#include <gtest/gtest.h>
+#include <string>
+#include "esphWirelessPaper.h"
+#include "esphome/components/sx126x/sx126x.h"
+#include "esphome/components/web_server_base/web_server_base.h"
+#include "frames.h"
+#include "host_app.h"
+
+using namespace esphome;
+using namespace esphome::esphWirelessPaper;
+
+namespace
+{
+  // PaperDisplay on the fake panel, with its BUSY line wired as on the board
+  class PaperTest : public ::testing::Test
+  {
+  protected:
+    void SetUp() override
+    {
+      host::set_micros(5000000);
+      web_server_base::global_web_server_base = &server;
+      paper.set_TopTitle("iBoost");
+      paper.set_busy_pin(paper.display.host_busy_pin());
+      app.add(&paper);
+    }
+    void TearDown() override { web_server_base::global_web_server_base = nullptr; }
+
+    // Runs until the refresh in flight, and any it queued, have settled
+    void settle() { app.run_for(5000); }
+
+    // Pixels print() sets for `text`, as the GFX font has them
+    static uint32_t ink_pixels(const char *text)
+    {
+      uint32_t count = 0;
+      for (; *text != '\0'; text++)
+      {
+        for (int col = 0; col < 5; col++)
+          count += __builtin_popcount(HOST_GFX_FONT[*text - 0x20][col]);
+      }
+      return count;
+    }
+
+    bool row_has_ink(int y) const
+    {
+      for (int x = 0; x < EInkDisplay_WirelessPaperV1_1::PANEL_WIDTH; x++)
+      {
+        if (paper.display.host_shown_pixel(x, y))
+          return true;
+      }
+      return false;
+    }
+
+    web_server_base::WebServerBase server;
+    PaperDisplay paper;
+    host::App app;
+  };
+} // namespace
+
+TEST_F(PaperTest, FirstRefreshIsFastAndDrawsTitleAndStatus)
+{
+  app.setup();
+  settle();
+  EXPECT_EQ(paper.display.host_full_refreshes, 0u);
+  EXPECT_EQ(paper.display.host_fast_refreshes, 1u);
+  EXPECT_EQ(paper.display.host_draw_calls, 2u);
+  EXPECT_TRUE(row_has_ink(10)); // title
+  EXPECT_TRUE(row_has_ink(20)); // status
+  EXPECT_FALSE(row_has_ink(30)); // first data line
+  EXPECT_EQ(paper.get_refresh_count(), 1u);
+  EXPECT_EQ(paper.get_panel_busy_ms(), paper.display.fast_refresh_ms);
+}
+
+TEST_F(PaperTest, PushHoldsLoopForTheRefresh)
+{
+  // The driver's update() waits for the panel, and loop() with it; the time is counted
+  app.setup();
+  settle();
+  EXPECT_GE(paper.get_blocked_ms(), paper.display.fast_refresh_ms);
+  EXPECT_LT(paper.get_blocked_ms(), paper.display.fast_refresh_ms + 16);
+}
+
+TEST_F(PaperTest, SnapshotMatchesThePanel)
+{
+  app.setup();
+  paper.screen_writeDataLine(3, "Heating 1234 W");
+  settle();
+
+  AsyncWebServerRequest request(HTTP_GET, "/display/snapshot.pbm");
+  ASSERT_TRUE(server.host_handle(&request));
+  ASSERT_EQ(request.host_response()->code, 200);
+  const auto &body = request.host_response()->body;
+  std::string panel;
+  paper.display.host_render_pbm(panel);
+  size_t pixels = (EInkDisplay_WirelessPaperV1_1::PANEL_WIDTH + 7) / 8 * EInkDisplay_WirelessPaperV1_1::PANEL_HEIGHT;
+  ASSERT_GE(body.size(), pixels);
+  ASSERT_GE(panel.size(), pixels);
+  EXPECT_TRUE(std::equal(body.end() - pixels, body.end(), panel.end() - pixels,
+                         [](uint8_t a, char b) { return a == static_cast<uint8_t>(b); }));
+}
+
+TEST_F(PaperTest, OnlyChangedLinesAreRedrawn)
+{
+  app.setup();
+  paper.screen_writeDataLine(1, "first");
+  paper.screen_writeDataLine(2, "second");
+  settle();
+  uint32_t draws = paper.display.host_draw_calls;
+  uint32_t refreshes = paper.display.host_fast_refreshes;
+
+  paper.screen_writeDataLine(1, "first");
+  paper.update();
+  settle();
+  EXPECT_EQ(paper.display.host_fast_refreshes, refreshes);
+  EXPECT_EQ(paper.get_skipped_writes(), 1u);
+
+  uint32_t drawn = paper.display.host_pixels_drawn;
+  paper.screen_writeDataLine(2, "changed");
+  paper.update();
+  settle();
+  EXPECT_EQ(paper.display.host_fast_refreshes, refreshes + 1);
+  EXPECT_EQ(paper.display.host_draw_calls, draws + 1);
+  // The strip from x = 10 to the right edge, one line tall, then the text over it
+  EXPECT_EQ(paper.display.host_pixels_drawn - drawn, (250u - 10u) * 10u + ink_pixels("changed"));
+  EXPECT_EQ(paper.display.host_full_refreshes, 0u);
+}
+
+TEST_F(PaperTest, WritesDuringARefreshWaitForTheNextOne)
+{
+  app.setup();
+  while (paper.get_refresh_count() == 0)
+    app.run_for(16); // power-on delay, draw and push
+  // Still settling after the push
+  paper.screen_writeStatusLine("Connected");
+  app.step();
+  EXPECT_EQ(paper.display.host_fast_refreshes, 1u);
+  settle();
+  EXPECT_EQ(paper.display.host_fast_refreshes, 2u);
+  EXPECT_EQ(paper.get_panel_busy_ms(), paper.display.host_busy_ms);
+}
+
+TEST_F(PaperTest, LongTextWrapsOntoTheNextRows)
+{
+  app.setup();
+  // 45 characters from x = 10: the 41st no longer fits and goes to x = 0, 8 rows down
+  paper.screen_writeDataLine(1, std::string(45, 'W'));
+  settle();
+  bool wrapped = false;
+  for (int y = 38; y < 46; y++)
+  {
+    for (int x = 0; x < 5 * 6; x++)
+      wrapped = wrapped || paper.display.host_shown_pixel(x, y);
+  }
+  EXPECT_TRUE(wrapped);
+}
+
+TEST_F(PaperTest, DashboardFollowsTheIBoost)
+{
+  sx126x::SX126x radio;
+  esphiBoost::iBoostBuddy buddy;
+  buddy.set_radio(&radio);
+  radio.add_on_packet_callback([&](const std::vector<uint8_t> &x, float rssi, float) { buddy.process_packet(x, rssi); });
+  paper.set_iboost(&buddy);
+  app.add(&buddy);
+  app.setup();
+  settle();
+  EXPECT_TRUE(row_has_ink(30)); // Mode: Waiting for iBoost
+  EXPECT_TRUE(row_has_ink(40));
+  uint32_t draws = paper.display.host_draw_calls;
+
+  frames::IBoostStatus status;
+  status.power = 1500;
+  radio.inject(frames::iboost(status), -70.0f);
+  app.step();
+  paper.update();
+  settle();
+  // Mode, Heating, Today (the frame carries its counter) and RSSI changed; the rest stay "--"
+  EXPECT_EQ(paper.display.host_draw_calls - draws, 4u);
+  EXPECT_EQ(paper.display.host_full_refreshes, 0u);
+}
@@ -0,0 +1,140 @@
+#include <gtest/gtest.h>
+#include "frames.h"
+#include "iboost_protocol.h"
+
+using namespace esphome::esphiBoost;
+
+TEST(Protocol, DecodesIBoostStatus)
+{
+  frames::IBoostStatus status;
+  status.address = 0xA1B2;
+  status.boost_time = 45;
+  status.heating = true;
+  status.cylinder_hot = false;
+  status.overheated = true;
+  status.power = -1234;
+  status.import_raw = 360 * 2500;
+  status.data_code = DATA_REQUEST_TOTAL;
+  status.data_value = 0x01020304;
+  auto bytes = frames::iboost(status);
+
+  DecodedFrame frame;
+  ASSERT_EQ(decode_frame(bytes.data(), bytes.size(), frame), DECODE_OK);
+  EXPECT_EQ(frame.address0, 0xA1);
+  EXPECT_EQ(frame.address1, 0xB2);
+  EXPECT_EQ(frame.type, PACKET_TYPE_IBOOST);
+  EXPECT_EQ(frame.length, bytes.size());
+  EXPECT_EQ(frame.iboost.boost_time, 45);
+  EXPECT_TRUE(frame.iboost.water_heating);
+  EXPECT_FALSE(frame.iboost.cylinder_hot);
+  EXPECT_TRUE(frame.iboost.overheated);
+  EXPECT_EQ(frame.iboost.power_sent_to_tank, -1234);
+  EXPECT_EQ(frame.iboost.import_raw, 360 * 2500);
+  EXPECT_EQ(frame.iboost.data_code, DATA_REQUEST_TOTAL);
+  EXPECT_EQ(frame.iboost.data_value, 0x01020304);
+}
+
+TEST(Protocol, MinimumIBoostFrameReadsMissingTopByteAsZero)
+{
+  frames::IBoostStatus status;
+  status.data_value = 0x7F123456;
+  status.length = IBOOST_FRAME_MIN_LENGTH;
+  auto bytes = frames::iboost(status);
+
+  DecodedFrame frame;
+  ASSERT_EQ(decode_frame(bytes.data(), bytes.size(), frame), DECODE_OK);
+  EXPECT_EQ(frame.iboost.data_value, 0x123456);
+}
+
+TEST(Protocol, NegativeImportKeepsItsSign)
+{
+  frames::IBoostStatus status;
+  status.import_raw = -360 * 800;
+  auto bytes = frames::iboost(status);
+
+  DecodedFrame frame;
+  ASSERT_EQ(decode_frame(bytes.data(), bytes.size(), frame), DECODE_OK);
+  EXPECT_EQ(frame.iboost.import_raw, -360 * 800);
+}
+
+TEST(Protocol, DecodesSenderFrame)
+{
+  auto bytes = frames::sender(0x1234, 360 * 1500, true);
+
+  DecodedFrame frame;
+  ASSERT_EQ(decode_frame(bytes.data(), bytes.size(), frame), DECODE_OK);
+  EXPECT_EQ(frame.type, PACKET_TYPE_SENDER);
+  EXPECT_TRUE(frame.sender.battery_low);
+  EXPECT_EQ(frame.sender.import_raw, 360 * 1500);
+
+  bytes[12] = 0x02; // only 0x01 means low
+  ASSERT_EQ(decode_frame(bytes.data(), bytes.size(), frame), DECODE_OK);
+  EXPECT_FALSE(frame.sender.battery_low);
+}
+
+TEST(Protocol, RejectsMalformedFrames)
+{
+  DecodedFrame frame;
+  std::vector<uint8_t> runt = {0x12, 0x34};
+  EXPECT_EQ(decode_frame(runt.data(), runt.size(), frame), DECODE_TOO_SHORT);
+
+  auto short_frame = frames::header(0x1234, PACKET_TYPE_IBOOST, FRAME_MIN_LENGTH - 1);
+  EXPECT_EQ(decode_frame(short_frame.data(), short_frame.size(), frame), DECODE_INVALID_LENGTH);
+  EXPECT_EQ(frame.type, PACKET_TYPE_IBOOST); // the header is still filled in for logging
+
+  auto long_frame = frames::header(0x1234, PACKET_TYPE_IBOOST, FRAME_MAX_LENGTH + 1);
+  EXPECT_EQ(decode_frame(long_frame.data(), long_frame.size(), frame), DECODE_INVALID_LENGTH);
+
+  auto unknown = frames::header(0x1234, 0x55, 30);
+  EXPECT_EQ(decode_frame(unknown.data(), unknown.size(), frame), DECODE_UNKNOWN_TYPE);
+
+  auto iboost = frames::header(0x1234, PACKET_TYPE_IBOOST, IBOOST_FRAME_MIN_LENGTH - 1);
+  EXPECT_EQ(decode_frame(iboost.data(), iboost.size(), frame), DECODE_TOO_SHORT);
+  auto buddy = frames::header(0x1234, PACKET_TYPE_BUDDY, BUDDY_FRAME_MIN_LENGTH - 1);
+  EXPECT_EQ(decode_frame(buddy.data(), buddy.size(), frame), DECODE_TOO_SHORT);
+  auto sender = frames::header(0x1234, PACKET_TYPE_SENDER, SENDER_FRAME_MIN_LENGTH - 1);
+  EXPECT_EQ(decode_frame(sender.data(), sender.size(), frame), DECODE_TOO_SHORT);
+}
+
+TEST(Protocol, EncodesControlFrame)
+{
+  BuddyControlFrame control{0x12, 0x34, BUDDY_COMMAND_SET_BOOST, DATA_REQUEST_TODAY, 60};
+  BuddyControlBuffer out;
+  out.fill(0x55);
+  encode_control_frame(control, out);
+
+  const uint8_t expected[BUDDY_CONTROL_FRAME_LENGTH] = {
+      0x12, 0x34, PACKET_TYPE_BUDDY, BUDDY_COMMAND_SET_BOOST, 0x92, 0x07, 0x00, 0x00, 0x24, 0x00,
+      0xA0, 0xA0, DATA_REQUEST_TODAY, 0x00, 0xA0, 0xA0, 0xC8, 60, 0x00, 0x00,
+      0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
+  for (size_t i = 0; i < BUDDY_CONTROL_FRAME_LENGTH; i++)
+    EXPECT_EQ(out[i], expected[i]) << "byte " << i;
+
+  // What we send is a well-formed Buddy frame to anyone listening
+  DecodedFrame frame;
+  EXPECT_EQ(decode_frame(out.data(), out.size(), frame), DECODE_OK);
+  EXPECT_EQ(frame.type, PACKET_TYPE_BUDDY);
+}
+
+namespace
+{
+  struct Pair
+  {
+    uint8_t a;
+    int16_t b;
+  };
+  using PairSchema = FrameSchema<Field<&Pair::a, 4, CodecU8>, Field<&Pair::b, 1, CodecI16LE>>;
+} // namespace
+
+TEST(FrameSchema, MinimumLengthCoversTheLastField)
+{
+  static_assert(PairSchema::MIN_LENGTH == 5, "field at 4 ends the frame");
+  static_assert(FrameHeaderSchema::MIN_LENGTH == FRAME_HEADER_LENGTH, "");
+  static_assert(BuddyControlSchema::MIN_LENGTH == 18, "boost minutes is the last byte written");
+
+  const uint8_t bytes[] = {0xFF, 0x34, 0x82, 0xFF, 0x07};
+  Pair pair{};
+  PairSchema::decode(bytes, sizeof(bytes), pair);
+  EXPECT_EQ(pair.a, 0x07);
+  EXPECT_EQ(pair.b, static_cast<int16_t>(0x8234));
+}
@@ -0,0 +1,49 @@
+#include <gtest/gtest.h>
+#include "publish_filter.h"
+
+using namespace esphome::esphiBoost;
+
+TEST(PublishFilter, PublishesChangesOnly)
+{
+  PublishFilter filter;
+  PublishPolicy policy;
+  EXPECT_TRUE(filter.should_publish(10.0f, 0, policy));
+  EXPECT_FALSE(filter.should_publish(10.0f, 1000, policy));
+  EXPECT_TRUE(filter.should_publish(11.0f, 2000, policy));
+  EXPECT_EQ(filter.get_suppressed(), 1u);
+}
+
+TEST(PublishFilter, Deadband)
+{
+  PublishFilter filter;
+  PublishPolicy policy;
+  policy.deadband = 5.0f;
+  EXPECT_TRUE(filter.should_publish(100.0f, 0, policy));
+  EXPECT_FALSE(filter.should_publish(104.0f, 1, policy));
+  // Measured against the last published value, so slow drift still gets out
+  EXPECT_FALSE(filter.should_publish(105.0f, 2, policy));
+  EXPECT_TRUE(filter.should_publish(105.5f, 3, policy));
+}
+
+TEST(PublishFilter, MinAndMaxInterval)
+{
+  PublishFilter filter;
+  PublishPolicy policy;
+  policy.min_interval_ms = 1000;
+  policy.max_interval_ms = 60000;
+  EXPECT_TRUE(filter.should_publish(1.0f, 0, policy));
+  EXPECT_FALSE(filter.should_publish(2.0f, 500, policy)); // too soon
+  EXPECT_TRUE(filter.should_publish(2.0f, 1000, policy));
+  EXPECT_FALSE(filter.should_publish(2.0f, 60999, policy));
+  EXPECT_TRUE(filter.should_publish(2.0f, 61000, policy)); // unchanged but due
+}
+
+TEST(PublishFilter, TextComparedByContent)
+{
+  PublishFilter filter;
+  PublishPolicy policy;
+  char text[16] = "Heating";
+  EXPECT_TRUE(filter.should_publish(text, 0, policy));
+  EXPECT_FALSE(filter.should_publish("Heating", 1, policy));
+  EXPECT_TRUE(filter.should_publish("Off", 2, policy));
+}
@@ -0,0 +1,103 @@
+#include <gtest/gtest.h>
+#include "request_scheduler.h"
+
+using namespace esphome::esphiBoost;
+
+namespace
+{
+  const RequestScheduler::Slot &slot(const RequestScheduler &scheduler, uint8_t code)
+  {
+    return scheduler.get_slots()[code - DATA_REQUEST_TODAY];
+  }
+} // namespace
+
+TEST(RequestScheduler, AsksForEveryCodeOnceAtStart)
+{
+  RequestScheduler scheduler;
+  uint32_t now = 1000;
+  scheduler.on_iboost_frame(now);
+  for (uint8_t code = DATA_REQUEST_TODAY; code <= DATA_REQUEST_TOTAL; code++)
+  {
+    EXPECT_EQ(scheduler.next_request(now), code);
+    EXPECT_EQ(scheduler.get_last_decision(), SCHEDULE_DUE);
+    scheduler.on_request_sent(code, now);
+  }
+  // All in flight
+  EXPECT_EQ(scheduler.next_request(now), 0);
+  EXPECT_EQ(scheduler.get_last_decision(), SCHEDULE_IDLE);
+}
+
+TEST(RequestScheduler, MostOverdueCodeWins)
+{
+  RequestScheduler scheduler;
+  uint32_t now = 0;
+  scheduler.on_iboost_frame(now);
+  for (uint8_t code = DATA_REQUEST_TODAY; code <= DATA_REQUEST_TOTAL; code++)
+    scheduler.on_reply(code, 100, now);
+
+  // Today (10 s) and Total (30 s) are both due at 40 s; Today is four intervals old
+  now = 40000;
+  scheduler.on_iboost_frame(now);
+  EXPECT_EQ(scheduler.next_request(now), DATA_REQUEST_TODAY);
+  scheduler.on_request_sent(DATA_REQUEST_TODAY, now);
+  EXPECT_EQ(scheduler.next_request(now), DATA_REQUEST_TOTAL);
+}
+
+TEST(RequestScheduler, IntervalShrinksOnChangeAndGrowsWhileSteady)
+{
+  RequestScheduler scheduler;
+  scheduler.on_iboost_frame(0);
+  scheduler.on_reply(DATA_REQUEST_TOTAL, 1000, 0);
+  EXPECT_EQ(slot(scheduler, DATA_REQUEST_TOTAL).interval_ms, 30000u);
+
+  scheduler.on_reply(DATA_REQUEST_TOTAL, 1000, 30000);
+  EXPECT_EQ(slot(scheduler, DATA_REQUEST_TOTAL).interval_ms, 45000u);
+  for (int i = 0; i < 20; i++)
+    scheduler.on_reply(DATA_REQUEST_TOTAL, 1000, 60000 + i);
+  EXPECT_EQ(slot(scheduler, DATA_REQUEST_TOTAL).interval_ms, 600000u); // capped
+
+  scheduler.on_reply(DATA_REQUEST_TOTAL, 1001, 100000);
+  EXPECT_EQ(slot(scheduler, DATA_REQUEST_TOTAL).interval_ms, 300000u);
+  EXPECT_EQ(slot(scheduler, DATA_REQUEST_TOTAL).changes, 1);
+  for (int i = 0; i < 20; i++)
+    scheduler.on_reply(DATA_REQUEST_TOTAL, 1002 + i, 100000 + i);
+  EXPECT_EQ(slot(scheduler, DATA_REQUEST_TOTAL).interval_ms, 30000u); // floored
+}
+
+TEST(RequestScheduler, SuspendsWithoutIBoostAndProbes)
+{
+  RequestScheduler scheduler;
+  scheduler.on_iboost_frame(0);
+  uint32_t now = RequestScheduler::SUSPEND_AFTER_MS;
+  EXPECT_EQ(scheduler.next_request(now), DATA_REQUEST_TODAY);
+  EXPECT_EQ(scheduler.get_last_decision(), SCHEDULE_PROBE);
+  EXPECT_EQ(scheduler.next_request(now + 1000), 0);
+  EXPECT_EQ(scheduler.get_last_decision(), SCHEDULE_SUSPENDED);
+  EXPECT_EQ(scheduler.next_request(now + RequestScheduler::PROBE_INTERVAL_MS), DATA_REQUEST_TODAY);
+  EXPECT_EQ(scheduler.get_last_decision(), SCHEDULE_PROBE);
+
+  // Any iBoost frame resumes normal polling
+  now += RequestScheduler::PROBE_INTERVAL_MS + 1000;
+  scheduler.on_iboost_frame(now);
+  scheduler.next_request(now);
+  EXPECT_EQ(scheduler.get_last_decision(), SCHEDULE_DUE);
+}
+
+TEST(RequestScheduler, LostRequestBecomesEligibleAgain)
+{
+  RequestScheduler scheduler;
+  scheduler.on_iboost_frame(0);
+  EXPECT_EQ(scheduler.next_request(0), DATA_REQUEST_TODAY);
+  scheduler.on_request_sent(DATA_REQUEST_TODAY, 0);
+  EXPECT_NE(scheduler.next_request(0), DATA_REQUEST_TODAY);
+  scheduler.on_request_lost(DATA_REQUEST_TODAY);
+  EXPECT_EQ(scheduler.next_request(0), DATA_REQUEST_TODAY);
+}
+
+TEST(RequestScheduler, IntervalBoundsCanBeReplaced)
+{
+  RequestScheduler scheduler;
+  scheduler.set_interval_bounds(DATA_REQUEST_TODAY, 60000, 600000);
+  EXPECT_EQ(slot(scheduler, DATA_REQUEST_TODAY).interval_ms, 60000u);
+  EXPECT_EQ(slot(scheduler, DATA_REQUEST_TODAY).max_interval_ms, 600000u);
+}
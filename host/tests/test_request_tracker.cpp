@@ -0,0 +1,86 @@
+#include <gtest/gtest.h>
+#include "request_tracker.h"
+
+using namespace esphome::esphiBoost;
+
+TEST(RequestTracker, ReplyClosesTheRequestAndRecordsLatency)
+{
+  RequestTracker tracker;
+  tracker.on_sent(DATA_REQUEST_TODAY, 1000);
+  EXPECT_TRUE(tracker.is_in_flight(DATA_REQUEST_TODAY));
+  EXPECT_TRUE(tracker.on_reply(DATA_REQUEST_TODAY, 1120));
+  EXPECT_FALSE(tracker.is_in_flight(DATA_REQUEST_TODAY));
+  EXPECT_EQ(tracker.get_latency().get_count(), 1u);
+  EXPECT_GT(tracker.get_latency().percentile(50), 100.0f);
+  EXPECT_LE(tracker.get_latency().percentile(50), 150.0f);
+
+  // A reply nobody asked for
+  EXPECT_FALSE(tracker.on_reply(DATA_REQUEST_TODAY, 1200));
+  EXPECT_EQ(tracker.get_answered(), 1u);
+}
+
+TEST(RequestTracker, ReplyReceivedBeforeARetryGivesNoSample)
+{
+  RequestTracker tracker;
+  tracker.on_sent(DATA_REQUEST_TODAY, 1000);
+  tracker.on_sent(DATA_REQUEST_TODAY, 4000); // retried before the reply was handled
+  EXPECT_TRUE(tracker.on_reply(DATA_REQUEST_TODAY, 3990));
+  EXPECT_FALSE(tracker.is_in_flight(DATA_REQUEST_TODAY));
+  EXPECT_EQ(tracker.get_latency().get_count(), 0u);
+}
+
+TEST(RequestTracker, RetriesWithBackoffThenGivesUp)
+{
+  RequestTracker tracker;
+  uint8_t lost;
+  uint32_t now = 0;
+  tracker.on_sent(DATA_REQUEST_YESTERDAY, now);
+  EXPECT_EQ(tracker.poll(now + RequestTracker::REPLY_TIMEOUT_MS - 1, lost), 0);
+
+  uint32_t retries = 0;
+  uint8_t lost_code = 0;
+  for (now = 0; now < 60000 && lost_code == 0; now += 10)
+  {
+    uint8_t retry = tracker.poll(now, lost);
+    if (lost != 0)
+      lost_code = lost;
+    if (retry != 0)
+    {
+      EXPECT_EQ(retry, DATA_REQUEST_YESTERDAY);
+      tracker.on_sent(retry, now);
+      retries++;
+    }
+  }
+  EXPECT_EQ(lost_code, DATA_REQUEST_YESTERDAY);
+  EXPECT_EQ(retries, RequestTracker::MAX_ATTEMPTS - 1u);
+  EXPECT_EQ(tracker.get_retries(), retries);
+  EXPECT_EQ(tracker.get_lost(), 1u);
+  EXPECT_FLOAT_EQ(tracker.get_loss_rate(), 100.0f);
+  EXPECT_FALSE(tracker.is_in_flight(DATA_REQUEST_YESTERDAY));
+}
+
+TEST(RequestTracker, ReplyDuringBackoffStillCounts)
+{
+  RequestTracker tracker;
+  uint8_t lost;
+  tracker.on_sent(DATA_REQUEST_TOTAL, 0);
+  EXPECT_EQ(tracker.poll(RequestTracker::REPLY_TIMEOUT_MS, lost), 0); // now backing off
+  EXPECT_TRUE(tracker.on_reply(DATA_REQUEST_TOTAL, RequestTracker::REPLY_TIMEOUT_MS + 10));
+  EXPECT_EQ(tracker.get_latency().get_count(), 0u); // not a clean round trip
+  EXPECT_EQ(tracker.poll(60000, lost), 0);
+  EXPECT_EQ(lost, 0);
+}
+
+TEST(LatencyHistogram, Percentiles)
+{
+  LatencyHistogram histogram;
+  EXPECT_EQ(histogram.percentile(50), 0.0f);
+  for (int i = 0; i < 90; i++)
+    histogram.record(40);
+  for (int i = 0; i < 10; i++)
+    histogram.record(900);
+  EXPECT_GT(histogram.percentile(50), 20.0f);
+  EXPECT_LE(histogram.percentile(50), 50.0f);
+  EXPECT_GT(histogram.percentile(95), 750.0f);
+  EXPECT_LE(histogram.percentile(95), 1000.0f);
+}
@@ -0,0 +1,211 @@
+#include <gtest/gtest.h>
+#include "esphiBoost.h"
+#include "esphome/components/sx126x/sx126x.h"
+#include "frames.h"
+#include "host_app.h"
+#include "rx_duty_cycle.h"
+
+using namespace esphome;
+using namespace esphome::esphiBoost;
+
+namespace
+{
+  const uint32_t PERIOD_MS = 10000;
+
+  // Frames exactly PERIOD_MS apart from `start` until the phase locks; returns the last time
+  uint32_t lock(RxPhase &phase, uint32_t start = 1000)
+  {
+    uint32_t t = start;
+    for (int i = 0; i < 2 + RxPhase::FRAMES_TO_LOCK; i++, t += PERIOD_MS)
+      phase.on_frame(t);
+    return t - PERIOD_MS;
+  }
+} // namespace
+
+TEST(RxPhase, LocksAfterAgreeingGaps)
+{
+  RxPhase phase;
+  uint32_t t = 1000;
+  // The first frame anchors, the second sets the period, then FRAMES_TO_LOCK gaps must agree
+  for (int i = 0; i < 1 + RxPhase::FRAMES_TO_LOCK; i++, t += PERIOD_MS)
+  {
+    phase.on_frame(t);
+    EXPECT_FALSE(phase.is_locked()) << "frame " << i;
+  }
+  phase.on_frame(t);
+  EXPECT_TRUE(phase.is_locked());
+  EXPECT_EQ(phase.get_locks(), 1u);
+  EXPECT_FLOAT_EQ(phase.get_period_ms(), PERIOD_MS);
+
+  // Asleep until GUARD_MS before the next frame, awake inside the window
+  EXPECT_EQ(phase.ms_until_window(t + 100), PERIOD_MS - RxPhase::GUARD_MS - 100);
+  EXPECT_EQ(phase.ms_until_window(t + PERIOD_MS - RxPhase::GUARD_MS), 0u);
+  EXPECT_EQ(phase.ms_until_window(t + PERIOD_MS + RxPhase::GUARD_MS), 0u);
+}
+
+TEST(RxPhase, IrregularGapsNeverLock)
+{
+  RxPhase phase;
+  uint32_t t = 0;
+  for (int i = 0; i < 40; i++)
+  {
+    t += i % 2 ? 4000 : 9000;
+    phase.on_frame(t);
+  }
+  EXPECT_FALSE(phase.is_locked());
+  EXPECT_EQ(phase.ms_until_window(t + 100), 0u);
+}
+
+TEST(RxPhase, FollowsAClockThatDrifts)
+{
+  RxPhase phase;
+  uint32_t t = lock(phase);
+  // The unit's clock runs 20 ms per period slow; every frame still lands in its window
+  for (int i = 0; i < 100; i++)
+  {
+    t += PERIOD_MS + 20;
+    EXPECT_EQ(phase.ms_until_window(t), 0u) << "frame " << i;
+    phase.on_frame(t);
+  }
+  EXPECT_TRUE(phase.is_locked());
+  EXPECT_EQ(phase.get_unlocks(), 0u);
+  EXPECT_NEAR(phase.get_period_ms(), PERIOD_MS + 20, 1.0f);
+}
+
+TEST(RxPhase, MissedWindowWidensTheNext)
+{
+  RxPhase phase;
+  uint32_t t = lock(phase);
+  // Nothing in the first window: the second one opens earlier than GUARD_MS
+  uint32_t wait = phase.ms_until_window(t + PERIOD_MS + 100);
+  EXPECT_EQ(wait, PERIOD_MS - 2 * RxPhase::GUARD_MS - 100);
+  EXPECT_EQ(phase.ms_until_window(t + 2 * PERIOD_MS - 2 * RxPhase::GUARD_MS), 0u);
+
+  // The frame after the gap keeps the lock
+  phase.on_frame(t + 2 * PERIOD_MS + 80);
+  EXPECT_TRUE(phase.is_locked());
+  EXPECT_EQ(phase.get_unlocks(), 0u);
+}
+
+TEST(RxPhase, StrayFrameBetweenWindowsKeepsTheLock)
+{
+  RxPhase phase;
+  uint32_t t = lock(phase);
+  phase.on_frame(t + 3000); // e.g. a reply to our own request
+  EXPECT_TRUE(phase.is_locked());
+  EXPECT_EQ(phase.ms_until_window(t + 3100), PERIOD_MS - RxPhase::GUARD_MS - 3100);
+  phase.on_frame(t + PERIOD_MS);
+  EXPECT_TRUE(phase.is_locked());
+}
+
+TEST(RxPhase, MovedScheduleDropsTheLock)
+{
+  RxPhase phase;
+  uint32_t t = lock(phase) + PERIOD_MS / 2;
+  for (int i = 0; i < RxPhase::FRAMES_TO_LOCK; i++, t += PERIOD_MS)
+    phase.on_frame(t);
+  EXPECT_FALSE(phase.is_locked());
+  EXPECT_EQ(phase.get_unlocks(), 1u);
+}
+
+TEST(RxPhase, SilenceFallsBackToListening)
+{
+  RxPhase phase;
+  uint32_t t = lock(phase);
+  uint32_t last_window = t + (1 + RxPhase::MAX_MISSED_WINDOWS) * PERIOD_MS;
+  EXPECT_EQ(phase.ms_until_window(last_window), 0u);
+  EXPECT_TRUE(phase.is_locked());
+  // One window more and the lock is gone; ms_until_window() then asks to listen
+  EXPECT_EQ(phase.ms_until_window(last_window + PERIOD_MS), 0u);
+  EXPECT_FALSE(phase.is_locked());
+  EXPECT_EQ(phase.get_unlocks(), 1u);
+}
+
+TEST(RxDutyCycle, ListensUntilEveryUnitIsLocked)
+{
+  RxDutyCycle cycle;
+  EXPECT_TRUE(cycle.wants_rx(0)); // nothing heard yet
+
+  uint32_t t = 1000;
+  for (int i = 0; i < 2 + RxPhase::FRAMES_TO_LOCK; i++, t += PERIOD_MS)
+  {
+    cycle.on_frame(LINK_IBOOST, t);
+    if (i < 3)
+      cycle.on_frame(LINK_SENDER, t + 2500);
+  }
+  t -= PERIOD_MS;
+  // The Sender was heard recently but never locked
+  EXPECT_TRUE(cycle.wants_rx(t + 5000));
+  // Once it has gone stale only the iBoost counts
+  for (uint32_t i = 0; i < RxDutyCycle::UNIT_STALE_MS / PERIOD_MS; i++)
+    cycle.on_frame(LINK_IBOOST, t += PERIOD_MS);
+  EXPECT_FALSE(cycle.wants_rx(t + 5000));
+}
+
+TEST(RxDutyCycle, SleepsBetweenWindowsAndHoldsForReplies)
+{
+  RxDutyCycle cycle;
+  uint32_t t = 1000;
+  for (int i = 0; i < 2 + RxPhase::FRAMES_TO_LOCK; i++, t += PERIOD_MS)
+    cycle.on_frame(LINK_IBOOST, t);
+  t -= PERIOD_MS;
+
+  EXPECT_FALSE(cycle.wants_rx(t + 100));
+  cycle.hold_awake(t + 200, 3000);
+  EXPECT_TRUE(cycle.wants_rx(t + 3000));
+  EXPECT_FALSE(cycle.wants_rx(t + 3300));
+  // Too close to the window to be worth a mode change
+  uint32_t wake = t + PERIOD_MS - RxPhase::GUARD_MS - RxDutyCycle::MIN_SLEEP_MS + 1;
+  EXPECT_TRUE(cycle.wants_rx(wake));
+  EXPECT_EQ(cycle.get_listen_ms(), 300u);
+  EXPECT_EQ(cycle.get_listen_ms() + cycle.get_sleep_ms(), wake - (t + 100));
+}
+
+namespace
+{
+  // iBoostBuddy on the fake radio, hearing the iBoost every PERIOD_MS
+  struct DutyRig
+  {
+    explicit DutyRig(bool duty_cycle)
+    {
+      host::set_micros(5000000);
+      radio.add_on_packet_callback([this](const std::vector<uint8_t> &x, float rssi, float) { buddy.process_packet(x, rssi); });
+      buddy.set_radio(&radio);
+      buddy.set_rx_duty_cycle(duty_cycle);
+      app.add(&buddy);
+      app.setup();
+    }
+
+    // `minutes` of iBoost frames on schedule; returns how many the radio missed
+    uint32_t run(uint32_t minutes)
+    {
+      frames::IBoostStatus status;
+      for (uint32_t i = 0; i < minutes * 60000 / PERIOD_MS; i++)
+      {
+        status.power = static_cast<int16_t>(100 * (i % 7));
+        radio.inject(frames::iboost(status), -75.0f);
+        app.run_for(PERIOD_MS);
+      }
+      return radio.missed;
+    }
+
+    sx126x::SX126x radio;
+    iBoostBuddy buddy;
+    host::App app;
+  };
+} // namespace
+
+TEST(RxDutyCycleBuddy, SleepsTheRadioWithoutMissingFrames)
+{
+  DutyRig rig(true);
+  EXPECT_EQ(rig.run(10), 0u);
+  EXPECT_GT(rig.radio.get_mode_changes(), 0u);
+}
+
+TEST(RxDutyCycleBuddy, LeftOffTheRadioNeverSleeps)
+{
+  DutyRig rig(false);
+  EXPECT_EQ(rig.run(10), 0u);
+  EXPECT_EQ(rig.radio.get_mode_changes(), 0u);
+  EXPECT_EQ(rig.radio.get_mode(), sx126x::SX126x::HOST_MODE_RX);
+}
@@ -0,0 +1,79 @@
+#include <gtest/gtest.h>
+#include "sender_import.h"
+
+using namespace esphome::esphiBoost;
+
+namespace
+{
+  // One Sender reading followed by the iBoost's figure a second later
+  SenderImportCheck::Change pair(SenderImportCheck &check, float sender_w, float iboost_w, uint32_t &t)
+  {
+    t += 10000;
+    check.on_sender(sender_w, t);
+    return check.on_iboost(iboost_w, t + 1000);
+  }
+} // namespace
+
+TEST(SenderImportCheck, TrustedAfterMatchesAtRealImport)
+{
+  SenderImportCheck check;
+  uint32_t t = 0;
+  EXPECT_EQ(pair(check, 1500.0f, 1520.0f, t), SenderImportCheck::CHANGE_NONE);
+  EXPECT_EQ(pair(check, -2100.0f, -2050.0f, t), SenderImportCheck::CHANGE_NONE); // export counts too
+  EXPECT_EQ(pair(check, 800.0f, 790.0f, t), SenderImportCheck::CHANGE_TRUSTED);
+  EXPECT_TRUE(check.is_trusted());
+}
+
+TEST(SenderImportCheck, AgreementNearZeroIsNoEvidence)
+{
+  SenderImportCheck check;
+  uint32_t t = 0;
+  for (int i = 0; i < 50; i++)
+    EXPECT_EQ(pair(check, 0.0f, 20.0f * (i % 5), t), SenderImportCheck::CHANGE_NONE);
+  EXPECT_FALSE(check.is_trusted());
+  EXPECT_EQ(check.get_mismatches(), 0u);
+
+  // Nor does it interrupt a run of real matches
+  pair(check, 1500.0f, 1500.0f, t);
+  pair(check, 1600.0f, 1600.0f, t);
+  pair(check, 10.0f, 0.0f, t);
+  EXPECT_EQ(pair(check, 1700.0f, 1700.0f, t), SenderImportCheck::CHANGE_TRUSTED);
+}
+
+TEST(SenderImportCheck, FieldStuckAtZeroIsNeverTrusted)
+{
+  SenderImportCheck check;
+  uint32_t t = 0;
+  const float IMPORTS[] = {0.0f, 30.0f, 1200.0f, 0.0f, 0.0f, 2400.0f, 10.0f, 0.0f, 600.0f};
+  for (int round = 0; round < 10; round++)
+  {
+    for (float import_w : IMPORTS)
+      pair(check, 0.0f, import_w, t);
+  }
+  EXPECT_FALSE(check.is_trusted());
+  EXPECT_EQ(check.get_mismatches(), 30u);
+}
+
+TEST(SenderImportCheck, MismatchWithdrawsTrust)
+{
+  SenderImportCheck check;
+  uint32_t t = 0;
+  for (int i = 0; i < SenderImportCheck::MATCHES_TO_TRUST; i++)
+    pair(check, 1000.0f, 1000.0f, t);
+  ASSERT_TRUE(check.is_trusted());
+  EXPECT_EQ(pair(check, 0.0f, 900.0f, t), SenderImportCheck::CHANGE_DISTRUSTED);
+  EXPECT_FALSE(check.is_trusted());
+}
+
+TEST(SenderImportCheck, StaleOrImplausibleReadingsAreNotCompared)
+{
+  SenderImportCheck check;
+  check.on_sender(1000.0f, 0);
+  EXPECT_EQ(check.on_iboost(0.0f, SenderImportCheck::PAIR_WINDOW_MS + 1), SenderImportCheck::CHANGE_NONE);
+  EXPECT_EQ(check.get_mismatches(), 0u);
+
+  EXPECT_FALSE(check.on_sender(SenderImportCheck::LIMIT_W * 2, 20000));
+  EXPECT_EQ(check.on_iboost(0.0f, 20500), SenderImportCheck::CHANGE_NONE);
+  EXPECT_EQ(check.get_implausible(), 1u);
+  EXPECT_EQ(check.get_mismatches(), 0u);
+}
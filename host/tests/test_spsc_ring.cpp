@@ -0,0 +1,84 @@
+#include <gtest/gtest.h>
+#include <thread>
+#include "spsc_ring.h"
+
+using esphome::esphiBoost::SpscRing;
+
+TEST(SpscRing, KeepsOrderAndRefusesWhenFull)
+{
+  SpscRing<int, 4> ring;
+  int value;
+  EXPECT_FALSE(ring.pop(value));
+  for (int i = 0; i < 4; i++)
+    EXPECT_TRUE(ring.push(i));
+  EXPECT_FALSE(ring.push(99));
+  EXPECT_EQ(ring.size(), 4u);
+  for (int i = 0; i < 4; i++)
+  {
+    ASSERT_TRUE(ring.pop(value));
+    EXPECT_EQ(value, i);
+  }
+  EXPECT_FALSE(ring.pop(value));
+  EXPECT_EQ(ring.size(), 0u);
+}
+
+namespace
+{
+  // Starts the indices just short of wrapping
+  template <typename T, size_t N> struct NearWrapRing : SpscRing<T, N>
+  {
+    NearWrapRing()
+    {
+      this->head_ = UINT32_MAX - 1;
+      this->tail_ = UINT32_MAX - 1;
+    }
+  };
+} // namespace
+
+TEST(SpscRing, SurvivesIndexWrap)
+{
+  NearWrapRing<int, 4> ring;
+  int value;
+  for (int round = 0; round < 3; round++)
+  {
+    for (int i = 0; i < 4; i++)
+      ASSERT_TRUE(ring.push(round * 10 + i));
+    EXPECT_FALSE(ring.push(-1));
+    EXPECT_EQ(ring.size(), 4u);
+    for (int i = 0; i < 4; i++)
+    {
+      ASSERT_TRUE(ring.pop(value));
+      EXPECT_EQ(value, round * 10 + i);
+    }
+  }
+}
+
+TEST(SpscRing, TwoThreadsSeeEveryItemInOrder)
+{
+  static constexpr uint32_t COUNT = 100000;
+  SpscRing<uint32_t, 16> ring;
+  std::thread producer([&ring] {
+    for (uint32_t i = 0; i < COUNT;)
+    {
+      if (ring.push(i))
+        i++;
+      else
+        std::this_thread::yield();
+    }
+  });
+  uint32_t expected = 0;
+  uint32_t value;
+  while (expected < COUNT)
+  {
+    if (ring.pop(value))
+    {
+      ASSERT_EQ(value, expected);
+      expected++;
+    }
+    else
+    {
+      std::this_thread::yield();
+    }
+  }
+  producer.join();
+}
@@ -0,0 +1,86 @@
+#include <gtest/gtest.h>
+#include <set>
+#include "system_table.h"
+
+using namespace esphome::esphiBoost;
+
+namespace
+{
+  // Exposes the slot function
+  struct ProbedTable : SystemTable
+  {
+    static size_t slot(uint16_t address) { return slot_(address); }
+  };
+
+  // The same hash in 32-bit arithmetic, as the ESP32 computes it
+  size_t device_slot(uint16_t address) { return static_cast<uint32_t>(address * 2654435769u) >> 29; }
+
+  // Two addresses that hash to the same slot
+  std::pair<uint16_t, uint16_t> colliding_pair()
+  {
+    for (uint16_t a = 1; a < 0x100; a++)
+    {
+      for (uint16_t b = a + 1; b < 0x100; b++)
+      {
+        if (ProbedTable::slot(a) == ProbedTable::slot(b))
+          return {a, b};
+      }
+    }
+    return {0, 0};
+  }
+} // namespace
+
+TEST(SystemTable, HashMatchesTheDeviceOnEveryAddress)
+{
+  for (uint32_t address = 0; address <= 0xFFFF; address++)
+  {
+    size_t slot = ProbedTable::slot(static_cast<uint16_t>(address));
+    ASSERT_LT(slot, SystemTable::CAPACITY);
+    ASSERT_EQ(slot, device_slot(static_cast<uint16_t>(address))) << std::hex << address;
+  }
+}
+
+TEST(SystemTable, NeighbouringAddressesSpread)
+{
+  std::set<size_t> slots;
+  for (uint16_t address = 0x1230; address < 0x1238; address++)
+    slots.insert(ProbedTable::slot(address));
+  EXPECT_GE(slots.size(), SystemTable::CAPACITY - 2);
+}
+
+TEST(SystemTable, CollidingAddressesProbeToTheirOwnEntries)
+{
+  auto [a, b] = colliding_pair();
+  ASSERT_NE(a, b);
+  SystemTable table;
+  SystemState *first = table.find_or_insert(a);
+  SystemState *second = table.find_or_insert(b);
+  ASSERT_NE(first, nullptr);
+  ASSERT_NE(second, nullptr);
+  EXPECT_NE(first, second);
+  EXPECT_EQ(table.find(a), first);
+  EXPECT_EQ(table.find(b), second);
+  EXPECT_EQ(table.find_or_insert(a), first);
+  EXPECT_EQ(table.get_count(), 2u);
+}
+
+TEST(SystemTable, FullTableRefusesNewAddressesAndStillFindsOld)
+{
+  SystemTable table;
+  SystemState *entries[SystemTable::CAPACITY];
+  for (size_t i = 0; i < SystemTable::CAPACITY; i++)
+  {
+    entries[i] = table.find_or_insert(static_cast<uint16_t>(0x4000 + i * 0x101));
+    ASSERT_NE(entries[i], nullptr);
+    entries[i]->frames = static_cast<uint32_t>(i);
+  }
+  EXPECT_EQ(table.find_or_insert(0x7777), nullptr);
+  EXPECT_EQ(table.find(0x7777), nullptr);
+  EXPECT_EQ(table.get_count(), SystemTable::CAPACITY);
+  // Pointers handed out earlier still point at their own system
+  for (size_t i = 0; i < SystemTable::CAPACITY; i++)
+  {
+    EXPECT_EQ(table.find(static_cast<uint16_t>(0x4000 + i * 0x101)), entries[i]);
+    EXPECT_EQ(entries[i]->frames, i);
+  }
+}
@@ -0,0 +1,88 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <vector>
+#include "esphiBoost.h"
+#include "host_app.h"
+#include "packet_capture.h"
+
+// Reads the PacketCapture dump format (see packet_capture.h) and feeds the frames
+// back through iBoostBuddy::process_packet() on the fake clock
+namespace capture_replay
+{
+  using namespace esphome::esphiBoost;
+
+  struct Record
+  {
+    uint32_t time_ms;
+    float rssi;
+    std::vector<uint8_t> frame; // as received; bytes past the captured ones are zero
+  };
+
+  inline uint32_t get_le(const uint8_t *p, size_t bytes)
+  {
+    uint32_t value = 0;
+    for (size_t i = 0; i < bytes; i++)
+      value |= static_cast<uint32_t>(p[i]) << (8 * i);
+    return value;
+  }
+
+  // False if `bytes` is not a capture this reader understands or is cut short
+  inline bool parse(const std::vector<uint8_t> &bytes, std::vector<Record> &records)
+  {
+    records.clear();
+    if (bytes.size() < CAPTURE_HEADER_SIZE || bytes[0] != 'I' || bytes[1] != 'B' || bytes[2] != 'C' || bytes[3] != 'P' ||
+        bytes[4] != CAPTURE_FORMAT_VERSION)
+      return false;
+    size_t count = get_le(&bytes[6], 2);
+    size_t offset = CAPTURE_HEADER_SIZE;
+    for (size_t i = 0; i < count; i++)
+    {
+      if (offset + CAPTURE_RECORD_HEADER_SIZE > bytes.size())
+        return false;
+      const uint8_t *header = &bytes[offset];
+      uint8_t length = header[6];
+      uint8_t captured = header[7];
+      offset += CAPTURE_RECORD_HEADER_SIZE;
+      if (captured > length || offset + captured > bytes.size())
+        return false;
+      Record record;
+      record.time_ms = get_le(header, 4);
+      record.rssi = static_cast<int16_t>(get_le(header + 4, 2)) / 10.0f;
+      record.frame.assign(length, 0);
+      std::copy(bytes.begin() + offset, bytes.begin() + offset + captured, record.frame.begin());
+      offset += captured;
+      records.push_back(record);
+    }
+    return true;
+  }
+
+  // Delivers each record at its original spacing on the fake clock, running `app` in
+  // between so intervals, polls and timeouts fire as they would have. With `realtime`
+  // the wall clock is paced to match; otherwise it runs as fast as it can.
+  inline void replay(esphome::host::App &app, iBoostBuddy &buddy, const std::vector<Record> &records, bool realtime,
+                     uint32_t step_ms = 16)
+  {
+    if (records.empty())
+      return;
+    uint32_t first_ms = records.front().time_ms;
+    uint32_t start_ms = esphome::millis();
+    for (const auto &record : records)
+    {
+      uint32_t due_ms = start_ms + (record.time_ms - first_ms);
+      while (static_cast<int32_t>(due_ms - esphome::millis()) > 0)
+      {
+        uint32_t step = std::min<uint32_t>(step_ms, due_ms - esphome::millis());
+        if (realtime)
+          std::this_thread::sleep_for(std::chrono::milliseconds(step));
+        esphome::host::advance_millis(step);
+        app.step();
+      }
+      buddy.process_packet(record.frame, record.rssi);
+      app.step();
+    }
+  }
+} // namespace capture_replay
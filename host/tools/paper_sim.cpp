@@ -0,0 +1,91 @@
+// Runs PaperDisplay's iBoost dashboard on the fake panel and reports what the
+// refreshes cost, so layout and refresh changes can be measured without a board.
+//
+//   paper_sim [minutes] [snapshot.pbm]
+//
+// An iBoost status frame arrives every 10 s with the heating power stepping
+// between a few values, for `minutes` (default 60) of fake time. The panel image
+// at the end is written to `snapshot.pbm` when given.
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include "esphWirelessPaper.h"
+#include "esphome/components/sx126x/sx126x.h"
+#include "host_app.h"
+#include "../tests/frames.h"
+
+using namespace esphome;
+
+int main(int argc, char **argv)
+{
+  uint32_t minutes = argc > 1 ? static_cast<uint32_t>(atoi(argv[1])) : 60;
+  const char *pbm_path = argc > 2 ? argv[2] : nullptr;
+  static const int16_t POWER_STEPS[] = {0, 0, 850, 1420, 1420, 2980, 2980, 2980, 640};
+  static const uint32_t FRAME_INTERVAL_MS = 10000;
+  static const uint32_t STEP_MS = 16;
+
+  host::set_micros(5000000);
+  sx126x::SX126x radio;
+  esphiBoost::iBoostBuddy buddy;
+  esphWirelessPaper::PaperDisplay paper;
+  buddy.set_radio(&radio);
+  radio.add_on_packet_callback([&](const std::vector<uint8_t> &x, float rssi, float) { buddy.process_packet(x, rssi); });
+  paper.set_TopTitle("iBoost");
+  paper.set_busy_pin(paper.display.host_busy_pin());
+  paper.set_iboost(&buddy);
+  host::App app;
+  app.add(&buddy);
+  app.add(&paper);
+  app.setup();
+
+  frames::IBoostStatus status;
+  uint32_t frames_sent = 0;
+  uint32_t next_frame_ms = millis();
+  uint32_t end_ms = millis() + minutes * 60000;
+  auto start = std::chrono::steady_clock::now();
+  while (static_cast<int32_t>(end_ms - millis()) > 0)
+  {
+    if (static_cast<int32_t>(millis() - next_frame_ms) >= 0)
+    {
+      status.power = POWER_STEPS[frames_sent % (sizeof(POWER_STEPS) / sizeof(POWER_STEPS[0]))];
+      status.data_value += status.power / 360; // Wh per 10 s
+      radio.inject(frames::iboost(status), -70.0f - frames_sent % 7);
+      frames_sent++;
+      next_frame_ms += FRAME_INTERVAL_MS;
+    }
+    host::advance_millis(STEP_MS);
+    app.step();
+  }
+  double wall_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+  const auto &panel = paper.display;
+  uint32_t refreshes = panel.host_fast_refreshes + panel.host_full_refreshes;
+  printf("simulated         %u min, %u iBoost frames\n", (unsigned) minutes, (unsigned) frames_sent);
+  printf("refreshes         %u fast, %u full\n", (unsigned) panel.host_fast_refreshes,
+         (unsigned) panel.host_full_refreshes);
+  printf("lines drawn       %u (%.1f per refresh)\n", (unsigned) panel.host_draw_calls,
+         refreshes != 0 ? (double) panel.host_draw_calls / refreshes : 0.0);
+  printf("pixels drawn      %u\n", (unsigned) panel.host_pixels_drawn);
+  printf("pixels changed    %u\n", (unsigned) panel.host_pixels_changed);
+  printf("panel busy        %u ms (%.2f%% of the time)\n", (unsigned) panel.host_busy_ms,
+         minutes != 0 ? 100.0 * panel.host_busy_ms / (minutes * 60000.0) : 0.0);
+  printf("loop() held       %u ms, mostly inside the driver's update()\n", (unsigned) paper.get_blocked_ms());
+  printf("writes skipped    %u\n", (unsigned) paper.get_skipped_writes());
+  printf("host time         %.1f ms (%.1f us per refresh)\n", wall_ms,
+         refreshes != 0 ? wall_ms * 1000.0 / refreshes : 0.0);
+
+  if (pbm_path != nullptr)
+  {
+    std::string pbm;
+    panel.host_render_pbm(pbm);
+    std::ofstream out(pbm_path, std::ios::binary);
+    out.write(pbm.data(), pbm.size());
+    if (!out)
+    {
+      fprintf(stderr, "%s: cannot write\n", pbm_path);
+      return 1;
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,130 @@
+#!/usr/bin/env python3
+"""Read an esphiBoost frame capture and replay it as decoded frames.
+
+The capture comes from GET /iboost/capture on a device running the esphiBoost
+component with web_server enabled (see PacketCapture in packet_capture.h for
+the format). Frames are printed oldest first, either as fast as possible or
+paced at the gaps they were originally received with.
+
+    python3 tools/iboost_capture.py http://minibuddy.local/iboost/capture -o today.ibcp
+    python3 tools/iboost_capture.py today.ibcp --realtime
+    python3 tools/iboost_capture.py today.ibcp --hex > frames.txt
+"""
+
+import argparse
+import struct
+import sys
+import time
+import urllib.request
+
+HEADER = struct.Struct("<4sBxHII")
+RECORD = struct.Struct("<IhBB")
+
+# Mirrors iboost_protocol.h
+PACKET_TYPE_SENDER = 0x01
+PACKET_TYPE_BUDDY = 0x21
+PACKET_TYPE_IBOOST = 0x22
+FRAME_IBOOST_MIN_LENGTH = 28
+FRAME_SENDER_MIN_LENGTH = 44
+DATA_REQUEST_NAMES = {
+    0xCA: "today",
+    0xCB: "yesterday",
+    0xCC: "last 7 days",
+    0xCD: "last 28 days",
+    0xCE: "total",
+}
+
+
+def load(source):
+    if source.startswith(("http://", "https://")):
+        with urllib.request.urlopen(source, timeout=10) as response:
+            return response.read()
+    with open(source, "rb") as f:
+        return f.read()
+
+
+def parse(blob):
+    if len(blob) < HEADER.size:
+        raise ValueError("capture is shorter than its header")
+    magic, version, count, seen, dumped_ms = HEADER.unpack_from(blob, 0)
+    if magic != b"IBCP" or version != 1:
+        raise ValueError(f"not an iBoost capture (magic {magic!r}, version {version})")
+    offset = HEADER.size
+    frames = []
+    for _ in range(count):
+        time_ms, rssi_x10, length, captured = RECORD.unpack_from(blob, offset)
+        offset += RECORD.size
+        data = blob[offset : offset + captured]
+        offset += captured
+        frames.append((time_ms, rssi_x10 / 10.0, length, data))
+    return seen, dumped_ms, frames
+
+
+def describe(data, length):
+    if len(data) < 3:
+        return "runt"
+    kind = data[2]
+    if kind == PACKET_TYPE_IBOOST and length >= FRAME_IBOOST_MIN_LENGTH and len(data) >= 28:
+        power = struct.unpack_from("<h", data, 16)[0]
+        import_w = struct.unpack_from("<i", data, 18)[0] / 360.0
+        code = data[24]
+        value = int.from_bytes(data[25:28], "little", signed=True)
+        flags = []
+        if data[6]:
+            flags.append("heating")
+        if data[7]:
+            flags.append("hot")
+        if data[13]:
+            flags.append("overheat")
+        text = f"iBoost power={power}W import={import_w:.1f}W boost={data[5]}min"
+        if flags:
+            text += " " + ",".join(flags)
+        if code in DATA_REQUEST_NAMES:
+            text += f" {DATA_REQUEST_NAMES[code]}={value}Wh"
+        return text
+    if kind == PACKET_TYPE_BUDDY:
+        return "Buddy"
+    if kind == PACKET_TYPE_SENDER and length >= FRAME_SENDER_MIN_LENGTH and len(data) >= 22:
+        # Import offset inferred from the iBoost frame; compare with nearby iBoost lines
+        import_w = int.from_bytes(data[18:22], "little", signed=True) / 360
+        return f"Sender import={import_w:.1f}W? battery=" + ("low" if data[12] else "ok")
+    return f"type 0x{kind:02X}"
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("source", help="capture file, or the device's /iboost/capture URL")
+    parser.add_argument("-o", "--output", help="save the raw capture here as well")
+    parser.add_argument("--realtime", action="store_true", help="replay with the original gaps between frames")
+    parser.add_argument("--speed", type=float, default=1.0, help="speed-up factor for --realtime")
+    parser.add_argument("--hex", action="store_true", help="print only the raw frames, one hex line each")
+    args = parser.parse_args()
+
+    blob = load(args.source)
+    if args.output:
+        with open(args.output, "wb") as f:
+            f.write(blob)
+    seen, dumped_ms, frames = parse(blob)
+    if not args.hex:
+        print(f"# {len(frames)} frames held, {seen} seen since boot, dumped at {dumped_ms} ms", file=sys.stderr)
+
+    previous_ms = None
+    started = time.monotonic()
+    for time_ms, rssi, length, data in frames:
+        if args.realtime and previous_ms is not None:
+            time.sleep(max(0.0, ((time_ms - previous_ms) & 0xFFFFFFFF) / 1000.0 / args.speed))
+        previous_ms = time_ms
+        if args.hex:
+            print(data.hex())
+            continue
+        truncated = "" if length == len(data) else f" (truncated from {length})"
+        print(f"{time_ms:>10} ms {rssi:6.1f} dB {length:3} B{truncated}  {describe(data, length)}")
+        print(f"              {data.hex(' ')}")
+
+    if not args.hex:
+        elapsed = time.monotonic() - started
+        print(f"# replayed {len(frames)} frames in {elapsed:.3f} s", file=sys.stderr)
+
+
+if __name__ == "__main__":
+    main()
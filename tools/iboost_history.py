@@ -0,0 +1,120 @@
+#!/usr/bin/env python3
+"""Decode the esphiBoost flash history log to CSV.
+
+The log can be read from a running device, one sector per request from
+/iboost/history?sector=N, or from a dump of the iboost_log partition, e.g.
+
+    esptool.py read_flash 0x790000 0x10000 iboost_log.bin
+
+See HistoryLog in history_log.h for the layout.
+
+    python3 tools/iboost_history.py http://minibuddy.local -o log.bin > history.csv
+    python3 tools/iboost_history.py iboost_log.bin
+"""
+
+import argparse
+import datetime
+import struct
+import sys
+import urllib.error
+import urllib.parse
+import urllib.request
+
+SECTOR_SIZE = 4096
+RECORD_SIZE = 32
+MAGIC = b"IBHL"
+VERSION = 1
+RECORD = struct.Struct("<BxHI20sI")
+COUNTERS = struct.Struct("<5i")
+ROLLUP = struct.Struct("<7hH4x")
+UNKNOWN = -(2**31)
+
+
+def fnv1a(data):
+    value = 2166136261
+    for byte in data:
+        value = ((value ^ byte) * 16777619) & 0xFFFFFFFF
+    return value
+
+
+def fetch(base_url, instance=None):
+    blob = bytearray()
+    sector = 0
+    instance_arg = f"&id={urllib.parse.quote(instance)}" if instance else ""
+    while True:
+        try:
+            url = f"{base_url.rstrip('/')}/iboost/history?sector={sector}{instance_arg}"
+            with urllib.request.urlopen(url, timeout=10) as response:
+                blob += response.read()
+        except urllib.error.HTTPError as error:
+            if error.code == 404:
+                return bytes(blob)
+            raise
+        sector += 1
+
+
+def sectors_in_order(blob):
+    """Yields the sectors holding a log, oldest first."""
+    found = []
+    for offset in range(0, len(blob) - SECTOR_SIZE + 1, SECTOR_SIZE):
+        sector = blob[offset : offset + SECTOR_SIZE]
+        if sector[:4] != MAGIC or sector[8] != VERSION:
+            continue
+        sequence = struct.unpack_from("<I", sector, 4)[0]
+        found.append((sequence, sector))
+    found.sort(key=lambda item: item[0])
+    return [sector for _, sector in found]
+
+
+def records(blob):
+    bad = 0
+    for sector in sectors_in_order(blob):
+        for offset in range(RECORD_SIZE, SECTOR_SIZE, RECORD_SIZE):
+            raw = sector[offset : offset + RECORD_SIZE]
+            if raw[0] == 0xFF:
+                break
+            kind, address, when, payload, check = RECORD.unpack(raw)
+            if fnv1a(raw[:28]) != check:
+                bad += 1
+                continue
+            yield kind, address, when, payload
+    if bad:
+        print(f"# skipped {bad} records with a bad checksum", file=sys.stderr)
+
+
+def format_time(when):
+    if when == 0:
+        return ""
+    return datetime.datetime.fromtimestamp(when, datetime.timezone.utc).strftime("%Y-%m-%dT%H:%M:%SZ")
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("source", help="partition dump, or the device's base URL")
+    parser.add_argument("-o", "--output", help="save the raw sectors here as well")
+    parser.add_argument("--id", help="esphiBoost instance to read, when the device has several")
+    args = parser.parse_args()
+
+    if args.source.startswith(("http://", "https://")):
+        blob = fetch(args.source, args.id)
+    else:
+        with open(args.source, "rb") as f:
+            blob = f.read()
+    if args.output:
+        with open(args.output, "wb") as f:
+            f.write(blob)
+
+    print("time,system,kind,today_wh,yesterday_wh,last_7_wh,last_28_wh,total_wh,"
+          "power_min_w,power_max_w,power_mean_w,import_min_w,import_max_w,import_mean_w,rssi_iboost_db,samples")
+    for kind, address, when, payload in records(blob):
+        prefix = f"{format_time(when)},{address:04X}"
+        if kind == 1:
+            counters = ["" if value == UNKNOWN else str(value) for value in COUNTERS.unpack(payload)]
+            print(f"{prefix},counters,{','.join(counters)},,,,,,,,")
+        elif kind == 2:
+            p_min, p_max, p_mean, i_min, i_max, i_mean, rssi, samples = ROLLUP.unpack(payload)
+            print(f"{prefix},rollup,,,,,,{p_min},{p_max},{p_mean},{i_min},{i_max},{i_mean},{rssi / 10:.1f},{samples}")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,89 @@
+#!/usr/bin/env python3
+"""Compare firmware size across ESPHome configurations.
+
+Compiles each configuration with `esphome compile` and prints the text, data
+and bss of the firmware and of the esphiBoost object, so the cost of the
+optional output groups (USE_IBOOST_* in esphiBoost.h) can be measured on the
+real toolchain. Needs ESPHome with PlatformIO, as for a normal build.
+
+    python3 tools/iboost_size.py minibuddy-iBoostPaper.yaml headless.yaml
+
+A variant can reuse a full configuration as a package and drop outputs from
+the esphiBoost entry with !remove, e.g. headless.yaml:
+
+    packages:
+      device: !include minibuddy-iBoostPaper.yaml
+    esphiBoost:
+      - id: esphiBoost_id
+        rssi_iboost: !remove
+        link_loss_iboost: !remove
+
+The sensors themselves stay defined, so the firmware figure includes them;
+the esphiBoost object shows the component alone.
+"""
+
+import argparse
+import glob
+import os
+import subprocess
+import sys
+import time
+
+OBJECT = os.path.join("src", "esphome", "components", "esphiBoost", "esphiBoost.cpp.o")
+
+
+def find_size_tool():
+    pattern = os.path.expanduser("~/.platformio/packages/toolchain-*/bin/*-elf-size")
+    tools = sorted(glob.glob(pattern))
+    return tools[0] if tools else "size"
+
+
+def newest_build(config, since):
+    """The firmware.elf written by the compile that started at `since`."""
+    root = os.path.join(os.path.dirname(os.path.abspath(config)), ".esphome", "build")
+    elves = [
+        path
+        for path in glob.glob(os.path.join(root, "*", ".pioenvs", "*", "firmware.elf"))
+        if os.path.getmtime(path) >= since
+    ]
+    return max(elves, key=os.path.getmtime) if elves else None
+
+
+def sizes(tool, path):
+    """(text, data, bss) in Berkeley format, or None if the file is missing."""
+    if path is None or not os.path.exists(path):
+        return None
+    out = subprocess.run([tool, path], check=True, capture_output=True, text=True).stdout
+    fields = out.splitlines()[1].split()
+    return int(fields[0]), int(fields[1]), int(fields[2])
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("configs", nargs="+", help="ESPHome YAML files to compile and compare")
+    parser.add_argument("--esphome", default="esphome", help="esphome command (default: esphome)")
+    args = parser.parse_args()
+
+    tool = find_size_tool()
+    rows = []
+    for config in args.configs:
+        start = time.time()
+        result = subprocess.run([args.esphome, "compile", config])
+        if result.returncode != 0:
+            sys.exit(f"{config}: esphome compile failed")
+        elf = newest_build(config, start)
+        if elf is None:
+            sys.exit(f"{config}: no firmware.elf found under .esphome/build")
+        env_dir = os.path.dirname(elf)
+        rows.append((config, sizes(tool, elf), sizes(tool, os.path.join(env_dir, OBJECT))))
+
+    print(f"{'config':<32} {'text':>9} {'data':>7} {'bss':>7}   {'esphiBoost.o text':>17} {'data':>6} {'bss':>6}")
+    for config, firmware, component in rows:
+        line = f"{os.path.basename(config):<32} {firmware[0]:>9} {firmware[1]:>7} {firmware[2]:>7}"
+        if component is not None:
+            line += f"   {component[0]:>17} {component[1]:>6} {component[2]:>6}"
+        print(line)
+
+
+if __name__ == "__main__":
+    main()